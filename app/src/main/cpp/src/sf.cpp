@@ -1,4 +1,7 @@
 #include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <ctime>
 #include <sf.hpp>
 #include <unistd.h>
 
@@ -466,35 +469,135 @@ namespace sf {
         return hasher(string);
     }
 
-    date_time_t date_time_get_current() {
-        const std::time_t t = std::time(nullptr);
-        const std::tm* lt = std::localtime(&t);
+    // Broken-down wall-clock date is cached for a whole second and guarded by a sequence lock:
+    // odd sequence means that a single thread is refreshing the cache, readers don't wait for it and compute their own timestamp.
+    struct timestamp_cache_t final {
+        std::atomic<u32> sequence = { 0 };
+        std::atomic<u64> date_packed = { 0 };
+        std::atomic<u64> second_begin_ns = { 0 };
+    };
+
+    static timestamp_cache_t s_timestamp_cache = {};
+
+    static constexpr u64 SF_NS_PER_SECOND = 1000000000ull;
+    static constexpr u64 SF_NS_PER_MS = 1000000ull;
+
+    static u64 date_time_pack(const std::tm& lt) {
+        return static_cast<u64>(lt.tm_year + 1900) << 40 |
+               static_cast<u64>(lt.tm_mon + 1) << 32 |
+               static_cast<u64>(lt.tm_mday) << 24 |
+               static_cast<u64>(lt.tm_hour) << 16 |
+               static_cast<u64>(lt.tm_min) << 8 |
+               static_cast<u64>(lt.tm_sec);
+    }
+
+    static date_time_t date_time_unpack(u64 packed, u64 subsecond_ns) {
         date_time_t date_time = {};
-        date_time.y = lt->tm_year;
-        date_time.m = lt->tm_mon;
-        date_time.d = lt->tm_mday;
-        date_time.h = lt->tm_hour;
-        date_time.min = lt->tm_min;
-        date_time.s = lt->tm_sec;
-        date_time.ms = lt->tm_sec * 1000;
+        date_time.y = static_cast<u32>(packed >> 40 & 0xFFFF);
+        date_time.m = static_cast<u32>(packed >> 32 & 0xFF);
+        date_time.d = static_cast<u32>(packed >> 24 & 0xFF);
+        date_time.h = static_cast<i64>(packed >> 16 & 0xFF);
+        date_time.min = static_cast<i64>(packed >> 8 & 0xFF);
+        date_time.s = static_cast<i64>(packed & 0xFF);
+        date_time.ms = static_cast<i64>(subsecond_ns / SF_NS_PER_MS);
         return date_time;
     }
 
+    // calls localtime for the current second, date_packed and second_begin_ns are what the cache stores
+    static timestamp_t timestamp_compute(u64& date_packed, u64& second_begin_ns) {
+        const i64 wall_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()
+        ).count();
+        const u64 now_ns = time_get_monotonic_ns();
+        const std::time_t t = static_cast<std::time_t>(wall_ns / static_cast<i64>(SF_NS_PER_SECOND));
+        const u64 subsecond_ns = static_cast<u64>(wall_ns % static_cast<i64>(SF_NS_PER_SECOND));
+
+        std::tm lt = {};
+#if defined(SF_WINDOWS)
+        localtime_s(&lt, &t);
+#else
+        localtime_r(&t, &lt);
+#endif
+
+        date_packed = date_time_pack(lt);
+        second_begin_ns = now_ns - subsecond_ns;
+
+        timestamp_t timestamp;
+        timestamp.date_time = date_time_unpack(date_packed, subsecond_ns);
+        timestamp.monotonic_ns = now_ns;
+        return timestamp;
+    }
+
+    static timestamp_t timestamp_cache_refresh(timestamp_cache_t& cache, u32 sequence) {
+        // make the odd sequence visible before any of the cached values change
+        std::atomic_thread_fence(std::memory_order_release);
+
+        u64 date_packed;
+        u64 second_begin_ns;
+        const timestamp_t timestamp = timestamp_compute(date_packed, second_begin_ns);
+
+        cache.date_packed.store(date_packed, std::memory_order_relaxed);
+        cache.second_begin_ns.store(second_begin_ns, std::memory_order_relaxed);
+        cache.sequence.store(sequence + 2, std::memory_order_release);
+        return timestamp;
+    }
+
+    u64 time_get_monotonic_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+    }
+
+    timestamp_t timestamp_now() {
+        timestamp_cache_t& cache = s_timestamp_cache;
+        u32 sequence = cache.sequence.load(std::memory_order_acquire);
+
+        if ((sequence & 1) == 0) {
+            const u64 date_packed = cache.date_packed.load(std::memory_order_relaxed);
+            const u64 second_begin_ns = cache.second_begin_ns.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (cache.sequence.load(std::memory_order_relaxed) == sequence) {
+                const u64 now_ns = time_get_monotonic_ns();
+                const u64 elapsed_ns = now_ns - second_begin_ns;
+
+                if (sequence != 0 && now_ns >= second_begin_ns && elapsed_ns < SF_NS_PER_SECOND) {
+                    timestamp_t timestamp;
+                    timestamp.date_time = date_time_unpack(date_packed, elapsed_ns);
+                    timestamp.monotonic_ns = now_ns;
+                    return timestamp;
+                }
+
+                // cached second is over, only one thread is allowed to refresh it
+                if (cache.sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire)) {
+                    return timestamp_cache_refresh(cache, sequence);
+                }
+            }
+        }
+
+        // cache is being refreshed by another thread, computing own timestamp is cheaper than waiting for it
+        u64 date_packed;
+        u64 second_begin_ns;
+        return timestamp_compute(date_packed, second_begin_ns);
+    }
+
+    date_time_t date_time_get_current() {
+        return timestamp_now().date_time;
+    }
+
     time_t time_get_current() {
-        const std::time_t t = std::time(nullptr);
-        const std::tm* lt = std::localtime(&t);
+        const date_time_t date_time = timestamp_now().date_time;
         time_t time = {};
-        time.ms = lt->tm_sec * 1000;
-        time.s = lt->tm_sec;
-        time.min = lt->tm_min;
-        time.h = lt->tm_hour;
+        time.ms = date_time.ms;
+        time.s = date_time.s;
+        time.min = date_time.min;
+        time.h = date_time.h;
         return time;
     }
 
     float time_get_current_ms() {
-        const std::time_t t = std::time(nullptr);
-        const std::tm* lt = std::localtime(&t);
-        return lt->tm_sec * 1000;
+        const date_time_t date_time = timestamp_now().date_time;
+        return static_cast<float>(date_time.s * 1000 + date_time.ms);
     }
 
     mutex_t mutex_init() {
@@ -526,7 +629,6 @@ namespace sf {
     }
 
     void condition_var_wait(condition_var_t& condition_var, mutex_t& mutex) {
-        pthread_mutex_lock(&mutex.handle);
         int result = pthread_cond_wait(&condition_var.handle, &mutex.handle);
         SF_ASSERT(result == 0, "Unable to wait a pthread with condition var");
     }
@@ -536,6 +638,11 @@ namespace sf {
         SF_ASSERT(result == 0, "Unable to notify a pthread with condition var");
     }
 
+    void condition_var_notify_all(condition_var_t& condition_var) {
+        int result = pthread_cond_broadcast(&condition_var.handle);
+        SF_ASSERT(result == 0, "Unable to notify all pthreads with condition var");
+    }
+
     u32 thread_get_pid() {
         return getpid();
     }
@@ -558,20 +665,27 @@ namespace sf {
         pthread_exit(0);
     }
 
+// SIGABRT is left for crash handling, so that aborting the process is not mistaken for a thread exit
+#if defined(SIGUSR1)
+#define SF_THREAD_EXIT_SIGNAL SIGUSR1
+#else
+#define SF_THREAD_EXIT_SIGNAL SIGABRT
+#endif
+
     thread_t thread_init(const char *name, SF_THREAD_PRIORITY priority) {
         thread_t thread;
         thread.name = name;
         thread.priority = priority;
-        signal(SIGABRT, [](int) {
+        signal(SF_THREAD_EXIT_SIGNAL, [](int) {
             pthread_exit(0);
         });
         return thread;
     }
 
     void thread_free(const thread_t &thread) {
-        int result = pthread_kill(thread.handle, SIGABRT);
+        int result = pthread_kill(thread.handle, SF_THREAD_EXIT_SIGNAL);
         SF_ASSERT(result == 0, "Unable to free a Thread=%s", thread.name);
-        signal(SIGABRT, SIG_DFL);
+        signal(SF_THREAD_EXIT_SIGNAL, SIG_DFL);
     }
 
     static void* thread_run_function(void* thread) {
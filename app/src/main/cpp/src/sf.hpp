@@ -1,10 +1,13 @@
 #pragma once
 
 #include <cstdint>
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <csignal>
 #include <cstdio>
 #include <functional>
+#include <memory>
 #include <pthread.h>
 #include <cstring>
 #include <string>
@@ -566,6 +569,19 @@ namespace sf {
 
     SF_API date_time_t date_time_get_current();
 
+    struct SF_API timestamp_t final {
+        date_time_t date_time; // wall-clock time, broken-down date is cached once per second
+        u64 monotonic_ns;      // monotonic ticks in nanoseconds, unaffected by wall-clock adjustments
+    };
+
+    /**
+     * Never waits for other threads: the cached date is refreshed once per second by a single thread,
+     * every other call only reads it and derives milliseconds from the monotonic clock.
+     * Calls, which race with the refresh, call localtime themselves instead of waiting for it.
+     */
+    SF_API timestamp_t timestamp_now();
+    SF_API u64 time_get_monotonic_ns();
+
     struct SF_API time_t final {
         i64 h;   // hour
         i64 min; // minute
@@ -589,11 +605,18 @@ namespace sf {
         circular_buffer_t<T, A> circular_buffer;
         circular_buffer.elements = static_cast<T*>(A().allocate(sizeof(T) * size));
         circular_buffer.size = size;
+        // elements are assigned on push, so they have to be constructed first
+        for (usize i = 0 ; i < size ; i++) {
+            new (circular_buffer.elements + i) T();
+        }
         return circular_buffer;
     }
 
     template<typename T, typename A>
     void circular_buffer_free(const circular_buffer_t<T, A>& circular_buffer) {
+        for (usize i = 0 ; i < circular_buffer.size ; i++) {
+            circular_buffer.elements[i].~T();
+        }
         A().deallocate(circular_buffer.elements);
     }
 
@@ -616,7 +639,7 @@ namespace sf {
         bool popped = false;
 
         if (circular_buffer.tail != circular_buffer.head) {
-            item = circular_buffer.elements[circular_buffer.tail];
+            item = std::move(circular_buffer.elements[circular_buffer.tail]);
             circular_buffer.tail = (circular_buffer.tail + 1) % circular_buffer.size;
             popped = true;
         }
@@ -639,8 +662,10 @@ namespace sf {
 
     SF_API condition_var_t condition_var_init();
     SF_API void condition_var_free(condition_var_t& condition_var);
+    // mutex must be locked by caller, it's unlocked while waiting and locked again before return
     SF_API void condition_var_wait(condition_var_t& condition_var, mutex_t& mutex);
     SF_API void condition_var_notify(condition_var_t& condition_var);
+    SF_API void condition_var_notify_all(condition_var_t& condition_var);
 
     typedef void (*thread_run_function_t) (void* args);
 
@@ -673,6 +698,7 @@ namespace sf {
         bool running = false;
         thread_t* threads = nullptr;
         usize thread_size = 0;
+        // tasks and running are guarded by mutex_wake
         circular_buffer_t<task_t, A> tasks;
         mutex_t mutex_wake = {};
         condition_var_t condition_var_wake = {};
@@ -702,41 +728,110 @@ namespace sf {
             thread.run_args = &thread_pool;
             thread.run_function = [] (void* args) {
                 auto& thread_pool = *static_cast<thread_pool_t<A>*>(args);
-                while (thread_pool.running) {
-                    if (task_t task; circular_buffer_pop(thread_pool.tasks, task)) {
-                        task();
-                    }
-                    else {
-                        // because we don't want to overhead cpu core with thread while loop
-                        // it's better to simply put thread into wait, until it is notified by outer thread with wake condition variable
+                while (true) {
+                    task_t task;
+                    mutex_lock(thread_pool.mutex_wake);
+                    // because we don't want to overhead cpu core with thread while loop
+                    // it's better to simply put thread into wait, until it is notified by outer thread with wake condition variable
+                    while (thread_pool.running && !circular_buffer_pop(thread_pool.tasks, task)) {
                         condition_var_wait(thread_pool.condition_var_wake, thread_pool.mutex_wake);
                     }
+                    const bool running = thread_pool.running;
+                    mutex_unlock(thread_pool.mutex_wake);
+
+                    if (!running) {
+                        break;
+                    }
+                    task();
                 }
             };
             thread_run(thread);
-            thread_detach(thread);
         }
     }
 
     template<typename A>
     void thread_pool_free(thread_pool_t<A>& thread_pool) {
+        mutex_lock(thread_pool.mutex_wake);
+        const bool running = thread_pool.running;
         thread_pool.running = false;
-        const usize thread_size = thread_pool.thread_size;
-        for (int i = 0 ; i < thread_size ; i++) {
-            thread_free(thread_pool.threads[i]);
+        mutex_unlock(thread_pool.mutex_wake);
+        condition_var_notify_all(thread_pool.condition_var_wake);
+
+        // threads return from run function by themselves, killing them could leave mutex locked
+        if (running) {
+            const usize thread_size = thread_pool.thread_size;
+            for (usize i = 0 ; i < thread_size ; i++) {
+                thread_join(thread_pool.threads[i]);
+            }
         }
         A().deallocate(thread_pool.threads);
         circular_buffer_free(thread_pool.tasks);
+        mutex_free(thread_pool.mutex_wake);
+        condition_var_free(thread_pool.condition_var_wake);
+    }
+
+    // returns false, if task queue is full
+    template<typename A>
+    bool thread_pool_try_add_task(thread_pool_t<A>& thread_pool, const task_t& task) {
+        mutex_lock(thread_pool.mutex_wake);
+        const bool pushed = circular_buffer_push<task_t>(thread_pool.tasks, task);
+        mutex_unlock(thread_pool.mutex_wake);
+        condition_var_notify(thread_pool.condition_var_wake);
+        return pushed;
     }
 
     template<typename A>
     void thread_pool_add_task(thread_pool_t<A>& thread_pool, const task_t& task) {
         // try to push a new task until it is pushed
-        while (!circular_buffer_push<task_t>(thread_pool.tasks, task)) {
-            condition_var_notify(thread_pool.condition_var_wake);
+        while (!thread_pool_try_add_task(thread_pool, task)) {
+            thread_yield();
+        }
+    }
+
+    // number of chunks thread_pool_parallel_for() splits count into, one per pool thread and one for the calling thread
+    template<typename A>
+    u32 thread_pool_chunk_count(const thread_pool_t<A>& thread_pool, u32 count) {
+        return std::max(std::min(u32(thread_pool.thread_size + 1), count), 1u);
+    }
+
+    /**
+     * Splits [0, count) into thread_pool_chunk_count() chunks and returns when all of them are done.
+     * Pool threads and the calling thread claim chunks from shared counter, so the call finishes
+     * even if no pool thread picks up its task, it only waits for chunks already taken by pool threads.
+     * Tasks are never waited for to fit into the queue, chunks without a task are run by the calling thread,
+     * so it's safe to call with full queue, stopped pool or from a pool thread.
+     */
+    template<typename A, typename F>
+    void thread_pool_parallel_for(thread_pool_t<A>& thread_pool, u32 count, const F& function) {
+        struct parallel_for_t final {
+            std::atomic<u32> next_chunk { 0 };
+            std::atomic<u32> done_chunks { 0 };
+        };
+
+        const u32 chunk_count = thread_pool_chunk_count(thread_pool, count);
+        const u32 chunk_size = (count + chunk_count - 1) / chunk_count;
+        // tasks may be popped after return, so they share counters and touch function only for claimed chunks
+        const auto state = std::make_shared<parallel_for_t>();
+        const F* function_ptr = &function;
+
+        auto run = [state, function_ptr, chunk_count, chunk_size, count]() {
+            for (u32 chunk = state->next_chunk.fetch_add(1, std::memory_order_relaxed) ; chunk < chunk_count ; chunk = state->next_chunk.fetch_add(1, std::memory_order_relaxed)) {
+                (*function_ptr)(chunk, std::min(chunk * chunk_size, count), std::min((chunk + 1) * chunk_size, count));
+                state->done_chunks.fetch_add(1, std::memory_order_release);
+            }
+        };
+
+        for (u32 chunk = 1 ; chunk < chunk_count ; chunk++) {
+            if (!thread_pool_try_add_task(thread_pool, run)) {
+                break;
+            }
+        }
+
+        run();
+
+        while (state->done_chunks.load(std::memory_order_acquire) < chunk_count) {
             thread_yield();
         }
-        condition_var_notify(thread_pool.condition_var_wake);
     }
 
 }
\ No newline at end of file
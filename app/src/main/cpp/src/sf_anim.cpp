@@ -0,0 +1,197 @@
+#include <sf_anim.hpp>
+
+// scratch floats per joint: 2 keys of quat channel, 2 control points and interpolation factor
+#define SF_ANIM_SCRATCH_STRIDE 17
+
+namespace sf {
+
+    void lerp_soa(const float3_soa_t& a, const float3_soa_t& b, const float* t, const float3_soa_t& out, usize count) {
+        usize i = 0;
+
+        for (; i + SF_SIMD_WIDTH <= count ; i += SF_SIMD_WIDTH) {
+            const simdf_t ti = simdf_load(t + i);
+            const simdf_t ax = simdf_load(a.x + i);
+            const simdf_t ay = simdf_load(a.y + i);
+            const simdf_t az = simdf_load(a.z + i);
+            simdf_store(out.x + i, simdf_add(ax, simdf_mul(simdf_sub(simdf_load(b.x + i), ax), ti)));
+            simdf_store(out.y + i, simdf_add(ay, simdf_mul(simdf_sub(simdf_load(b.y + i), ay), ti)));
+            simdf_store(out.z + i, simdf_add(az, simdf_mul(simdf_sub(simdf_load(b.z + i), az), ti)));
+        }
+
+        for (; i < count ; i++) {
+            out.x[i] = a.x[i] + (b.x[i] - a.x[i]) * t[i];
+            out.y[i] = a.y[i] + (b.y[i] - a.y[i]) * t[i];
+            out.z[i] = a.z[i] + (b.z[i] - a.z[i]) * t[i];
+        }
+    }
+
+    void anim_track_compute_tangents(const anim_track_quat_t& track, quat_t* tangents) {
+        for (u32 i = 0 ; i < track.count ; i++) {
+            const quat_t& q_prev = track.values[i > 0 ? i - 1 : i];
+            const quat_t& q_next = track.values[i + 1 < track.count ? i + 1 : i];
+            tangents[i] = squad_tangent(q_prev, track.values[i], q_next);
+        }
+    }
+
+    u32 anim_cursor_seek(u32 cursor, const float* times, u32 count, float time) {
+        if (cursor >= count || time < times[cursor]) {
+            cursor = 0;
+        }
+
+        while (cursor + 1 < count && times[cursor + 1] <= time) {
+            cursor++;
+        }
+
+        return cursor;
+    }
+
+    // finds keys around time and returns interpolation factor between them
+    static float anim_cursor_advance(u32& cursor, u32& next, const float* times, u32 count, float time) {
+        cursor = anim_cursor_seek(cursor, times, count, time);
+        next = cursor + 1 < count ? cursor + 1 : cursor;
+        if (next == cursor) {
+            return 0;
+        }
+        float t = (time - times[cursor]) / (times[next] - times[cursor]);
+        return std::min(std::max(t, 0.0f), 1.0f);
+    }
+
+    anim_sampler_t anim_sampler_init(const anim_clip_t& clip, SF_ANIM_INTERPOLATION interpolation) {
+        anim_sampler_t sampler;
+        sampler.clip = &clip;
+        sampler.interpolation = interpolation;
+        sampler.cursors = calloc_t<u32>(clip.joint_count * 3);
+        sampler.scratch = malloc_t<float>(clip.joint_count * SF_ANIM_SCRATCH_STRIDE);
+
+        if (interpolation == SF_ANIM_INTERPOLATION_SQUAD) {
+            for (u32 i = 0 ; i < clip.joint_count ; i++) {
+                SF_ASSERT(clip.rotations[i].count == 0 || clip.rotations[i].tangents != nullptr, "anim_sampler_init(): squad requires tangents of rotation tracks!");
+            }
+        }
+
+        return sampler;
+    }
+
+    void anim_sampler_free(anim_sampler_t& sampler) {
+        sf::free(sampler.cursors);
+        sf::free(sampler.scratch);
+        sampler.cursors = nullptr;
+        sampler.scratch = nullptr;
+    }
+
+    void anim_sampler_reset(anim_sampler_t& sampler) {
+        for (u32 i = 0 ; i < sampler.clip->joint_count * 3 ; i++) {
+            sampler.cursors[i] = 0;
+        }
+    }
+
+    static void anim_sample_float3(
+            const anim_track_float3_t* tracks,
+            u32* cursors,
+            u32 joint_count,
+            float time,
+            const float3_t& empty_value,
+            float* scratch,
+            const float3_soa_t& out
+    ) {
+        const float3_soa_t a = { scratch, scratch + joint_count, scratch + joint_count * 2 };
+        const float3_soa_t b = { scratch + joint_count * 3, scratch + joint_count * 4, scratch + joint_count * 5 };
+        float* t = scratch + joint_count * 6;
+
+        for (u32 i = 0 ; i < joint_count ; i++) {
+            const anim_track_float3_t& track = tracks[i];
+            float3_t va = empty_value;
+            float3_t vb = empty_value;
+            t[i] = 0;
+
+            if (track.count > 0) {
+                u32 next;
+                t[i] = anim_cursor_advance(cursors[i], next, track.times, track.count, time);
+                va = track.values[cursors[i]];
+                vb = track.values[next];
+            }
+
+            a.x[i] = va.x;
+            a.y[i] = va.y;
+            a.z[i] = va.z;
+            b.x[i] = vb.x;
+            b.y[i] = vb.y;
+            b.z[i] = vb.z;
+        }
+
+        lerp_soa(a, b, t, out, joint_count);
+    }
+
+    static void quat_soa_set(const quat_soa_t& soa, u32 i, const quat_t& q) {
+        soa.x[i] = q.x;
+        soa.y[i] = q.y;
+        soa.z[i] = q.z;
+        soa.w[i] = q.w;
+    }
+
+    static void anim_sample_quat(
+            const anim_track_quat_t* tracks,
+            u32* cursors,
+            u32 joint_count,
+            float time,
+            SF_ANIM_INTERPOLATION interpolation,
+            float* scratch,
+            const quat_soa_t& out
+    ) {
+        const u32 n = joint_count;
+        const quat_soa_t q1 = { scratch, scratch + n, scratch + n * 2, scratch + n * 3 };
+        const quat_soa_t q2 = { scratch + n * 4, scratch + n * 5, scratch + n * 6, scratch + n * 7 };
+        float* t = scratch + n * 8;
+        const quat_soa_t a1 = { scratch + n * 9, scratch + n * 10, scratch + n * 11, scratch + n * 12 };
+        const quat_soa_t a2 = { scratch + n * 13, scratch + n * 14, scratch + n * 15, scratch + n * 16 };
+        const bool squad = interpolation == SF_ANIM_INTERPOLATION_SQUAD;
+
+        for (u32 i = 0 ; i < n ; i++) {
+            const anim_track_quat_t& track = tracks[i];
+            quat_t v1, v2, c1, c2;
+            t[i] = 0;
+
+            if (track.count > 0) {
+                u32 next;
+                t[i] = anim_cursor_advance(cursors[i], next, track.times, track.count, time);
+                v1 = track.values[cursors[i]];
+                v2 = track.values[next];
+                if (squad) {
+                    c1 = track.tangents[cursors[i]];
+                    c2 = track.tangents[next];
+                }
+            }
+
+            quat_soa_set(q1, i, v1);
+            quat_soa_set(q2, i, v2);
+            if (squad) {
+                quat_soa_set(a1, i, c1);
+                quat_soa_set(a2, i, c2);
+            }
+        }
+
+        switch (interpolation) {
+            case SF_ANIM_INTERPOLATION_NLERP:
+                nlerp_soa<accuracy_fast_t>(q1, q2, t, out, n);
+                break;
+            case SF_ANIM_INTERPOLATION_SLERP:
+                slerp_soa<accuracy_fast_t>(q1, q2, t, out, n);
+                break;
+            case SF_ANIM_INTERPOLATION_SQUAD:
+                squad_soa<accuracy_fast_t>(q1, q2, a1, a2, t, out, n);
+                break;
+        }
+    }
+
+    void anim_sample(anim_sampler_t& sampler, float time, const float3_soa_t& translations, const quat_soa_t& rotations, const float3_soa_t& scales) {
+        const anim_clip_t& clip = *sampler.clip;
+        const u32 n = clip.joint_count;
+        if (clip.duration > 0) {
+            time = clip.looping ? time - clip.duration * std::floor(time / clip.duration) : std::min(std::max(time, 0.0f), clip.duration);
+        }
+        anim_sample_float3(clip.translations, sampler.cursors, n, time, { 0, 0, 0 }, sampler.scratch, translations);
+        anim_sample_quat(clip.rotations, sampler.cursors + n, n, time, sampler.interpolation, sampler.scratch, rotations);
+        anim_sample_float3(clip.scales, sampler.cursors + n * 2, n, time, { 1, 1, 1 }, sampler.scratch, scales);
+    }
+
+}
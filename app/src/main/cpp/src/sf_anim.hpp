@@ -0,0 +1,262 @@
+#pragma once
+
+#include <sf_math.hpp>
+
+enum SF_ANIM_INTERPOLATION
+{
+    SF_ANIM_INTERPOLATION_NLERP = 0,
+    SF_ANIM_INTERPOLATION_SLERP = 1,
+    SF_ANIM_INTERPOLATION_SQUAD = 2,
+};
+
+namespace sf {
+
+    /**
+     * Batched quaternion interpolation over SoA arrays, 4 quaternions per iteration.
+     * Tail is padded into 4 lanes, so every element goes through the same SIMD code.
+     * All the kernels interpolate by the shortest arc.
+     */
+
+    struct SF_API quat_simd4_t final {
+        simd4f_t x;
+        simd4f_t y;
+        simd4f_t z;
+        simd4f_t w;
+    };
+
+    inline quat_simd4_t quat_simd4_load(const quat_soa_t& q, usize i) {
+        return { simd4f_loadu(q.x + i), simd4f_loadu(q.y + i), simd4f_loadu(q.z + i), simd4f_loadu(q.w + i) };
+    }
+
+    inline void quat_simd4_store(const quat_soa_t& q, usize i, const quat_simd4_t& v) {
+        simd4f_storeu(q.x + i, v.x);
+        simd4f_storeu(q.y + i, v.y);
+        simd4f_storeu(q.z + i, v.z);
+        simd4f_storeu(q.w + i, v.w);
+    }
+
+    inline simd4f_t quat_simd4_dot(const quat_simd4_t& a, const quat_simd4_t& b) {
+        return simd4f_add(simd4f_add(simd4f_add(simd4f_mul(a.x, b.x), simd4f_mul(a.y, b.y)), simd4f_mul(a.z, b.z)), simd4f_mul(a.w, b.w));
+    }
+
+    inline quat_simd4_t quat_simd4_scale(const quat_simd4_t& q, simd4f_t s) {
+        return { simd4f_mul(q.x, s), simd4f_mul(q.y, s), simd4f_mul(q.z, s), simd4f_mul(q.w, s) };
+    }
+
+    // a * ca + b * cb
+    inline quat_simd4_t quat_simd4_blend(const quat_simd4_t& a, simd4f_t ca, const quat_simd4_t& b, simd4f_t cb) {
+        return {
+                simd4f_add(simd4f_mul(a.x, ca), simd4f_mul(b.x, cb)),
+                simd4f_add(simd4f_mul(a.y, ca), simd4f_mul(b.y, cb)),
+                simd4f_add(simd4f_mul(a.z, ca), simd4f_mul(b.z, cb)),
+                simd4f_add(simd4f_mul(a.w, ca), simd4f_mul(b.w, cb))
+        };
+    }
+
+    template<typename accuracy_t = accuracy_precise_t>
+    inline quat_simd4_t quat_simd4_normalize(const quat_simd4_t& q) {
+        return quat_simd4_scale(q, accuracy_t::rsqrt(quat_simd4_dot(q, q)));
+    }
+
+    // flips lanes of b to the hemisphere of a, returns |dot(a, b)|
+    inline simd4f_t quat_simd4_shortest(const quat_simd4_t& a, quat_simd4_t& b) {
+        const simd4f_t d = quat_simd4_dot(a, b);
+        const simd4f_t sign = simd4f_select(simd4f_less(d, simd4f_zero()), simd4f_splat(-1.0f), simd4f_splat(1.0f));
+        b = quat_simd4_scale(b, sign);
+        return simd4f_abs(d);
+    }
+
+    // same as nlerp_corrected() per lane
+    template<typename accuracy_t = accuracy_precise_t>
+    inline quat_simd4_t nlerp_simd4(const quat_simd4_t& a, quat_simd4_t b, simd4f_t t) {
+        const simd4f_t d = quat_simd4_shortest(a, b);
+        const simd4f_t half = simd4f_splat(0.5f);
+        const simd4f_t one = simd4f_splat(1.0f);
+
+        simd4f_t ka = simd4f_sub(simd4f_splat(3.55645f), simd4f_mul(d, simd4f_splat(1.43519f)));
+        ka = simd4f_add(simd4f_splat(-3.2452f), simd4f_mul(d, ka));
+        ka = simd4f_add(simd4f_splat(1.0904f), simd4f_mul(d, ka));
+        simd4f_t kb = simd4f_add(simd4f_splat(-1.06021f), simd4f_mul(d, simd4f_splat(0.215638f)));
+        kb = simd4f_add(simd4f_splat(0.848013f), simd4f_mul(d, kb));
+
+        const simd4f_t th = simd4f_sub(t, half);
+        const simd4f_t k = simd4f_add(simd4f_mul(simd4f_mul(ka, th), th), kb);
+        t = simd4f_add(t, simd4f_mul(simd4f_mul(simd4f_mul(t, th), simd4f_sub(t, one)), k));
+
+        return quat_simd4_normalize<accuracy_t>(quat_simd4_blend(a, simd4f_sub(one, t), b, t));
+    }
+
+    // same as slerp() per lane, nearly parallel lanes fall back to normalized lerp
+    template<typename accuracy_t = accuracy_precise_t>
+    inline quat_simd4_t slerp_simd4(const quat_simd4_t& a, quat_simd4_t b, simd4f_t t) {
+        const simd4f_t d = quat_simd4_shortest(a, b);
+        const simd4f_t one = simd4f_splat(1.0f);
+        const simd4f_t u = simd4f_sub(one, t);
+        const simd4f_t theta = accuracy_t::acos(d);
+
+        simd4f_t st, sut, stt, c;
+        accuracy_t::sincos(theta, st, c);
+        accuracy_t::sincos(simd4f_mul(u, theta), sut, c);
+        accuracy_t::sincos(simd4f_mul(t, theta), stt, c);
+
+        // division by zero in parallel lanes is discarded by select
+        const simd4f_t parallel = simd4f_less(simd4f_splat(0.9995f), d);
+        const simd4f_t ca = simd4f_select(parallel, u, simd4f_div(sut, st));
+        const simd4f_t cb = simd4f_select(parallel, t, simd4f_div(stt, st));
+
+        const quat_simd4_t q = quat_simd4_blend(a, ca, b, cb);
+        return quat_simd4_normalize<accuracy_t>(q);
+    }
+
+    template<typename accuracy_t = accuracy_precise_t>
+    inline quat_simd4_t squad_simd4(const quat_simd4_t& q1, const quat_simd4_t& q2, const quat_simd4_t& a1, const quat_simd4_t& a2, simd4f_t t) {
+        const simd4f_t h = simd4f_mul(simd4f_mul(simd4f_splat(2.0f), t), simd4f_sub(simd4f_splat(1.0f), t));
+        return slerp_simd4<accuracy_t>(slerp_simd4<accuracy_t>(q1, q2, t), slerp_simd4<accuracy_t>(a1, a2, t), h);
+    }
+
+    // copies tail of SoA arrays into 4 lanes padded with identity and t = 0
+    struct SF_API quat_soa_tail_t final {
+        alignas(SF_SIMD_ALIGNMENT) float x[4] = { 0, 0, 0, 0 };
+        alignas(SF_SIMD_ALIGNMENT) float y[4] = { 0, 0, 0, 0 };
+        alignas(SF_SIMD_ALIGNMENT) float z[4] = { 0, 0, 0, 0 };
+        alignas(SF_SIMD_ALIGNMENT) float w[4] = { 1, 1, 1, 1 };
+
+        quat_soa_tail_t() = default;
+
+        quat_soa_tail_t(const quat_soa_t& q, usize i, usize count) {
+            for (usize j = 0 ; j < count ; j++) {
+                x[j] = q.x[i + j];
+                y[j] = q.y[i + j];
+                z[j] = q.z[i + j];
+                w[j] = q.w[i + j];
+            }
+        }
+
+        inline quat_soa_t soa() {
+            return { x, y, z, w };
+        }
+    };
+
+    inline void quat_soa_copy(const quat_soa_t& dst, usize i, const quat_soa_t& src, usize count) {
+        for (usize j = 0 ; j < count ; j++) {
+            dst.x[i + j] = src.x[j];
+            dst.y[i + j] = src.y[j];
+            dst.z[i + j] = src.z[j];
+            dst.w[i + j] = src.w[j];
+        }
+    }
+
+    template<typename accuracy_t = accuracy_precise_t>
+    inline void nlerp_soa(const quat_soa_t& q1, const quat_soa_t& q2, const float* t, const quat_soa_t& out, usize count) {
+        usize i = 0;
+        for (; i + 4 <= count ; i += 4) {
+            quat_simd4_store(out, i, nlerp_simd4<accuracy_t>(quat_simd4_load(q1, i), quat_simd4_load(q2, i), simd4f_loadu(t + i)));
+        }
+        if (i < count) {
+            const usize tail = count - i;
+            quat_soa_tail_t a(q1, i, tail), b(q2, i, tail), r;
+            alignas(SF_SIMD_ALIGNMENT) float tt[4] = { 0, 0, 0, 0 };
+            std::copy(t + i, t + count, tt);
+            quat_simd4_store(r.soa(), 0, nlerp_simd4<accuracy_t>(quat_simd4_load(a.soa(), 0), quat_simd4_load(b.soa(), 0), simd4f_load(tt)));
+            quat_soa_copy(out, i, r.soa(), tail);
+        }
+    }
+
+    template<typename accuracy_t = accuracy_precise_t>
+    inline void slerp_soa(const quat_soa_t& q1, const quat_soa_t& q2, const float* t, const quat_soa_t& out, usize count) {
+        usize i = 0;
+        for (; i + 4 <= count ; i += 4) {
+            quat_simd4_store(out, i, slerp_simd4<accuracy_t>(quat_simd4_load(q1, i), quat_simd4_load(q2, i), simd4f_loadu(t + i)));
+        }
+        if (i < count) {
+            const usize tail = count - i;
+            quat_soa_tail_t a(q1, i, tail), b(q2, i, tail), r;
+            alignas(SF_SIMD_ALIGNMENT) float tt[4] = { 0, 0, 0, 0 };
+            std::copy(t + i, t + count, tt);
+            quat_simd4_store(r.soa(), 0, slerp_simd4<accuracy_t>(quat_simd4_load(a.soa(), 0), quat_simd4_load(b.soa(), 0), simd4f_load(tt)));
+            quat_soa_copy(out, i, r.soa(), tail);
+        }
+    }
+
+    template<typename accuracy_t = accuracy_precise_t>
+    inline void squad_soa(
+            const quat_soa_t& q1, const quat_soa_t& q2,
+            const quat_soa_t& a1, const quat_soa_t& a2,
+            const float* t, const quat_soa_t& out, usize count
+    ) {
+        usize i = 0;
+        for (; i + 4 <= count ; i += 4) {
+            quat_simd4_store(out, i, squad_simd4<accuracy_t>(
+                    quat_simd4_load(q1, i), quat_simd4_load(q2, i),
+                    quat_simd4_load(a1, i), quat_simd4_load(a2, i),
+                    simd4f_loadu(t + i)
+            ));
+        }
+        if (i < count) {
+            const usize tail = count - i;
+            quat_soa_tail_t tq1(q1, i, tail), tq2(q2, i, tail), ta1(a1, i, tail), ta2(a2, i, tail), r;
+            alignas(SF_SIMD_ALIGNMENT) float tt[4] = { 0, 0, 0, 0 };
+            std::copy(t + i, t + count, tt);
+            quat_simd4_store(r.soa(), 0, squad_simd4<accuracy_t>(
+                    quat_simd4_load(tq1.soa(), 0), quat_simd4_load(tq2.soa(), 0),
+                    quat_simd4_load(ta1.soa(), 0), quat_simd4_load(ta2.soa(), 0),
+                    simd4f_load(tt)
+            ));
+            quat_soa_copy(out, i, r.soa(), tail);
+        }
+    }
+
+    // out = a + (b - a) * t, out may alias a or b
+    SF_API void lerp_soa(const float3_soa_t& a, const float3_soa_t& b, const float* t, const float3_soa_t& out, usize count);
+
+    /**
+     * Keyframe tracks reference key arrays owned by the caller, key times are ascending and in seconds.
+     * Time before the first key samples the first key, time after the last key samples the last key.
+     */
+
+    struct SF_API anim_track_float3_t final {
+        const float* times = nullptr;
+        const float3_t* values = nullptr;
+        u32 count = 0;
+    };
+
+    struct SF_API anim_track_quat_t final {
+        const float* times = nullptr;
+        const quat_t* values = nullptr;
+        // control points of keys, required only for SF_ANIM_INTERPOLATION_SQUAD, see anim_track_compute_tangents()
+        const quat_t* tangents = nullptr;
+        u32 count = 0;
+    };
+
+    // one track of each channel per joint
+    struct SF_API anim_clip_t final {
+        const anim_track_float3_t* translations = nullptr;
+        const anim_track_quat_t* rotations = nullptr;
+        const anim_track_float3_t* scales = nullptr;
+        u32 joint_count = 0;
+        // sampling time is wrapped into [0, duration) when looping and clamped to [0, duration] otherwise, 0 disables both
+        float duration = 0;
+        bool looping = false;
+    };
+
+    /**
+     * Sampler keeps the last key of every track, so that monotonic playback advances each cursor by at most a few keys
+     * without binary search, rewinding (e.g. looping) restarts the scan from the first key.
+     * Keys are gathered into SoA scratch and interpolated for all the joints at once with accuracy_fast_t.
+     */
+    struct SF_API anim_sampler_t final {
+        const anim_clip_t* clip = nullptr;
+        SF_ANIM_INTERPOLATION interpolation = SF_ANIM_INTERPOLATION_NLERP;
+        // translation, rotation and scale cursors of each joint
+        u32* cursors = nullptr;
+        float* scratch = nullptr;
+    };
+
+    SF_API void anim_track_compute_tangents(const anim_track_quat_t& track, quat_t* tangents);
+    SF_API u32 anim_cursor_seek(u32 cursor, const float* times, u32 count, float time);
+    SF_API anim_sampler_t anim_sampler_init(const anim_clip_t& clip, SF_ANIM_INTERPOLATION interpolation = SF_ANIM_INTERPOLATION_NLERP);
+    SF_API void anim_sampler_free(anim_sampler_t& sampler);
+    SF_API void anim_sampler_reset(anim_sampler_t& sampler);
+    SF_API void anim_sample(anim_sampler_t& sampler, float time, const float3_soa_t& translations, const quat_soa_t& rotations, const float3_soa_t& scales);
+
+}
@@ -8,6 +8,7 @@ namespace sf {
     void app_init() {
         g_system_info = system_info_get();
         g_stl_memory_pool = memory_pool_init(sf::malloc(1_MB), 1_MB, 100);
+        log_crash_handler_install();
         SF_LOG_OPEN("App.log");
         s_app.window = window_init("SF App", 400, 300, 800, 600, true);
         s_app.window.desktop_events.event_window_resize = app_on_window_resize;
@@ -17,6 +18,7 @@ namespace sf {
     void app_free() {
         window_free(s_app.window);
         SF_LOG_CLOSE();
+        log_crash_handler_uninstall();
         memory_pool_free(g_stl_memory_pool);
         sf::free(g_stl_memory_pool.memory);
     }
@@ -27,6 +29,7 @@ namespace sf {
             float begin_time_ms = time_get_current_ms();
 
             s_app.running = window_update(s_app.window);
+            window_present(s_app.window);
 
             float end_time_ms = time_get_current_ms();
             s_app.delta_time = end_time_ms - begin_time_ms;
@@ -337,14 +337,15 @@ namespace sf {
         return {};
     }
 
-    void
+    bool
     audio_buffer_open(audio_buffer_t &audio_buffer, const audio_device_t &audio_device, bool is_playback, u32 channels,
                       u32 sample_rate, u32 buffer_length_usec) {
-
+        audio_buffer.handle = nullptr;
+        return false;
     }
 
-    void audio_buffer_close(const audio_buffer_t &audio_buffer) {
-
+    void audio_buffer_close(audio_buffer_t &audio_buffer) {
+        audio_buffer.handle = nullptr;
     }
 
     void audio_buffer_play(audio_buffer_t &audio_buffer) {
@@ -368,49 +369,305 @@ namespace sf {
 #if defined(SF_LINUX)
 
 #include <pulse/pulseaudio.h>
+#include <pthread.h>
+#include <sched.h>
 
 namespace sf {
 
-    vector_t<audio_device_t> audio_device_get_all() {
-        vector_t<audio_device_t> devices;
+    /**
+     * All streams share one context on threaded mainloop, stream callbacks are called on its thread,
+     * which is raised to real-time priority and holds mainloop lock while it runs them.
+     * Other stream functions lock mainloop only to issue an operation, waiting for server reply releases the lock.
+     * Devices are listed with their own mainloop, so nothing else runs on the real-time thread.
+     */
+    static pa_threaded_mainloop* s_pulse_mainloop = nullptr;
+    static pa_context* s_pulse_context = nullptr;
+
+    static void audio_pulse_signal(pa_context*, void*) {
+        pa_threaded_mainloop_signal(s_pulse_mainloop, 0);
+    }
 
-        pa_threaded_mainloop* mainloop = pa_threaded_mainloop_new();
+    static void audio_pulse_signal_stream(pa_stream*, void*) {
+        pa_threaded_mainloop_signal(s_pulse_mainloop, 0);
+    }
 
-        pa_threaded_mainloop_start(mainloop);
+    static void audio_pulse_signal_success(pa_stream*, int, void*) {
+        pa_threaded_mainloop_signal(s_pulse_mainloop, 0);
+    }
 
-        pa_threaded_mainloop_lock(mainloop);
+    // RLIMIT_RTPRIO may not allow it, then mainloop thread keeps normal priority
+    static void audio_pulse_set_realtime(pa_mainloop_api*, void*) {
+        sched_param param = {};
+        param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+        pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    }
 
-        pa_mainloop_api* mainloop_api = pa_threaded_mainloop_get_api(mainloop);
-        pa_context* context = pa_context_new_with_proplist(mainloop_api, "SF Audio", nullptr);
+    // mainloop must be locked
+    static void audio_pulse_wait(pa_operation* operation) {
+        if (operation == nullptr) {
+            return;
+        }
+        while (pa_operation_get_state(operation) == PA_OPERATION_RUNNING) {
+            pa_threaded_mainloop_wait(s_pulse_mainloop);
+        }
+        pa_operation_unref(operation);
+    }
 
-        void *udata = nullptr;
+    static void audio_pulse_disconnect() {
+        if (s_pulse_mainloop == nullptr) {
+            return;
+        }
+        pa_threaded_mainloop_stop(s_pulse_mainloop);
+        if (s_pulse_context != nullptr) {
+            pa_context_disconnect(s_pulse_context);
+            pa_context_unref(s_pulse_context);
+            s_pulse_context = nullptr;
+        }
+        pa_threaded_mainloop_free(s_pulse_mainloop);
+        s_pulse_mainloop = nullptr;
+    }
 
-        pa_context_disconnect(context);
+    static bool audio_pulse_connect() {
+        if (s_pulse_context != nullptr) {
+            return true;
+        }
 
-        pa_context_unref(context);
+        s_pulse_mainloop = pa_threaded_mainloop_new();
+        if (s_pulse_mainloop == nullptr || pa_threaded_mainloop_start(s_pulse_mainloop) < 0) {
+            audio_pulse_disconnect();
+            return false;
+        }
+
+        pa_threaded_mainloop_lock(s_pulse_mainloop);
+        pa_mainloop_api* mainloop_api = pa_threaded_mainloop_get_api(s_pulse_mainloop);
+        pa_mainloop_api_once(mainloop_api, audio_pulse_set_realtime, nullptr);
+        pa_context* context = pa_context_new(mainloop_api, "SF Audio");
+        pa_context_set_state_callback(context, audio_pulse_signal, nullptr);
+
+        pa_context_state_t state = PA_CONTEXT_FAILED;
+        if (pa_context_connect(context, nullptr, PA_CONTEXT_NOFLAGS, nullptr) >= 0) {
+            for (state = pa_context_get_state(context) ; PA_CONTEXT_IS_GOOD(state) && state != PA_CONTEXT_READY ; state = pa_context_get_state(context)) {
+                pa_threaded_mainloop_wait(s_pulse_mainloop);
+            }
+        }
+        s_pulse_context = context;
+        pa_threaded_mainloop_unlock(s_pulse_mainloop);
+
+        if (state != PA_CONTEXT_READY) {
+            audio_pulse_disconnect();
+            return false;
+        }
+        return true;
+    }
+
+    void audio_system_init() {
+        if (!audio_pulse_connect()) {
+            SF_ASSERT(false, "audio_system_init(): failed to connect to PulseAudio!");
+        }
+    }
 
-        pa_threaded_mainloop_unlock(mainloop);
+    void audio_system_free() {
+        audio_pulse_disconnect();
+    }
 
-        pa_threaded_mainloop_stop(mainloop);
+    // info callbacks of device list run on the thread, which calls audio_device_get_all(), so they may allocate
+    static void audio_pulse_sink_info(pa_context*, const pa_sink_info* info, int eol, void* user_data) {
+        if (eol == 0 && info != nullptr) {
+            static_cast<vector_t<audio_device_t>*>(user_data)->push_back({ info->name, info->description, SF_AUDIO_DEVICE_TYPE_PLAYBACK });
+        }
+    }
 
-        pa_threaded_mainloop_free(mainloop);
+    // monitors of sinks are skipped, they record what is played
+    static void audio_pulse_source_info(pa_context*, const pa_source_info* info, int eol, void* user_data) {
+        if (eol == 0 && info != nullptr && info->monitor_of_sink == PA_INVALID_INDEX) {
+            static_cast<vector_t<audio_device_t>*>(user_data)->push_back({ info->name, info->description, SF_AUDIO_DEVICE_TYPE_RECORDER });
+        }
+    }
 
+    // runs mainloop of device list on the calling thread until operation is done
+    static void audio_pulse_list_wait(pa_mainloop* mainloop, pa_operation* operation) {
+        if (operation == nullptr) {
+            return;
+        }
+        while (pa_operation_get_state(operation) == PA_OPERATION_RUNNING && pa_mainloop_iterate(mainloop, 1, nullptr) >= 0);
+        pa_operation_unref(operation);
+    }
+
+    vector_t<audio_device_t> audio_device_get_all() {
+        vector_t<audio_device_t> devices;
+        pa_mainloop* mainloop = pa_mainloop_new();
+        if (mainloop == nullptr) {
+            return devices;
+        }
+
+        pa_context* context = pa_context_new(pa_mainloop_get_api(mainloop), "SF Audio Devices");
+        if (context != nullptr && pa_context_connect(context, nullptr, PA_CONTEXT_NOFLAGS, nullptr) >= 0) {
+            pa_context_state_t state = pa_context_get_state(context);
+            while (PA_CONTEXT_IS_GOOD(state) && state != PA_CONTEXT_READY && pa_mainloop_iterate(mainloop, 1, nullptr) >= 0) {
+                state = pa_context_get_state(context);
+            }
+            if (state == PA_CONTEXT_READY) {
+                audio_pulse_list_wait(mainloop, pa_context_get_sink_info_list(context, audio_pulse_sink_info, &devices));
+                audio_pulse_list_wait(mainloop, pa_context_get_source_info_list(context, audio_pulse_source_info, &devices));
+            }
+            pa_context_disconnect(context);
+        }
+        if (context != nullptr) {
+            pa_context_unref(context);
+        }
+        pa_mainloop_free(mainloop);
         return devices;
     }
 
-    void audio_buffer_open(audio_buffer_t& audio_buffer, const audio_device_t& audio_device, const bool is_playback, u32 channels, u32 sample_rate, u32 buffer_length_usec) {
+    // frames are written straight into server memory from pa_stream_begin_write(), nothing is copied or allocated,
+    // mainloop is locked while it runs, so it does nothing besides the callback
+    static void audio_pulse_write(pa_stream* stream, size_t size, void* user_data) {
+        audio_buffer_t& audio_buffer = *static_cast<audio_buffer_t*>(user_data);
+        while (size >= audio_buffer.frame_size) {
+            void* data = nullptr;
+            size_t data_size = size;
+            if (pa_stream_begin_write(stream, &data, &data_size) < 0 || data == nullptr) {
+                return;
+            }
+
+            data_size -= data_size % audio_buffer.frame_size;
+            if (data_size == 0) {
+                pa_stream_cancel_write(stream);
+                return;
+            }
+
+            if (audio_buffer.callback != nullptr) {
+                audio_buffer.callback(static_cast<float*>(data), u32(data_size / audio_buffer.frame_size), audio_buffer.user_data);
+            } else {
+                std::memset(data, 0, data_size);
+            }
+            pa_stream_write(stream, data, data_size, nullptr, 0, PA_SEEK_RELATIVE);
+            size -= std::min(size, data_size);
+        }
+    }
+
+    static void audio_pulse_read(pa_stream* stream, size_t, void* user_data) {
+        audio_buffer_t& audio_buffer = *static_cast<audio_buffer_t*>(user_data);
+        const void* data = nullptr;
+        size_t data_size = 0;
+        while (pa_stream_peek(stream, &data, &data_size) >= 0 && data_size > 0) {
+            // null data is a hole in recording, it's dropped without callback
+            if (data != nullptr && audio_buffer.callback != nullptr) {
+                audio_buffer.callback(static_cast<float*>(const_cast<void*>(data)), u32(data_size / audio_buffer.frame_size), audio_buffer.user_data);
+            }
+            pa_stream_drop(stream);
+        }
+    }
+
+    static void audio_pulse_underflow(pa_stream*, void* user_data) {
+        static_cast<audio_buffer_t*>(user_data)->underflow_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Server keeps tlength bytes queued and asks for more once minreq bytes are played,
+     * so latency is close to buffer length and callback runs SF_AUDIO_BUFFER_PERIODS times per buffer.
+     */
+    bool audio_buffer_open(audio_buffer_t& audio_buffer, const audio_device_t& audio_device, const bool is_playback, u32 channels, u32 sample_rate, u32 buffer_length_usec) {
+        audio_buffer.handle = nullptr;
+        if (!audio_pulse_connect()) {
+            return false;
+        }
+
+        const pa_sample_spec spec = { PA_SAMPLE_FLOAT32NE, sample_rate, u8(channels) };
+        buffer_length_usec = std::max(buffer_length_usec, u32(SF_AUDIO_BUFFER_LENGTH_MIN_USEC));
+        pa_buffer_attr attr;
+        attr.maxlength = u32(-1);
+        attr.tlength = u32(pa_usec_to_bytes(buffer_length_usec, &spec));
+        attr.prebuf = u32(-1);
+        attr.minreq = u32(pa_usec_to_bytes(buffer_length_usec / SF_AUDIO_BUFFER_PERIODS, &spec));
+        attr.fragsize = attr.minreq;
+
+        audio_buffer.channels = channels;
+        audio_buffer.sample_rate = sample_rate;
+        audio_buffer.frame_size = u32(pa_frame_size(&spec));
+        audio_buffer.buffer_size = attr.tlength;
+
+        pa_threaded_mainloop_lock(s_pulse_mainloop);
+        pa_stream* stream = pa_stream_new(s_pulse_context, is_playback ? "SF Playback" : "SF Record", &spec, nullptr);
+        if (stream == nullptr) {
+            pa_threaded_mainloop_unlock(s_pulse_mainloop);
+            return false;
+        }
+        pa_stream_set_state_callback(stream, audio_pulse_signal_stream, nullptr);
+        const pa_stream_flags_t flags = pa_stream_flags_t(
+                PA_STREAM_START_CORKED | PA_STREAM_ADJUST_LATENCY | PA_STREAM_INTERPOLATE_TIMING | PA_STREAM_AUTO_TIMING_UPDATE
+        );
+        const char* device = audio_device.id.empty() ? nullptr : audio_device.id.c_str();
+
+        int result;
+        if (is_playback) {
+            pa_stream_set_write_callback(stream, audio_pulse_write, &audio_buffer);
+            pa_stream_set_underflow_callback(stream, audio_pulse_underflow, &audio_buffer);
+            result = pa_stream_connect_playback(stream, device, &attr, flags, nullptr, nullptr);
+        } else {
+            pa_stream_set_read_callback(stream, audio_pulse_read, &audio_buffer);
+            result = pa_stream_connect_record(stream, device, &attr, flags);
+        }
+
+        pa_stream_state_t state = PA_STREAM_FAILED;
+        if (result >= 0) {
+            for (state = pa_stream_get_state(stream) ; PA_STREAM_IS_GOOD(state) && state != PA_STREAM_READY ; state = pa_stream_get_state(stream)) {
+                pa_threaded_mainloop_wait(s_pulse_mainloop);
+            }
+        }
+
+        if (state == PA_STREAM_READY) {
+            audio_buffer.handle = stream;
+        } else {
+            pa_stream_unref(stream);
+        }
+        pa_threaded_mainloop_unlock(s_pulse_mainloop);
+        return audio_buffer.handle != nullptr;
     }
 
-    void audio_buffer_close(const audio_buffer_t& audio_buffer) {
+    void audio_buffer_close(audio_buffer_t& audio_buffer) {
+        pa_stream* stream = static_cast<pa_stream*>(audio_buffer.handle);
+        if (stream == nullptr) {
+            return;
+        }
+        pa_threaded_mainloop_lock(s_pulse_mainloop);
+        pa_stream_set_state_callback(stream, nullptr, nullptr);
+        pa_stream_set_write_callback(stream, nullptr, nullptr);
+        pa_stream_set_read_callback(stream, nullptr, nullptr);
+        pa_stream_set_underflow_callback(stream, nullptr, nullptr);
+        pa_stream_disconnect(stream);
+        pa_stream_unref(stream);
+        pa_threaded_mainloop_unlock(s_pulse_mainloop);
+        audio_buffer.handle = nullptr;
+    }
+
+    static void audio_buffer_uncork(audio_buffer_t& audio_buffer) {
+        pa_stream* stream = static_cast<pa_stream*>(audio_buffer.handle);
+        if (stream == nullptr) {
+            return;
+        }
+        pa_threaded_mainloop_lock(s_pulse_mainloop);
+        audio_pulse_wait(pa_stream_cork(stream, 0, audio_pulse_signal_success, nullptr));
+        pa_threaded_mainloop_unlock(s_pulse_mainloop);
     }
 
     void audio_buffer_play(audio_buffer_t &audio_buffer) {
+        audio_buffer_uncork(audio_buffer);
     }
 
     void audio_buffer_record(audio_buffer_t &audio_buffer) {
+        audio_buffer_uncork(audio_buffer);
     }
 
+    // blocks until everything written is played
     void audio_buffer_drain(audio_buffer_t &audio_buffer) {
+        pa_stream* stream = static_cast<pa_stream*>(audio_buffer.handle);
+        if (stream == nullptr) {
+            return;
+        }
+        pa_threaded_mainloop_lock(s_pulse_mainloop);
+        audio_pulse_wait(pa_stream_drain(stream, audio_pulse_signal_success, nullptr));
+        pa_threaded_mainloop_unlock(s_pulse_mainloop);
     }
 }
 
@@ -6,7 +6,11 @@
 
 #define SF_AUDIO_CHANNELS 2
 #define SF_AUDIO_SAMLE_RATE 48000
-#define SF_AUDIO_BUFFER_LENGTH_USEC 500 * 1000
+#define SF_AUDIO_BUFFER_LENGTH_USEC (500 * 1000)
+// shortest buffer, which is still filled in time on desktop, shorter lengths are clamped to it
+#define SF_AUDIO_BUFFER_LENGTH_MIN_USEC (10 * 1000)
+// buffer is refilled every time it drops by length / periods
+#define SF_AUDIO_BUFFER_PERIODS 4
 
 enum SF_AUDIO_DEVICE_TYPE {
     SF_AUDIO_DEVICE_TYPE_PLAYBACK,
@@ -66,13 +70,27 @@ namespace sf {
 
     SF_API vector_t<audio_device_t> audio_device_get_all();
 
+    // interleaved float samples, playback callback fills frame_count frames, recorder callback reads them
+    typedef void (*audio_callback_t)(float* samples, u32 frame_count, void* user_data);
+
+    /**
+     * Callback runs on real-time audio thread whenever server needs more frames, so it must not allocate, lock or block.
+     * Callback and user data are set before audio_buffer_open() and buffer must not move until audio_buffer_close().
+     */
     struct SF_API audio_buffer_t final {
         void* handle = nullptr;
         u32 frame_size = 0;
         u32 buffer_size = 0;
+        u32 channels = SF_AUDIO_CHANNELS;
+        u32 sample_rate = SF_AUDIO_SAMLE_RATE;
+        audio_callback_t callback = nullptr;
+        void* user_data = nullptr;
+        // times server ran out of frames, written by audio thread
+        std::atomic<u32> underflow_count = { 0 };
     };
 
-    SF_API void audio_buffer_open(
+    // returns false and leaves handle null, when stream can't be connected to device
+    SF_API bool audio_buffer_open(
         audio_buffer_t& audio_buffer,
         const audio_device_t& audio_device,
         bool is_playback,
@@ -80,7 +98,8 @@ namespace sf {
         u32 sample_rate = SF_AUDIO_SAMLE_RATE,
         u32 buffer_length_usec = SF_AUDIO_BUFFER_LENGTH_USEC
     );
-    SF_API void audio_buffer_close(const audio_buffer_t& audio_buffer);
+    // handle is set to null, so closing twice does nothing
+    SF_API void audio_buffer_close(audio_buffer_t& audio_buffer);
     SF_API void audio_buffer_play(audio_buffer_t& audio_buffer);
     SF_API void audio_buffer_record(audio_buffer_t& audio_buffer);
     SF_API void audio_buffer_drain(audio_buffer_t& audio_buffer);
@@ -0,0 +1,419 @@
+#include <sf_bvh.hpp>
+
+#include <algorithm>
+
+#define SF_BVH_BIN_COUNT 12
+// cost of visiting a node relative to testing one primitive
+#define SF_BVH_TRAVERSAL_COST 1.0f
+
+namespace sf {
+
+    struct bvh_bin_t final {
+        aabb_t bounds = aabb_empty();
+        u32 count = 0;
+    };
+
+    struct bvh_builder_t final {
+        bvh_t& bvh;
+        const aabb_t* bounds;
+        const float3_t* centroids;
+    };
+
+    static bool bvh_is_leaf(const bvh_node_t& node) {
+        return node.count > 0;
+    }
+
+    static u32 bvh_bin_index(float centroid, float min, float scale) {
+        return std::min(u32((centroid - min) * scale), u32(SF_BVH_BIN_COUNT - 1));
+    }
+
+    // returns split bin for the best axis or SF_BVH_INVALID, when leaf is cheaper or all centroids coincide
+    static u32 bvh_find_split(const bvh_builder_t& builder, u32 begin, u32 end, const aabb_t& bounds, const aabb_t& centroid_bounds, int& best_axis) {
+        const u32 count = end - begin;
+        float best_cost = count <= SF_BVH_MAX_LEAF_SIZE ? float(count) : std::numeric_limits<float>::max();
+        u32 best_split = SF_BVH_INVALID;
+        const float inv_area = 1.0f / std::max(aabb_surface_area(bounds), std::numeric_limits<float>::min());
+
+        for (int axis = 0 ; axis < 3 ; axis++) {
+            const float min = centroid_bounds.min[axis];
+            const float extent = centroid_bounds.max[axis] - min;
+            if (extent <= 0) {
+                continue;
+            }
+
+            bvh_bin_t bins[SF_BVH_BIN_COUNT];
+            const float scale = float(SF_BVH_BIN_COUNT) / extent;
+            for (u32 i = begin ; i < end ; i++) {
+                const u32 index = builder.bvh.indices[i];
+                bvh_bin_t& bin = bins[bvh_bin_index(builder.centroids[index][axis], min, scale)];
+                bin.bounds = aabb_merge(bin.bounds, builder.bounds[index]);
+                bin.count++;
+            }
+
+            // right side areas are swept backwards, then left side forward
+            float right_areas[SF_BVH_BIN_COUNT - 1];
+            u32 right_counts[SF_BVH_BIN_COUNT - 1];
+            aabb_t right = aabb_empty();
+            u32 right_count = 0;
+            for (int i = SF_BVH_BIN_COUNT - 1 ; i > 0 ; i--) {
+                right = aabb_merge(right, bins[i].bounds);
+                right_count += bins[i].count;
+                right_areas[i - 1] = aabb_surface_area(right);
+                right_counts[i - 1] = right_count;
+            }
+
+            aabb_t left = aabb_empty();
+            u32 left_count = 0;
+            for (int i = 0 ; i < SF_BVH_BIN_COUNT - 1 ; i++) {
+                left = aabb_merge(left, bins[i].bounds);
+                left_count += bins[i].count;
+                if (left_count == 0 || right_counts[i] == 0) {
+                    continue;
+                }
+                const float cost = SF_BVH_TRAVERSAL_COST + (aabb_surface_area(left) * float(left_count) + right_areas[i] * float(right_counts[i])) * inv_area;
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    best_split = u32(i);
+                    best_axis = axis;
+                }
+            }
+        }
+
+        return best_split;
+    }
+
+    static u32 bvh_build(const bvh_builder_t& builder, u32 begin, u32 end, u32 depth) {
+        bvh_t& bvh = builder.bvh;
+        const u32 node_index = bvh.node_count++;
+
+        aabb_t bounds = aabb_empty();
+        aabb_t centroid_bounds = aabb_empty();
+        for (u32 i = begin ; i < end ; i++) {
+            const u32 index = bvh.indices[i];
+            bounds = aabb_merge(bounds, builder.bounds[index]);
+            centroid_bounds = aabb_merge(centroid_bounds, { builder.centroids[index], builder.centroids[index] });
+        }
+        bvh.nodes[node_index].bounds = bounds;
+
+        const u32 count = end - begin;
+        // depth is limited, so traversal stack never overflows
+        if (count == 1 || depth + 1 >= SF_BVH_STACK_SIZE) {
+            bvh.nodes[node_index].first = begin;
+            bvh.nodes[node_index].count = count;
+            return node_index;
+        }
+
+        int axis = 0;
+        const u32 split = bvh_find_split(builder, begin, end, bounds, centroid_bounds, axis);
+        u32 middle;
+
+        if (split != SF_BVH_INVALID) {
+            const float min = centroid_bounds.min[axis];
+            const float scale = float(SF_BVH_BIN_COUNT) / (centroid_bounds.max[axis] - min);
+            u32* pivot = std::partition(bvh.indices + begin, bvh.indices + end, [&](u32 index) {
+                return bvh_bin_index(builder.centroids[index][axis], min, scale) <= split;
+            });
+            middle = u32(pivot - bvh.indices);
+        } else if (count <= SF_BVH_MAX_LEAF_SIZE) {
+            bvh.nodes[node_index].first = begin;
+            bvh.nodes[node_index].count = count;
+            return node_index;
+        } else {
+            // coincident centroids can't be separated by bins
+            middle = begin + count / 2;
+        }
+
+        bvh_build(builder, begin, middle, depth + 1);
+        const u32 right = bvh_build(builder, middle, end, depth + 1);
+        bvh.nodes[node_index].first = right;
+        bvh.nodes[node_index].count = 0;
+        return node_index;
+    }
+
+    bvh_t bvh_init(const aabb_t* bounds, u32 count) {
+        bvh_t bvh;
+        bvh.primitive_count = count;
+        if (count == 0) {
+            return bvh;
+        }
+
+        bvh.nodes = malloc_t<bvh_node_t>(count * 2 - 1);
+        bvh.indices = malloc_t<u32>(count);
+        bvh.primitive_bounds = malloc_t<aabb_t>(count);
+
+        float3_t* centroids = malloc_t<float3_t>(count);
+        for (u32 i = 0 ; i < count ; i++) {
+            bvh.indices[i] = i;
+            centroids[i] = aabb_center(bounds[i]);
+        }
+
+        bvh_build({ bvh, bounds, centroids }, 0, count, 0);
+        sf::free(centroids);
+
+        for (u32 i = 0 ; i < count ; i++) {
+            bvh.primitive_bounds[i] = bounds[bvh.indices[i]];
+        }
+
+        return bvh;
+    }
+
+    void bvh_free(bvh_t& bvh) {
+        sf::free(bvh.nodes);
+        sf::free(bvh.indices);
+        sf::free(bvh.primitive_bounds);
+        bvh = {};
+    }
+
+    void bvh_refit(bvh_t& bvh, const aabb_t* bounds) {
+        for (u32 i = bvh.node_count ; i-- > 0 ;) {
+            bvh_node_t& node = bvh.nodes[i];
+            if (bvh_is_leaf(node)) {
+                node.bounds = aabb_empty();
+                for (u32 j = node.first ; j < node.first + node.count ; j++) {
+                    bvh.primitive_bounds[j] = bounds[bvh.indices[j]];
+                    node.bounds = aabb_merge(node.bounds, bvh.primitive_bounds[j]);
+                }
+            } else {
+                node.bounds = aabb_merge(bvh.nodes[i + 1].bounds, bvh.nodes[node.first].bounds);
+            }
+        }
+    }
+
+    struct bvh_stack_entry_t final {
+        u32 node;
+        float t;
+    };
+
+    bvh_hit_t bvh_raycast(const bvh_t& bvh, const ray_t& ray, float t_max) {
+        bvh_hit_t hit;
+        const float3_t inv_direction = ray_inverse_direction(ray);
+        float t;
+
+        if (bvh.node_count == 0 || !ray_intersect_aabb(ray.origin, inv_direction, bvh.nodes[0].bounds, t_max, t)) {
+            return hit;
+        }
+
+        bvh_stack_entry_t stack[SF_BVH_STACK_SIZE];
+        u32 stack_size = 0;
+        u32 current = 0;
+
+        while (true) {
+            const bvh_node_t& node = bvh.nodes[current];
+
+            if (bvh_is_leaf(node)) {
+                for (u32 i = node.first ; i < node.first + node.count ; i++) {
+                    if (ray_intersect_aabb(ray.origin, inv_direction, bvh.primitive_bounds[i], t_max, t) && (hit.index == SF_BVH_INVALID || t < t_max)) {
+                        t_max = t;
+                        hit = { bvh.indices[i], t };
+                    }
+                }
+            } else {
+                // nearer child is visited first, farther one waits on stack with its entry distance
+                const u32 left = current + 1;
+                const u32 right = node.first;
+                float t_left, t_right;
+                const bool hit_left = ray_intersect_aabb(ray.origin, inv_direction, bvh.nodes[left].bounds, t_max, t_left);
+                const bool hit_right = ray_intersect_aabb(ray.origin, inv_direction, bvh.nodes[right].bounds, t_max, t_right);
+
+                if (hit_left && hit_right) {
+                    const bool left_first = t_left <= t_right;
+                    stack[stack_size++] = left_first ? bvh_stack_entry_t { right, t_right } : bvh_stack_entry_t { left, t_left };
+                    current = left_first ? left : right;
+                    continue;
+                }
+                if (hit_left || hit_right) {
+                    current = hit_left ? left : right;
+                    continue;
+                }
+            }
+
+            // entries farther than the closest hit are skipped
+            do {
+                if (stack_size == 0) {
+                    return hit;
+                }
+                stack_size--;
+            } while (stack[stack_size].t > t_max);
+            current = stack[stack_size].node;
+        }
+    }
+
+    struct bvh_ray_packet_t final {
+        simd4f_t ox, oy, oz;
+        simd4f_t ix, iy, iz;
+    };
+
+    // lane bits of rays entering the box before their current closest hit
+    static u32 bvh_packet_intersect(const bvh_ray_packet_t& p, const aabb_t& aabb, simd4f_t t_max, simd4f_t& t_enter) {
+        const simd4f_t tx0 = simd4f_mul(simd4f_sub(simd4f_splat(aabb.min.x), p.ox), p.ix);
+        const simd4f_t tx1 = simd4f_mul(simd4f_sub(simd4f_splat(aabb.max.x), p.ox), p.ix);
+        const simd4f_t ty0 = simd4f_mul(simd4f_sub(simd4f_splat(aabb.min.y), p.oy), p.iy);
+        const simd4f_t ty1 = simd4f_mul(simd4f_sub(simd4f_splat(aabb.max.y), p.oy), p.iy);
+        const simd4f_t tz0 = simd4f_mul(simd4f_sub(simd4f_splat(aabb.min.z), p.oz), p.iz);
+        const simd4f_t tz1 = simd4f_mul(simd4f_sub(simd4f_splat(aabb.max.z), p.oz), p.iz);
+        t_enter = simd4f_max(simd4f_max(simd4f_min(tx0, tx1), simd4f_min(ty0, ty1)), simd4f_max(simd4f_min(tz0, tz1), simd4f_zero()));
+        const simd4f_t t_exit = simd4f_min(simd4f_min(simd4f_max(tx0, tx1), simd4f_max(ty0, ty1)), simd4f_min(simd4f_max(tz0, tz1), t_max));
+        return ~simd4f_movemask(simd4f_less(t_exit, t_enter)) & 0xf;
+    }
+
+    void bvh_raycast_packet(const bvh_t& bvh, const ray_t* rays, bvh_hit_t* hits, float t_max) {
+        alignas(SF_SIMD_ALIGNMENT) float best[4] = { t_max, t_max, t_max, t_max };
+        float3_t inv_directions[4];
+        for (int i = 0 ; i < 4 ; i++) {
+            hits[i] = {};
+            inv_directions[i] = ray_inverse_direction(rays[i]);
+        }
+
+        if (bvh.node_count == 0) {
+            return;
+        }
+
+        const bvh_ray_packet_t packet = {
+                simd4f_set(rays[0].origin.x, rays[1].origin.x, rays[2].origin.x, rays[3].origin.x),
+                simd4f_set(rays[0].origin.y, rays[1].origin.y, rays[2].origin.y, rays[3].origin.y),
+                simd4f_set(rays[0].origin.z, rays[1].origin.z, rays[2].origin.z, rays[3].origin.z),
+                simd4f_set(inv_directions[0].x, inv_directions[1].x, inv_directions[2].x, inv_directions[3].x),
+                simd4f_set(inv_directions[0].y, inv_directions[1].y, inv_directions[2].y, inv_directions[3].y),
+                simd4f_set(inv_directions[0].z, inv_directions[1].z, inv_directions[2].z, inv_directions[3].z)
+        };
+        simd4f_t t_best = simd4f_load(best);
+        simd4f_t t_enter;
+
+        u32 stack[SF_BVH_STACK_SIZE];
+        u32 stack_size = 0;
+        stack[stack_size++] = 0;
+
+        while (stack_size > 0) {
+            const u32 current = stack[--stack_size];
+            const bvh_node_t& node = bvh.nodes[current];
+
+            if (bvh_packet_intersect(packet, node.bounds, t_best, t_enter) == 0) {
+                continue;
+            }
+
+            if (!bvh_is_leaf(node)) {
+                stack[stack_size++] = node.first;
+                stack[stack_size++] = current + 1;
+                continue;
+            }
+
+            for (u32 i = node.first ; i < node.first + node.count ; i++) {
+                const u32 mask = bvh_packet_intersect(packet, bvh.primitive_bounds[i], t_best, t_enter);
+                if (mask == 0) {
+                    continue;
+                }
+
+                alignas(SF_SIMD_ALIGNMENT) float t[4];
+                simd4f_store(t, t_enter);
+                for (int j = 0 ; j < 4 ; j++) {
+                    if ((mask & (1u << j)) && (hits[j].index == SF_BVH_INVALID || t[j] < best[j])) {
+                        best[j] = t[j];
+                        hits[j] = { bvh.indices[i], t[j] };
+                    }
+                }
+                t_best = simd4f_load(best);
+            }
+        }
+    }
+
+    // primitives of a subtree are contiguous, they start in the leftmost leaf and end in the rightmost one
+    static u32 bvh_append_subtree(const bvh_t& bvh, u32 node, u32* indices, u32 capacity, u32 found) {
+        u32 first = node;
+        while (!bvh_is_leaf(bvh.nodes[first])) {
+            first++;
+        }
+        u32 last = node;
+        while (!bvh_is_leaf(bvh.nodes[last])) {
+            last = bvh.nodes[last].first;
+        }
+
+        const u32 end = bvh.nodes[last].first + bvh.nodes[last].count;
+        for (u32 i = bvh.nodes[first].first ; i < end ; i++, found++) {
+            if (found < capacity) {
+                indices[found] = bvh.indices[i];
+            }
+        }
+        return found;
+    }
+
+    u32 bvh_query_sphere(const bvh_t& bvh, const sphere_t& sphere, u32* indices, u32 capacity) {
+        u32 found = 0;
+        if (bvh.node_count == 0) {
+            return found;
+        }
+
+        u32 stack[SF_BVH_STACK_SIZE];
+        u32 stack_size = 0;
+        stack[stack_size++] = 0;
+
+        while (stack_size > 0) {
+            const u32 current = stack[--stack_size];
+            const bvh_node_t& node = bvh.nodes[current];
+
+            if (!sphere_overlaps_aabb(sphere, node.bounds)) {
+                continue;
+            }
+
+            if (!bvh_is_leaf(node)) {
+                stack[stack_size++] = node.first;
+                stack[stack_size++] = current + 1;
+                continue;
+            }
+
+            for (u32 i = node.first ; i < node.first + node.count ; i++) {
+                if (sphere_overlaps_aabb(sphere, bvh.primitive_bounds[i])) {
+                    if (found < capacity) {
+                        indices[found] = bvh.indices[i];
+                    }
+                    found++;
+                }
+            }
+        }
+
+        return found;
+    }
+
+    u32 bvh_query_frustum(const bvh_t& bvh, const frustum_t& frustum, u32* indices, u32 capacity) {
+        u32 found = 0;
+        if (bvh.node_count == 0) {
+            return found;
+        }
+
+        u32 stack[SF_BVH_STACK_SIZE];
+        u32 stack_size = 0;
+        stack[stack_size++] = 0;
+
+        while (stack_size > 0) {
+            const u32 current = stack[--stack_size];
+            const bvh_node_t& node = bvh.nodes[current];
+
+            if (!frustum_test_aabb(frustum, node.bounds)) {
+                continue;
+            }
+
+            // whole subtree is visible, primitives are taken without tests
+            if (frustum_contains_aabb(frustum, node.bounds)) {
+                found = bvh_append_subtree(bvh, current, indices, capacity, found);
+                continue;
+            }
+
+            if (!bvh_is_leaf(node)) {
+                stack[stack_size++] = node.first;
+                stack[stack_size++] = current + 1;
+                continue;
+            }
+
+            for (u32 i = node.first ; i < node.first + node.count ; i++) {
+                if (frustum_test_aabb(frustum, bvh.primitive_bounds[i])) {
+                    if (found < capacity) {
+                        indices[found] = bvh.indices[i];
+                    }
+                    found++;
+                }
+            }
+        }
+
+        return found;
+    }
+
+}
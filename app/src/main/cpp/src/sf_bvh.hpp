@@ -0,0 +1,51 @@
+#pragma once
+
+#include <sf_geometry.hpp>
+
+#define SF_BVH_INVALID 0xffffffff
+#define SF_BVH_MAX_LEAF_SIZE 8
+#define SF_BVH_STACK_SIZE 64
+
+namespace sf {
+
+    /**
+     * Nodes are flattened in depth-first order: left child of interior node is the next node, first is the right child.
+     * Leaves have count > 0, first is the offset of their primitives in indices and primitive_bounds.
+     * Children are always stored after parents, so refit walks nodes backwards.
+     */
+    struct SF_API bvh_node_t final {
+        aabb_t bounds;
+        u32 first = 0;
+        u32 count = 0;
+    };
+
+    struct SF_API bvh_t final {
+        bvh_node_t* nodes = nullptr;
+        u32 node_count = 0;
+        // original index of primitive in leaf order
+        u32* indices = nullptr;
+        // copy of primitive bounds in leaf order, so leaves are tested without jumping over the input
+        aabb_t* primitive_bounds = nullptr;
+        u32 primitive_count = 0;
+    };
+
+    struct SF_API bvh_hit_t final {
+        u32 index = SF_BVH_INVALID;
+        float t = 0;
+    };
+
+    // binned SAH build, bounds are copied and aren't referenced after build
+    SF_API bvh_t bvh_init(const aabb_t* bounds, u32 count);
+    SF_API void bvh_free(bvh_t& bvh);
+    // updates bounds after objects moved, topology is kept, so quality degrades with large motion and bvh should be rebuilt
+    SF_API void bvh_refit(bvh_t& bvh, const aabb_t* bounds);
+
+    // closest primitive, which bounds are hit by ray within t_max
+    SF_API bvh_hit_t bvh_raycast(const bvh_t& bvh, const ray_t& ray, float t_max = std::numeric_limits<float>::max());
+    // 4 coherent rays traverse the tree together, node is entered if any of them hits it
+    SF_API void bvh_raycast_packet(const bvh_t& bvh, const ray_t* rays, bvh_hit_t* hits, float t_max = std::numeric_limits<float>::max());
+    // query functions write up to capacity indices and return the number of all found primitives
+    SF_API u32 bvh_query_sphere(const bvh_t& bvh, const sphere_t& sphere, u32* indices, u32 capacity);
+    SF_API u32 bvh_query_frustum(const bvh_t& bvh, const frustum_t& frustum, u32* indices, u32 capacity);
+
+}
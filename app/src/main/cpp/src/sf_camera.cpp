@@ -1,5 +1,9 @@
 #include <sf_camera.hpp>
 
+// rate of targets is averaged over this time in seconds
+#define SF_CAMERA_RATE_SMOOTH_TIME 0.05f
+#define SF_CAMERA_MOTION_MAX_CATCH_UP 0.25f
+
 namespace sf {
 
     camera_t camera_init(int2_t frame_size) {
@@ -24,62 +28,60 @@ namespace sf {
         return zoom_speed * zoom_speed;
     }
 
+    // yaw turns around world up, pitch around camera right and roll around camera front, angles are in radians
+    static quat_t camera_get_rotation(const camera_t& camera) {
+        return quat_axis_angle({ 0.0f, 1.0f, 0.0f }, radians_t(-camera.yaw))
+            * quat_axis_angle({ 1.0f, 0.0f, 0.0f }, radians_t(-camera.pitch))
+            * quat_axis_angle({ 0.0f, 0.0f, 1.0f }, radians_t(camera.roll));
+    }
+
     void camera_pan(camera_t& camera, double2_t pan) {
         float2_t pan_speed = camera_get_pan_speed(camera);
-        quat_t rotation = { -camera.pitch, -camera.yaw, camera.roll, 0 };
+        quat_t rotation = camera_get_rotation(camera);
         float3_t right = rotate(rotation, { 1.0f, 0.0f, 0.0f }).xyz();
         float3_t up = rotate(rotation, { 0.0f, 1.0f, 0.0f }).xyz();
-        camera.focal_point = camera.focal_point + -right * static_cast<float>(pan.x) * pan_speed.x * camera.move_speed;
-        camera.focal_point = camera.focal_point + up * static_cast<float>(pan.y) * pan_speed.y * camera.move_speed;
-        camera_update_view(camera, camera.focal_point);
+        camera.target_position = camera.target_position + -right * static_cast<float>(pan.x) * pan_speed.x * camera.move_speed;
+        camera.target_position = camera.target_position + up * static_cast<float>(pan.y) * pan_speed.y * camera.move_speed;
     }
 
     void camera_move_forward(camera_t& camera) {
-        camera.position = camera.position - camera.front * camera.move_speed;
-        camera_update_view(camera, camera.position);
+        camera.target_position = camera.target_position - camera.front * camera.move_speed;
     }
 
     void camera_move_backward(camera_t& camera) {
-        camera.position = camera.position + camera.front * camera.move_speed;
-        camera_update_view(camera, camera.position);
+        camera.target_position = camera.target_position + camera.front * camera.move_speed;
     }
 
     void camera_move_left(camera_t& camera) {
-        camera.position = camera.position - cross(camera.front, camera.up) * camera.move_speed;
-        camera_update_view(camera, camera.position);
+        camera.target_position = camera.target_position - cross(camera.front, camera.up) * camera.move_speed;
     }
 
     void camera_move_right(camera_t& camera) {
-        camera.position = camera.position + cross(camera.front, camera.up) * camera.move_speed;
-        camera_update_view(camera, camera.position);
+        camera.target_position = camera.target_position + cross(camera.front, camera.up) * camera.move_speed;
     }
 
     void camera_zoom_in(camera_t& camera) {
-        camera.fov -= camera_get_zoom_speed(camera);
-        camera.fov = clamp(camera.min_fov, camera.max_fov, camera.fov);
-        camera_update_perspective(camera);
+        camera.target_fov -= camera_get_zoom_speed(camera);
+        camera.target_fov = clamp(camera.min_fov, camera.max_fov, camera.target_fov);
     }
 
     void camera_zoom_out(camera_t& camera) {
-        camera.fov += camera_get_zoom_speed(camera);
-        camera.fov = clamp(camera.min_fov, camera.max_fov, camera.fov);
-        camera_update_perspective(camera);
+        camera.target_fov += camera_get_zoom_speed(camera);
+        camera.target_fov = clamp(camera.min_fov, camera.max_fov, camera.target_fov);
     }
 
     void camera_on_scroll_changed(camera_t& camera, double2_t scroll) {
-        camera.fov -= static_cast<float>(scroll.y) * camera_get_zoom_speed(camera);
-        camera.fov = clamp(camera.min_fov, camera.max_fov, camera.fov);
-        camera_update_perspective(camera);
+        camera.target_fov -= static_cast<float>(scroll.y) * camera_get_zoom_speed(camera);
+        camera.target_fov = clamp(camera.min_fov, camera.max_fov, camera.target_fov);
     }
 
     void camera_look(camera_t& camera, double2_t look, SF_CAMERA_MODE camera_mode) {
-        quat_t rotation = { -camera.pitch, -camera.yaw, camera.roll, 0 };
+        quat_t rotation = camera_get_rotation(camera);
         float3_t up = rotate(rotation, { 0.0f, 1.0f, 0.0f }).xyz();
         float look_sign = static_cast<float>(camera_mode);
         float yaw_sign = up.y < 0 ? -1.0f : 1.0f;
-        camera.yaw += static_cast<float>(look.x) * yaw_sign * camera.horizontal_sens * look_sign;
-        camera.pitch += static_cast<float>(look.y) * camera.vertical_sens * look_sign;
-        camera_update_view(camera, camera.position);
+        camera.target_yaw += static_cast<float>(look.x) * yaw_sign * camera.horizontal_sens * look_sign;
+        camera.target_pitch += static_cast<float>(look.y) * camera.vertical_sens * look_sign;
     }
 
     void camera_on_window_frame_resized(camera_t& camera, int2_t frame_size) {
@@ -89,25 +91,418 @@ namespace sf {
 
     void camera_on_window_ratio_changed(camera_t& camera, float ratio) {
         camera.aspect_ratio = ratio;
-        camera_update_perspective(camera);
+        camera.dirty |= SF_CAMERA_DIRTY_PERSPECTIVE;
+    }
+
+    static void camera_update_view_projection(camera_t& camera) {
+        camera.view_projection = camera.view * camera.perspective;
+        camera.inverse_view_projection = inverse(camera.view_projection);
+    }
+
+    static void camera_rebuild_view(camera_t& camera, bool rotate_basis) {
+        if (rotate_basis) {
+            // basis is rebuilt from angles, rotating the current one would turn it again on every update
+            quat_t rotation = camera_get_rotation(camera);
+            camera.front = rotate(rotation, { 0.0f, 0.0f, -1.0f }).xyz();
+            camera.up = rotate(rotation, { 0.0f, 1.0f, 0.0f }).xyz();
+        }
+        camera.view = mat4_view(camera.position, camera.front, camera.up);
+        camera.focal_point = camera.position;
     }
 
     void camera_update_perspective(camera_t& camera) {
         camera.perspective = mat4_perspective(camera.aspect_ratio, degree_t(camera.fov), camera.z_near, camera.z_far);
+        camera.dirty &= ~SF_CAMERA_DIRTY_PERSPECTIVE;
+        camera_update_view_projection(camera);
+        camera.version++;
     }
 
     void camera_update_ortho(camera_t& camera) {
         camera.ortho = mat4_ortho(camera.left, camera.right, camera.bottom, camera.top, camera.z_near, camera.z_far);
+        camera.dirty &= ~SF_CAMERA_DIRTY_ORTHO;
+        camera.version++;
     }
 
     void camera_update_view(camera_t& camera, const float3_t& pos) {
-        // yaw = pitch = 0.0f; // lock the camera's rotation
-        quat_t rotation = quat_t(-camera.pitch, -camera.yaw, camera.roll, 1);
-        camera.front = rotate(rotation, camera.front).xyz();
-        camera.up = rotate(rotation, camera.up).xyz();
-        camera.view = mat4_view(pos, camera.front, camera.up);
-        camera.focal_point = pos;
         camera.position = pos;
+        camera.target_position = pos;
+        camera.motion.position_velocity = { 0, 0, 0 };
+        camera.motion.position_rate = { 0, 0, 0 };
+        camera.motion.last_target_position = pos;
+        camera_rebuild_view(camera, true);
+        camera.dirty &= ~(SF_CAMERA_DIRTY_ORIENTATION | SF_CAMERA_DIRTY_VIEW);
+        camera_update_view_projection(camera);
+        camera.version++;
+    }
+
+    void camera_motion_reset(camera_t& camera) {
+        camera.target_position = camera.position;
+        camera.target_fov = camera.fov;
+        camera.target_yaw = camera.yaw;
+        camera.target_pitch = camera.pitch;
+        camera.motion = {};
+        camera.motion.last_target_position = camera.position;
+        camera.motion.last_target_fov = camera.fov;
+        camera.motion.last_target_yaw = camera.yaw;
+        camera.motion.last_target_pitch = camera.pitch;
+        camera.motion.initialized = true;
+    }
+
+    bool camera_rebase(camera_t& camera, double threshold) {
+        const float3_t offset = camera.position;
+        if (dot(offset, offset) <= threshold * threshold) {
+            return false;
+        }
+
+        // float offset fits into double exactly, so world position of camera and targets stays the same
+        camera.origin = camera.origin + double3_t(offset.x, offset.y, offset.z);
+        camera.position = { 0, 0, 0 };
+        camera.target_position = camera.target_position - offset;
+        camera.focal_point = camera.focal_point - offset;
+        camera.motion.last_target_position = camera.motion.last_target_position - offset;
+        camera.dirty |= SF_CAMERA_DIRTY_VIEW;
+        return true;
+    }
+
+    template<typename T>
+    static void camera_motion_estimate_rate(T& rate, T& last_target, const T& target, float dt) {
+        rate = damp(rate, (target - last_target) / dt, 1.0f / SF_CAMERA_RATE_SMOOTH_TIME, dt);
+        last_target = target;
+    }
+
+    /**
+     * Rate of targets is estimated per frame and smoothed, so irregular event timing doesn't shake prediction.
+     * Springs go toward predicted targets in fixed steps, the rest of frame time is carried to the next frame.
+     */
+    void camera_update_motion(camera_t& camera, float dt) {
+        if (!camera.motion.initialized) {
+            camera_motion_reset(camera);
+        }
+
+        camera_motion_t& m = camera.motion;
+        const float3_t position = camera.position;
+        const float fov = camera.fov;
+        const float yaw = camera.yaw;
+        const float pitch = camera.pitch;
+
+        if (dt > 0) {
+            camera_motion_estimate_rate(m.position_rate, m.last_target_position, camera.target_position, dt);
+            camera_motion_estimate_rate(m.fov_rate, m.last_target_fov, camera.target_fov, dt);
+            camera_motion_estimate_rate(m.yaw_rate, m.last_target_yaw, camera.target_yaw, dt);
+            camera_motion_estimate_rate(m.pitch_rate, m.last_target_pitch, camera.target_pitch, dt);
+        }
+
+        const float3_t target_position = camera.target_position + m.position_rate * camera.prediction_time;
+        const float target_fov = clamp(camera.min_fov, camera.max_fov, camera.target_fov + m.fov_rate * camera.prediction_time);
+        const float target_yaw = camera.target_yaw + m.yaw_rate * camera.prediction_time;
+        const float target_pitch = camera.target_pitch + m.pitch_rate * camera.prediction_time;
+
+        if (camera.smooth_time <= 0) {
+            camera.position = target_position;
+            camera.fov = target_fov;
+            camera.yaw = target_yaw;
+            camera.pitch = target_pitch;
+            m.position_velocity = { 0, 0, 0 };
+            m.fov_velocity = m.yaw_velocity = m.pitch_velocity = 0;
+            m.accumulator = 0;
+        } else {
+            // long stalls are not replayed step by step
+            m.accumulator = std::min(m.accumulator + dt, SF_CAMERA_MOTION_MAX_CATCH_UP);
+            for (; m.accumulator >= SF_CAMERA_MOTION_STEP ; m.accumulator -= SF_CAMERA_MOTION_STEP) {
+                spring_damp(camera.position, m.position_velocity, target_position, camera.smooth_time, SF_CAMERA_MOTION_STEP);
+                spring_damp(camera.fov, m.fov_velocity, target_fov, camera.smooth_time, SF_CAMERA_MOTION_STEP);
+                spring_damp(camera.yaw, m.yaw_velocity, target_yaw, camera.smooth_time, SF_CAMERA_MOTION_STEP);
+                spring_damp(camera.pitch, m.pitch_velocity, target_pitch, camera.smooth_time, SF_CAMERA_MOTION_STEP);
+            }
+        }
+
+        if (camera.position.x != position.x || camera.position.y != position.y || camera.position.z != position.z) {
+            camera.dirty |= SF_CAMERA_DIRTY_VIEW;
+        }
+        if (camera.fov != fov) {
+            camera.dirty |= SF_CAMERA_DIRTY_PERSPECTIVE;
+        }
+        if (camera.yaw != yaw || camera.pitch != pitch) {
+            camera.dirty |= SF_CAMERA_DIRTY_ORIENTATION;
+        }
+    }
+
+    // every change since the last update is applied once, basis is rotated only when orientation has changed
+    bool camera_update(camera_t& camera) {
+        const u32 dirty = camera.dirty;
+        if (dirty == SF_CAMERA_DIRTY_NONE) {
+            return false;
+        }
+
+        if (dirty & (SF_CAMERA_DIRTY_ORIENTATION | SF_CAMERA_DIRTY_VIEW)) {
+            camera_rebuild_view(camera, dirty & SF_CAMERA_DIRTY_ORIENTATION);
+        }
+
+        if (dirty & SF_CAMERA_DIRTY_PERSPECTIVE) {
+            camera.perspective = mat4_perspective(camera.aspect_ratio, degree_t(camera.fov), camera.z_near, camera.z_far);
+        }
+
+        if (dirty & SF_CAMERA_DIRTY_ORTHO) {
+            camera.ortho = mat4_ortho(camera.left, camera.right, camera.bottom, camera.top, camera.z_near, camera.z_far);
+        }
+
+        if (dirty & (SF_CAMERA_DIRTY_ORIENTATION | SF_CAMERA_DIRTY_VIEW | SF_CAMERA_DIRTY_PERSPECTIVE)) {
+            camera_update_view_projection(camera);
+        }
+
+        camera.dirty = SF_CAMERA_DIRTY_NONE;
+        camera.version++;
+        return true;
+    }
+
+    frustum_t camera_get_frustum(const camera_t& camera) {
+        return frustum_init(camera.view_projection);
+    }
+
+    // projection keeps y of NDC pointing down as screen y does, depth of near plane is 0 and of far plane is 1
+    ray_t camera_screen_ray(const camera_t& camera, const float2_t& screen_position) {
+        const float x = 2.0f * screen_position.x / static_cast<float>(camera.frame_size.x) - 1.0f;
+        const float y = 2.0f * screen_position.y / static_cast<float>(camera.frame_size.y) - 1.0f;
+        const float4x4_t points = float4x4_t {
+                { x, y, 0.0f, 1.0f },
+                { x, y, 1.0f, 1.0f },
+                { 0.0f, 0.0f, 0.0f, 0.0f },
+                { 0.0f, 0.0f, 0.0f, 0.0f }
+        } * camera.inverse_view_projection;
+        const float3_t near_point = points[0].xyz() / points[0].w;
+        const float3_t far_point = points[1].xyz() / points[1].w;
+        return { near_point, far_point - near_point };
+    }
+
+    camera_set_t camera_set_init(u32 capacity) {
+        const u32 padded = (capacity + 3) & ~3u;
+        camera_set_t camera_set;
+        camera_set.capacity = capacity;
+        camera_set.positions = { malloc_t<float>(padded), malloc_t<float>(padded), malloc_t<float>(padded) };
+        camera_set.fronts = { malloc_t<float>(padded), malloc_t<float>(padded), malloc_t<float>(padded) };
+        camera_set.ups = { malloc_t<float>(padded), malloc_t<float>(padded), malloc_t<float>(padded) };
+        camera_set.fovs = malloc_t<float>(padded);
+        camera_set.aspect_ratios = malloc_t<float>(padded);
+        camera_set.z_nears = malloc_t<float>(padded);
+        camera_set.z_fars = malloc_t<float>(padded);
+        camera_set.views = malloc_t<float4x4_t>(capacity);
+        camera_set.perspectives = malloc_t<float4x4_t>(capacity);
+        camera_set.view_projections = malloc_t<float4x4_t>(capacity);
+        camera_set.frustums = malloc_t<frustum_t>(capacity);
+
+        camera_t padding;
+        padding.front = { 0, 0, -1 };
+        padding.fov = 60;
+        padding.aspect_ratio = 1;
+        padding.z_near = 0.1f;
+        padding.z_far = 1;
+        for (u32 i = 0 ; i < padded ; i++) {
+            camera_set_store(camera_set, i, padding);
+        }
+
+        return camera_set;
+    }
+
+    void camera_set_free(camera_set_t& camera_set) {
+        float* arrays[] = {
+                camera_set.positions.x, camera_set.positions.y, camera_set.positions.z,
+                camera_set.fronts.x, camera_set.fronts.y, camera_set.fronts.z,
+                camera_set.ups.x, camera_set.ups.y, camera_set.ups.z,
+                camera_set.fovs, camera_set.aspect_ratios, camera_set.z_nears, camera_set.z_fars
+        };
+        for (float* array : arrays) {
+            sf::free(array);
+        }
+        sf::free(camera_set.views);
+        sf::free(camera_set.perspectives);
+        sf::free(camera_set.view_projections);
+        sf::free(camera_set.frustums);
+        camera_set = {};
+    }
+
+    u32 camera_set_add(camera_set_t& camera_set, const camera_t& camera) {
+        SF_ASSERT(camera_set.count < camera_set.capacity, "camera_set_add(): camera set is full!");
+        const u32 index = camera_set.count++;
+        camera_set_store(camera_set, index, camera);
+        return index;
+    }
+
+    void camera_set_store(camera_set_t& camera_set, u32 index, const camera_t& camera) {
+        camera_set.positions.x[index] = camera.position.x;
+        camera_set.positions.y[index] = camera.position.y;
+        camera_set.positions.z[index] = camera.position.z;
+        camera_set.fronts.x[index] = camera.front.x;
+        camera_set.fronts.y[index] = camera.front.y;
+        camera_set.fronts.z[index] = camera.front.z;
+        camera_set.ups.x[index] = camera.up.x;
+        camera_set.ups.y[index] = camera.up.y;
+        camera_set.ups.z[index] = camera.up.z;
+        camera_set.fovs[index] = camera.fov;
+        camera_set.aspect_ratios[index] = camera.aspect_ratio;
+        camera_set.z_nears[index] = camera.z_near;
+        camera_set.z_fars[index] = camera.z_far;
+    }
+
+    static void camera_set_store_rows(float4x4_t* matrices, u32 count, simd4f_t r0[4], simd4f_t r1[4], simd4f_t r2[4], simd4f_t r3[4]) {
+        simd4f_transpose(r0[0], r0[1], r0[2], r0[3]);
+        simd4f_transpose(r1[0], r1[1], r1[2], r1[3]);
+        simd4f_transpose(r2[0], r2[1], r2[2], r2[3]);
+        simd4f_transpose(r3[0], r3[1], r3[2], r3[3]);
+        for (u32 j = 0 ; j < count ; j++) {
+            matrices[j] = {
+                    float4_t::from_simd(r0[j]),
+                    float4_t::from_simd(r1[j]),
+                    float4_t::from_simd(r2[j]),
+                    float4_t::from_simd(r3[j])
+            };
+        }
+    }
+
+    // same basis as mat4_view(), perspective is sparse, so view * perspective is expanded by hand
+    void camera_set_update(camera_set_t& camera_set) {
+        const simd4f_t zero = simd4f_zero();
+        const simd4f_t one = simd4f_splat(1.0f);
+
+        for (u32 i = 0 ; i < camera_set.count ; i += 4) {
+            const u32 count = std::min(4u, camera_set.count - i);
+            const simd4f_t px = simd4f_loadu(camera_set.positions.x + i);
+            const simd4f_t py = simd4f_loadu(camera_set.positions.y + i);
+            const simd4f_t pz = simd4f_loadu(camera_set.positions.z + i);
+            const simd4f_t fx = simd4f_loadu(camera_set.fronts.x + i);
+            const simd4f_t fy = simd4f_loadu(camera_set.fronts.y + i);
+            const simd4f_t fz = simd4f_loadu(camera_set.fronts.z + i);
+            const simd4f_t ux = simd4f_loadu(camera_set.ups.x + i);
+            const simd4f_t uy = simd4f_loadu(camera_set.ups.y + i);
+            const simd4f_t uz = simd4f_loadu(camera_set.ups.z + i);
+
+            // right = normalize(cross(front, up)), camera up = cross(right, front)
+            simd4f_t rx = simd4f_sub(simd4f_mul(fy, uz), simd4f_mul(fz, uy));
+            simd4f_t ry = simd4f_sub(simd4f_mul(fz, ux), simd4f_mul(fx, uz));
+            simd4f_t rz = simd4f_sub(simd4f_mul(fx, uy), simd4f_mul(fy, ux));
+            const simd4f_t r_length = simd4f_sqrt(simd4f_add(simd4f_add(simd4f_mul(rx, rx), simd4f_mul(ry, ry)), simd4f_mul(rz, rz)));
+            rx = simd4f_div(rx, r_length);
+            ry = simd4f_div(ry, r_length);
+            rz = simd4f_div(rz, r_length);
+            const simd4f_t cx = simd4f_sub(simd4f_mul(ry, fz), simd4f_mul(rz, fy));
+            const simd4f_t cy = simd4f_sub(simd4f_mul(rz, fx), simd4f_mul(rx, fz));
+            const simd4f_t cz = simd4f_sub(simd4f_mul(rx, fy), simd4f_mul(ry, fx));
+
+            const simd4f_t tx = simd4f_neg(simd4f_add(simd4f_add(simd4f_mul(px, rx), simd4f_mul(py, ry)), simd4f_mul(pz, rz)));
+            const simd4f_t ty = simd4f_neg(simd4f_add(simd4f_add(simd4f_mul(px, cx), simd4f_mul(py, cy)), simd4f_mul(pz, cz)));
+            const simd4f_t tz = simd4f_add(simd4f_add(simd4f_mul(px, fx), simd4f_mul(py, fy)), simd4f_mul(pz, fz));
+
+            // view rows, component by component, lanes are cameras
+            simd4f_t v0[4] = { rx, cx, simd4f_neg(fx), zero };
+            simd4f_t v1[4] = { ry, cy, simd4f_neg(fy), zero };
+            simd4f_t v2[4] = { rz, cz, simd4f_neg(fz), zero };
+            simd4f_t v3[4] = { tx, ty, tz, one };
+
+            simd4f_t s, c;
+            const simd4f_t half_fov = simd4f_mul(simd4f_loadu(camera_set.fovs + i), simd4f_splat(SF_RADIANS(0.5f)));
+            accuracy_precise_t::sincos(half_fov, s, c);
+            const simd4f_t f = simd4f_div(c, s);
+            const simd4f_t z_near = simd4f_loadu(camera_set.z_nears + i);
+            const simd4f_t z_far = simd4f_loadu(camera_set.z_fars + i);
+            const simd4f_t depth = simd4f_sub(z_near, z_far);
+            const simd4f_t p00 = simd4f_div(f, simd4f_loadu(camera_set.aspect_ratios + i));
+            const simd4f_t p11 = simd4f_neg(f);
+            const simd4f_t p22 = simd4f_div(z_far, depth);
+            const simd4f_t p32 = simd4f_div(simd4f_mul(z_near, z_far), depth);
+
+            simd4f_t p0[4] = { p00, zero, zero, zero };
+            simd4f_t p1[4] = { zero, p11, zero, zero };
+            simd4f_t p2[4] = { zero, zero, p22, simd4f_neg(one) };
+            simd4f_t p3[4] = { zero, zero, p32, zero };
+
+            simd4f_t* v[4] = { v0, v1, v2, v3 };
+            simd4f_t vp[4][4];
+            for (int r = 0 ; r < 4 ; r++) {
+                vp[r][0] = simd4f_mul(v[r][0], p00);
+                vp[r][1] = simd4f_mul(v[r][1], p11);
+                vp[r][2] = simd4f_add(simd4f_mul(v[r][2], p22), simd4f_mul(v[r][3], p32));
+                vp[r][3] = simd4f_neg(v[r][2]);
+            }
+
+            // planes are sums of view * perspective columns, see frustum_init()
+            const simd4f_t planes[SF_FRUSTUM_PLANE_COUNT][4] = {
+                    { simd4f_add(vp[0][3], vp[0][0]), simd4f_add(vp[1][3], vp[1][0]), simd4f_add(vp[2][3], vp[2][0]), simd4f_add(vp[3][3], vp[3][0]) },
+                    { simd4f_sub(vp[0][3], vp[0][0]), simd4f_sub(vp[1][3], vp[1][0]), simd4f_sub(vp[2][3], vp[2][0]), simd4f_sub(vp[3][3], vp[3][0]) },
+                    { simd4f_add(vp[0][3], vp[0][1]), simd4f_add(vp[1][3], vp[1][1]), simd4f_add(vp[2][3], vp[2][1]), simd4f_add(vp[3][3], vp[3][1]) },
+                    { simd4f_sub(vp[0][3], vp[0][1]), simd4f_sub(vp[1][3], vp[1][1]), simd4f_sub(vp[2][3], vp[2][1]), simd4f_sub(vp[3][3], vp[3][1]) },
+                    { vp[0][2], vp[1][2], vp[2][2], vp[3][2] },
+                    { simd4f_sub(vp[0][3], vp[0][2]), simd4f_sub(vp[1][3], vp[1][2]), simd4f_sub(vp[2][3], vp[2][2]), simd4f_sub(vp[3][3], vp[3][2]) },
+            };
+            for (int p = 0 ; p < SF_FRUSTUM_PLANE_COUNT ; p++) {
+                const simd4f_t* plane = planes[p];
+                const simd4f_t inv_length = simd4f_div(one, simd4f_sqrt(simd4f_add(simd4f_add(simd4f_mul(plane[0], plane[0]), simd4f_mul(plane[1], plane[1])), simd4f_mul(plane[2], plane[2]))));
+                alignas(SF_SIMD_ALIGNMENT) float nx[4], ny[4], nz[4], d[4];
+                simd4f_store(nx, simd4f_mul(plane[0], inv_length));
+                simd4f_store(ny, simd4f_mul(plane[1], inv_length));
+                simd4f_store(nz, simd4f_mul(plane[2], inv_length));
+                simd4f_store(d, simd4f_mul(plane[3], inv_length));
+                for (u32 j = 0 ; j < count ; j++) {
+                    camera_set.frustums[i + j].planes[p] = { { nx[j], ny[j], nz[j] }, d[j] };
+                }
+            }
+
+            camera_set_store_rows(camera_set.views + i, count, v0, v1, v2, v3);
+            camera_set_store_rows(camera_set.perspectives + i, count, p0, p1, p2, p3);
+            camera_set_store_rows(camera_set.view_projections + i, count, vp[0], vp[1], vp[2], vp[3]);
+        }
+    }
+
+    void camera_cascade_splits(float z_near, float z_far, u32 cascade_count, float lambda, float* splits) {
+        for (u32 i = 0 ; i <= cascade_count ; i++) {
+            const float k = static_cast<float>(i) / static_cast<float>(cascade_count);
+            const float log_split = z_near * std::pow(z_far / z_near, k);
+            const float uniform_split = z_near + (z_far - z_near) * k;
+            splits[i] = lambda * log_split + (1.0f - lambda) * uniform_split;
+        }
+        splits[0] = z_near;
+        splits[cascade_count] = z_far;
+    }
+
+    void camera_cascade_matrices(
+            const camera_t& camera,
+            const float3_t& light_direction,
+            const float* splits,
+            u32 cascade_count,
+            u32 shadow_map_size,
+            float caster_distance,
+            float4x4_t* view_projections
+    ) {
+        const float3_t front = normalize(camera.front);
+        const float tan_y = std::tan(0.5f * static_cast<float>(radians_t(degree_t(camera.fov))));
+        const float tan_x = tan_y * camera.aspect_ratio;
+        const float3_t light = normalize(light_direction);
+        const float3_t light_up = std::abs(light.y) > 0.99f ? float3_t { 0, 0, 1 } : float3_t { 0, 1, 0 };
+
+        for (u32 i = 0 ; i < cascade_count ; i++) {
+            const float slice_near = splits[i];
+            const float slice_far = splits[i + 1];
+
+            // sphere through the corners of the slice, its center lies on the view axis
+            const float k = tan_x * tan_x + tan_y * tan_y;
+            const float center_depth = std::min(0.5f * (slice_near + slice_far) * (1.0f + k), slice_far);
+            const float near_distance = (center_depth - slice_near) * (center_depth - slice_near) + slice_near * slice_near * k;
+            const float far_distance = (slice_far - center_depth) * (slice_far - center_depth) + slice_far * slice_far * k;
+            float radius = std::sqrt(std::max(near_distance, far_distance));
+            // radius is quantized, so texel size doesn't change between frames
+            radius = std::ceil(radius * 16.0f) / 16.0f;
+            const float3_t center = camera.position + front * center_depth;
+
+            // eye is moved along light direction only, so it doesn't change texel snapping below
+            const float eye_distance = radius + caster_distance;
+            float4x4_t light_view = mat4_view(center - light * eye_distance, light, light_up);
+            const float texel = 2.0f * radius / static_cast<float>(shadow_map_size);
+            // world origin is moved onto texel grid of light space, so static shadows don't shimmer
+            const float origin_x = light_view[3][0];
+            const float origin_y = light_view[3][1];
+            light_view[3][0] += std::round(origin_x / texel) * texel - origin_x;
+            light_view[3][1] += std::round(origin_y / texel) * texel - origin_y;
+
+            view_projections[i] = light_view * mat4_ortho(-radius, radius, -radius, radius, 0.0f, eye_distance + radius);
+        }
     }
 
-}
\ No newline at end of file
+}
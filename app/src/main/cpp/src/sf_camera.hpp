@@ -1,6 +1,6 @@
 #pragma once
 
-#include <sf_math.hpp>
+#include <sf_geometry.hpp>
 
 enum SF_CAMERA_MODE
 {
@@ -8,13 +8,48 @@ enum SF_CAMERA_MODE
     SF_CAMERA_MODE_EDITOR = 1,
 };
 
+// parts of camera_t, which are rebuilt by the next camera_update()
+enum SF_CAMERA_DIRTY
+{
+    SF_CAMERA_DIRTY_NONE = 0,
+    SF_CAMERA_DIRTY_ORIENTATION = 1 << 0,
+    SF_CAMERA_DIRTY_VIEW = 1 << 1,
+    SF_CAMERA_DIRTY_PERSPECTIVE = 1 << 2,
+    SF_CAMERA_DIRTY_ORTHO = 1 << 3,
+};
+
+// fixed step of camera motion integration, so trajectories are the same for any frame rate
+#define SF_CAMERA_MOTION_STEP (1.0f / 240.0f)
+
 namespace sf {
 
+    struct SF_API camera_motion_t final {
+        float3_t position_velocity = { 0, 0, 0 };
+        float fov_velocity = 0;
+        float yaw_velocity = 0;
+        float pitch_velocity = 0;
+        // smoothed rate of change of targets, used for prediction
+        float3_t position_rate = { 0, 0, 0 };
+        float fov_rate = 0;
+        float yaw_rate = 0;
+        float pitch_rate = 0;
+        float3_t last_target_position = { 0, 0, 0 };
+        float last_target_fov = 0;
+        float last_target_yaw = 0;
+        float last_target_pitch = 0;
+        // frame time, which hasn't been integrated yet
+        float accumulator = 0;
+        bool initialized = false;
+    };
+
     struct SF_API camera_t final {
+        // world position of camera space origin, position, targets and matrices are relative to it
+        double3_t origin = { 0, 0, 0 };
         // Position.z = -1 is a default valid value for 2D orthographic view
         // If Position.z >= 0, 2D geometry will not be shown on screen
         float3_t position = { 0, 0, -1 };
-        float3_t front = { 0, 0, 0 };
+        // rebuilt from yaw, pitch and roll, when orientation is dirty
+        float3_t front = { 0, 0, -1 };
         float3_t up = { 0, 1, 0 };
         float pitch = 0;
         float yaw = 0;
@@ -32,6 +67,14 @@ namespace sf {
         float4x4_t perspective;
         float4x4_t ortho;
         float4x4_t view;
+        // view * perspective, points are row vectors
+        float4x4_t view_projection;
+        float4x4_t inverse_view_projection;
+
+        // input only marks what has changed, matrices are rebuilt once per frame by camera_update()
+        u32 dirty = SF_CAMERA_DIRTY_NONE;
+        // incremented whenever matrices are rebuilt, culling can skip work while it stays the same
+        u32 version = 0;
 
         float move_speed = 0.1f;
         float zoom_acceleration = 10.0f;
@@ -44,6 +87,17 @@ namespace sf {
         int2_t frame_size;
 
         float3_t focal_point;
+
+        // input moves targets, camera_update_motion() springs position, fov, yaw and pitch toward them in real time
+        float3_t target_position = { 0, 0, -1 };
+        float target_fov = 0;
+        float target_yaw = 0;
+        float target_pitch = 0;
+        // seconds to catch up with target, 0 applies input immediately
+        float smooth_time = 0.1f;
+        // seconds of input-to-display latency, targets are extrapolated by their rate over this time
+        float prediction_time = 0;
+        camera_motion_t motion;
     };
 
     SF_API camera_t camera_init(int2_t frame_size);
@@ -63,5 +117,68 @@ namespace sf {
     SF_API void camera_update_perspective(camera_t& camera);
     SF_API void camera_update_ortho(camera_t& camera);
     SF_API void camera_update_view(camera_t& camera, const float3_t& pos);
+    // targets are set to current state, has to be called after position, fov, yaw or pitch are changed directly
+    SF_API void camera_motion_reset(camera_t& camera);
+    // integrates motion by frame time in seconds and marks what has moved as dirty, called once per frame before camera_update()
+    SF_API void camera_update_motion(camera_t& camera, float dt);
+    inline double3_t camera_get_world_position(const camera_t& camera) {
+        return camera.origin + double3_t(camera.position.x, camera.position.y, camera.position.z);
+    }
+    /**
+     * Moves origin to camera, once it goes further than threshold from origin, so float state stays small.
+     * Returns true when origin has moved, objects have to be converted again with rebase() or rebase_soa().
+     */
+    SF_API bool camera_rebase(camera_t& camera, double threshold);
+    // rebuilds dirty matrices, returns false when nothing has changed since the last update
+    SF_API bool camera_update(camera_t& camera);
+    // frustum and screen ray are derived from matrices of the last update
+    SF_API frustum_t camera_get_frustum(const camera_t& camera);
+    // ray from near to far plane through the pixel, used for editor picking and touches, e.g. with bvh_raycast()
+    SF_API ray_t camera_screen_ray(const camera_t& camera, const float2_t& screen_position);
+
+    /**
+     * Many perspective cameras in SoA form, updated 4 per iteration: view, perspective, view * perspective and frustum.
+     * Arrays are padded to a multiple of 4 with a valid camera, so the last iteration needs no special path.
+     */
+    struct SF_API camera_set_t final {
+        u32 count = 0;
+        u32 capacity = 0;
+        float3_soa_t positions = {};
+        float3_soa_t fronts = {};
+        float3_soa_t ups = {};
+        float* fovs = nullptr; // degrees
+        float* aspect_ratios = nullptr;
+        float* z_nears = nullptr;
+        float* z_fars = nullptr;
+
+        float4x4_t* views = nullptr;
+        float4x4_t* perspectives = nullptr;
+        float4x4_t* view_projections = nullptr;
+        frustum_t* frustums = nullptr;
+    };
+
+    SF_API camera_set_t camera_set_init(u32 capacity);
+    SF_API void camera_set_free(camera_set_t& camera_set);
+    SF_API u32 camera_set_add(camera_set_t& camera_set, const camera_t& camera);
+    SF_API void camera_set_store(camera_set_t& camera_set, u32 index, const camera_t& camera);
+    SF_API void camera_set_update(camera_set_t& camera_set);
+
+    // split distances blend logarithmic and uniform schemes by lambda, splits hold cascade_count + 1 values from z_near to z_far
+    SF_API void camera_cascade_splits(float z_near, float z_far, u32 cascade_count, float lambda, float* splits);
+    /**
+     * Light view * ortho for every slice between neighbouring splits, slices are bounded by spheres,
+     * so the projection doesn't change size when camera rotates, and are snapped to shadow map texels to avoid shimmering.
+     * Near plane is pulled caster_distance back toward the light from the sphere, so casters outside of the slice still cast into it,
+     * it should reach the scene bounds along light_direction.
+     */
+    SF_API void camera_cascade_matrices(
+            const camera_t& camera,
+            const float3_t& light_direction,
+            const float* splits,
+            u32 cascade_count,
+            u32 shadow_map_size,
+            float caster_distance,
+            float4x4_t* view_projections
+    );
 
 }
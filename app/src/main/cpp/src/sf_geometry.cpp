@@ -0,0 +1,163 @@
+#include <sf_geometry.hpp>
+
+#define SF_FRUSTUM_LANES_MASK ((1u << SF_SIMD_WIDTH) - 1)
+
+namespace sf {
+
+    // plane splatted into lanes, absolute normal is used to project box extents
+    struct frustum_simd_plane_t final {
+        simdf_t nx;
+        simdf_t ny;
+        simdf_t nz;
+        simdf_t d;
+        simdf_t ax;
+        simdf_t ay;
+        simdf_t az;
+    };
+
+    static frustum_simd_plane_t frustum_simd_plane_splat(const plane_t& plane) {
+        return {
+                simdf_splat(plane.normal.x),
+                simdf_splat(plane.normal.y),
+                simdf_splat(plane.normal.z),
+                simdf_splat(plane.distance),
+                simdf_splat(std::abs(plane.normal.x)),
+                simdf_splat(std::abs(plane.normal.y)),
+                simdf_splat(std::abs(plane.normal.z))
+        };
+    }
+
+    // every lane gets its own plane, picked by plane cache of the object
+    static frustum_simd_plane_t frustum_simd_plane_gather(const frustum_t& frustum, const u8* plane_cache) {
+        float nx[SF_SIMD_WIDTH], ny[SF_SIMD_WIDTH], nz[SF_SIMD_WIDTH], d[SF_SIMD_WIDTH];
+        float ax[SF_SIMD_WIDTH], ay[SF_SIMD_WIDTH], az[SF_SIMD_WIDTH];
+
+        for (int j = 0 ; j < SF_SIMD_WIDTH ; j++) {
+            SF_ASSERT(plane_cache[j] < SF_FRUSTUM_PLANE_COUNT, "frustum_cull(): plane cache is corrupted!");
+            const plane_t& plane = frustum.planes[plane_cache[j]];
+            nx[j] = plane.normal.x;
+            ny[j] = plane.normal.y;
+            nz[j] = plane.normal.z;
+            d[j] = plane.distance;
+            ax[j] = std::abs(plane.normal.x);
+            ay[j] = std::abs(plane.normal.y);
+            az[j] = std::abs(plane.normal.z);
+        }
+
+        return {
+                simdf_load(nx), simdf_load(ny), simdf_load(nz), simdf_load(d),
+                simdf_load(ax), simdf_load(ay), simdf_load(az)
+        };
+    }
+
+    struct frustum_bounds_sphere_t final {
+        const sphere_soa_t& spheres;
+
+        float3_soa_t centers() const {
+            return { spheres.x, spheres.y, spheres.z };
+        }
+
+        simdf_t radius(const frustum_simd_plane_t&, usize i) const {
+            return simdf_load(spheres.radius + i);
+        }
+
+        float radius(const plane_t&, usize i) const {
+            return spheres.radius[i];
+        }
+    };
+
+    struct frustum_bounds_aabb_t final {
+        const aabb_soa_t& aabbs;
+
+        float3_soa_t centers() const {
+            return aabbs.center;
+        }
+
+        simdf_t radius(const frustum_simd_plane_t& plane, usize i) const {
+            simdf_t r = simdf_mul(simdf_load(aabbs.extents.x + i), plane.ax);
+            r = simdf_add(r, simdf_mul(simdf_load(aabbs.extents.y + i), plane.ay));
+            return simdf_add(r, simdf_mul(simdf_load(aabbs.extents.z + i), plane.az));
+        }
+
+        float radius(const plane_t& plane, usize i) const {
+            return aabbs.extents.x[i] * std::abs(plane.normal.x)
+                 + aabbs.extents.y[i] * std::abs(plane.normal.y)
+                 + aabbs.extents.z[i] * std::abs(plane.normal.z);
+        }
+    };
+
+    // bit is set for every lane, which lies fully behind the plane
+    template<typename bounds_t>
+    static u32 frustum_simd_outside(const bounds_t& bounds, const float3_soa_t& c, const frustum_simd_plane_t& plane, usize i) {
+        simdf_t distance = simdf_add(simdf_mul(simdf_load(c.x + i), plane.nx), plane.d);
+        distance = simdf_add(distance, simdf_mul(simdf_load(c.y + i), plane.ny));
+        distance = simdf_add(distance, simdf_mul(simdf_load(c.z + i), plane.nz));
+        const simdf_t r = bounds.radius(plane, i);
+        return simdf_movemask(simdf_less(simdf_add(distance, r), simdf_splat(0.0f)));
+    }
+
+    template<typename bounds_t>
+    static bool frustum_outside(const bounds_t& bounds, const float3_soa_t& c, const plane_t& plane, usize i) {
+        const float distance = c.x[i] * plane.normal.x + plane.distance + c.y[i] * plane.normal.y + c.z[i] * plane.normal.z;
+        return distance + bounds.radius(plane, i) < 0.0f;
+    }
+
+    template<typename bounds_t>
+    static u32 frustum_cull(const frustum_t& frustum, const bounds_t& bounds, usize count, u8* plane_cache, u32* visible) {
+        const float3_soa_t c = bounds.centers();
+        frustum_simd_plane_t planes[SF_FRUSTUM_PLANE_COUNT];
+        for (int p = 0 ; p < SF_FRUSTUM_PLANE_COUNT ; p++) {
+            planes[p] = frustum_simd_plane_splat(frustum.planes[p]);
+        }
+
+        u32 visible_count = 0;
+        usize i = 0;
+
+        for (; i + SF_SIMD_WIDTH <= count ; i += SF_SIMD_WIDTH) {
+            u32 outside = frustum_simd_outside(bounds, c, frustum_simd_plane_gather(frustum, plane_cache + i), i);
+
+            for (int p = 0 ; p < SF_FRUSTUM_PLANE_COUNT && outside != SF_FRUSTUM_LANES_MASK ; p++) {
+                const u32 rejected = frustum_simd_outside(bounds, c, planes[p], i) & ~outside;
+                outside |= rejected;
+                for (int j = 0 ; rejected != 0 && j < SF_SIMD_WIDTH ; j++) {
+                    if (rejected & (1u << j)) {
+                        plane_cache[i + j] = u8(p);
+                    }
+                }
+            }
+
+            for (int j = 0 ; j < SF_SIMD_WIDTH ; j++) {
+                if (!(outside & (1u << j))) {
+                    visible[visible_count++] = u32(i + j);
+                }
+            }
+        }
+
+        for (; i < count ; i++) {
+            SF_ASSERT(plane_cache[i] < SF_FRUSTUM_PLANE_COUNT, "frustum_cull(): plane cache is corrupted!");
+            bool outside = frustum_outside(bounds, c, frustum.planes[plane_cache[i]], i);
+
+            for (int p = 0 ; p < SF_FRUSTUM_PLANE_COUNT && !outside ; p++) {
+                if (frustum_outside(bounds, c, frustum.planes[p], i)) {
+                    plane_cache[i] = u8(p);
+                    outside = true;
+                }
+            }
+
+            if (!outside) {
+                visible[visible_count++] = u32(i);
+            }
+        }
+
+        return visible_count;
+    }
+
+    u32 frustum_cull_spheres(const frustum_t& frustum, const sphere_soa_t& spheres, usize count, u8* plane_cache, u32* visible) {
+        return frustum_cull(frustum, frustum_bounds_sphere_t { spheres }, count, plane_cache, visible);
+    }
+
+    u32 frustum_cull_aabbs(const frustum_t& frustum, const aabb_soa_t& aabbs, usize count, u8* plane_cache, u32* visible) {
+        return frustum_cull(frustum, frustum_bounds_aabb_t { aabbs }, count, plane_cache, visible);
+    }
+
+}
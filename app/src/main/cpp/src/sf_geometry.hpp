@@ -0,0 +1,244 @@
+#pragma once
+
+#include <sf_math.hpp>
+
+enum SF_FRUSTUM_PLANE
+{
+    SF_FRUSTUM_PLANE_LEFT = 0,
+    SF_FRUSTUM_PLANE_RIGHT = 1,
+    SF_FRUSTUM_PLANE_BOTTOM = 2,
+    SF_FRUSTUM_PLANE_TOP = 3,
+    SF_FRUSTUM_PLANE_NEAR = 4,
+    SF_FRUSTUM_PLANE_FAR = 5,
+    SF_FRUSTUM_PLANE_COUNT = 6,
+};
+
+namespace sf {
+
+    struct SF_API aabb_t final {
+        float3_t min = { 0, 0, 0 };
+        float3_t max = { 0, 0, 0 };
+    };
+
+    struct SF_API sphere_t final {
+        float3_t center = { 0, 0, 0 };
+        float radius = 0;
+    };
+
+    // points with dot(normal, p) + distance >= 0 are in front of the plane
+    struct SF_API plane_t final {
+        float3_t normal = { 0, 0, 1 };
+        float distance = 0;
+    };
+
+    struct SF_API frustum_t final {
+        plane_t planes[SF_FRUSTUM_PLANE_COUNT];
+    };
+
+    // direction doesn't have to be normalized, hit distances are measured in direction lengths
+    struct SF_API ray_t final {
+        float3_t origin = { 0, 0, 0 };
+        float3_t direction = { 0, 0, -1 };
+    };
+
+    inline float3_t aabb_center(const aabb_t& aabb) {
+        return (aabb.min + aabb.max) * 0.5f;
+    }
+
+    inline float3_t aabb_extents(const aabb_t& aabb) {
+        return (aabb.max - aabb.min) * 0.5f;
+    }
+
+    // inverted box, merging anything into it gives that thing back
+    inline aabb_t aabb_empty() {
+        const float f = std::numeric_limits<float>::max();
+        return { { f, f, f }, { -f, -f, -f } };
+    }
+
+    inline float aabb_surface_area(const aabb_t& aabb) {
+        const float3_t d = aabb.max - aabb.min;
+        return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+
+    inline aabb_t aabb_merge(const aabb_t& a, const aabb_t& b) {
+        return {
+                { std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y), std::min(a.min.z, b.min.z) },
+                { std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y), std::max(a.max.z, b.max.z) }
+        };
+    }
+
+    inline bool aabb_overlaps(const aabb_t& a, const aabb_t& b) {
+        return a.min.x <= b.max.x && a.max.x >= b.min.x
+            && a.min.y <= b.max.y && a.max.y >= b.min.y
+            && a.min.z <= b.max.z && a.max.z >= b.min.z;
+    }
+
+    // center goes through the matrix, extents are projected onto absolute rows, so the result stays tight for rotations
+    inline aabb_t aabb_transform(const aabb_t& aabb, const float4x4_t& m) {
+        const float3_t c = aabb_center(aabb);
+        const float3_t e = aabb_extents(aabb);
+        const float3_t center = {
+                c.x * m[0][0] + c.y * m[1][0] + c.z * m[2][0] + m[3][0],
+                c.x * m[0][1] + c.y * m[1][1] + c.z * m[2][1] + m[3][1],
+                c.x * m[0][2] + c.y * m[1][2] + c.z * m[2][2] + m[3][2]
+        };
+        const float3_t extents = {
+                e.x * std::abs(m[0][0]) + e.y * std::abs(m[1][0]) + e.z * std::abs(m[2][0]),
+                e.x * std::abs(m[0][1]) + e.y * std::abs(m[1][1]) + e.z * std::abs(m[2][1]),
+                e.x * std::abs(m[0][2]) + e.y * std::abs(m[1][2]) + e.z * std::abs(m[2][2])
+        };
+        return { center - extents, center + extents };
+    }
+
+    inline sphere_t sphere_from_aabb(const aabb_t& aabb) {
+        return { aabb_center(aabb), length(aabb_extents(aabb)) };
+    }
+
+    // radius is scaled by the longest basis row, so non-uniform scale keeps the sphere conservative
+    inline sphere_t sphere_transform(const sphere_t& sphere, const float4x4_t& m) {
+        const float3_t& c = sphere.center;
+        const float s = std::max(std::max(dot(m[0].xyz(), m[0].xyz()), dot(m[1].xyz(), m[1].xyz())), dot(m[2].xyz(), m[2].xyz()));
+        return {
+                {
+                    c.x * m[0][0] + c.y * m[1][0] + c.z * m[2][0] + m[3][0],
+                    c.x * m[0][1] + c.y * m[1][1] + c.z * m[2][1] + m[3][1],
+                    c.x * m[0][2] + c.y * m[1][2] + c.z * m[2][2] + m[3][2]
+                },
+                sphere.radius * std::sqrt(s)
+        };
+    }
+
+    inline bool sphere_overlaps_aabb(const sphere_t& sphere, const aabb_t& aabb) {
+        const float3_t& c = sphere.center;
+        const float3_t d = {
+                c.x - std::min(std::max(c.x, aabb.min.x), aabb.max.x),
+                c.y - std::min(std::max(c.y, aabb.min.y), aabb.max.y),
+                c.z - std::min(std::max(c.z, aabb.min.z), aabb.max.z)
+        };
+        return dot(d, d) <= sphere.radius * sphere.radius;
+    }
+
+    inline float3_t ray_inverse_direction(const ray_t& ray) {
+        return { 1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z };
+    }
+
+    // slab test, t is the entry distance and is clamped to 0 when origin is inside the box
+    inline bool ray_intersect_aabb(const float3_t& origin, const float3_t& inv_direction, const aabb_t& aabb, float t_max, float& t) {
+        const float tx0 = (aabb.min.x - origin.x) * inv_direction.x;
+        const float tx1 = (aabb.max.x - origin.x) * inv_direction.x;
+        const float ty0 = (aabb.min.y - origin.y) * inv_direction.y;
+        const float ty1 = (aabb.max.y - origin.y) * inv_direction.y;
+        const float tz0 = (aabb.min.z - origin.z) * inv_direction.z;
+        const float tz1 = (aabb.max.z - origin.z) * inv_direction.z;
+        const float t_enter = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), std::max(std::min(tz0, tz1), 0.0f));
+        const float t_exit = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::min(std::max(tz0, tz1), t_max));
+        t = t_enter;
+        return t_enter <= t_exit;
+    }
+
+    inline bool ray_intersect_sphere(const ray_t& ray, const sphere_t& sphere, float& t) {
+        const float3_t oc = ray.origin - sphere.center;
+        const float a = dot(ray.direction, ray.direction);
+        const float b = dot(oc, ray.direction);
+        const float c = dot(oc, oc) - sphere.radius * sphere.radius;
+        const float discriminant = b * b - a * c;
+        if (discriminant < 0) {
+            return false;
+        }
+        const float root = std::sqrt(discriminant);
+        t = (-b - root) / a;
+        if (t < 0) {
+            t = (-b + root) / a;
+        }
+        return t >= 0;
+    }
+
+    inline plane_t plane_init(const float3_t& normal, const float3_t& point) {
+        return { normal, -dot(normal, point) };
+    }
+
+    inline plane_t plane_normalize(const plane_t& plane) {
+        const float inv_length = 1.0f / length(plane.normal);
+        return { plane.normal * inv_length, plane.distance * inv_length };
+    }
+
+    inline float plane_distance(const plane_t& plane, const float3_t& point) {
+        return dot(plane.normal, point) + plane.distance;
+    }
+
+    /**
+     * Planes are extracted from columns of view * projection, because points are row vectors: clip = p * view * projection.
+     * Depth range is 0..1 as produced by mat4_perspective and mat4_ortho, normals point inside.
+     */
+    inline frustum_t frustum_init(const float4x4_t& view_projection) {
+        const float4x4_t& m = view_projection;
+        const float4_t c0 = { m[0][0], m[1][0], m[2][0], m[3][0] };
+        const float4_t c1 = { m[0][1], m[1][1], m[2][1], m[3][1] };
+        const float4_t c2 = { m[0][2], m[1][2], m[2][2], m[3][2] };
+        const float4_t c3 = { m[0][3], m[1][3], m[2][3], m[3][3] };
+        const float4_t planes[SF_FRUSTUM_PLANE_COUNT] = { c3 + c0, c3 - c0, c3 + c1, c3 - c1, c2, c3 - c2 };
+
+        frustum_t frustum;
+        for (int i = 0 ; i < SF_FRUSTUM_PLANE_COUNT ; i++) {
+            frustum.planes[i] = plane_normalize({ planes[i].xyz(), planes[i].w });
+        }
+        return frustum;
+    }
+
+    inline bool frustum_test_sphere(const frustum_t& frustum, const sphere_t& sphere) {
+        for (const plane_t& plane : frustum.planes) {
+            if (plane_distance(plane, sphere.center) < -sphere.radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline bool frustum_test_aabb(const frustum_t& frustum, const aabb_t& aabb) {
+        const float3_t c = aabb_center(aabb);
+        const float3_t e = aabb_extents(aabb);
+        for (const plane_t& plane : frustum.planes) {
+            const float r = e.x * std::abs(plane.normal.x) + e.y * std::abs(plane.normal.y) + e.z * std::abs(plane.normal.z);
+            if (plane_distance(plane, c) < -r) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // box lies in front of every plane, so all of its contents are visible without further tests
+    inline bool frustum_contains_aabb(const frustum_t& frustum, const aabb_t& aabb) {
+        const float3_t c = aabb_center(aabb);
+        const float3_t e = aabb_extents(aabb);
+        for (const plane_t& plane : frustum.planes) {
+            const float r = e.x * std::abs(plane.normal.x) + e.y * std::abs(plane.normal.y) + e.z * std::abs(plane.normal.z);
+            if (plane_distance(plane, c) < r) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Batched culling over SoA bounds, SF_SIMD_WIDTH objects are tested against all planes per iteration.
+     * plane_cache keeps the last rejecting plane of every object and is tested first,
+     * objects that stay invisible between frames usually leave after one plane.
+     * It must hold count bytes and may start zeroed, indices of visible objects are written to visible.
+     */
+
+    struct SF_API sphere_soa_t final {
+        float* x;
+        float* y;
+        float* z;
+        float* radius;
+    };
+
+    struct SF_API aabb_soa_t final {
+        float3_soa_t center;
+        float3_soa_t extents;
+    };
+
+    SF_API u32 frustum_cull_spheres(const frustum_t& frustum, const sphere_soa_t& spheres, usize count, u8* plane_cache, u32* visible);
+    SF_API u32 frustum_cull_aabbs(const frustum_t& frustum, const aabb_soa_t& aabbs, usize count, u8* plane_cache, u32* visible);
+
+}
@@ -1,8 +1,35 @@
 #include <sf_log.hpp>
+#include <atomic>
+
+// standard error file descriptor, same on POSIX and Windows CRT
+#define SF_LOG_STDERR 2
 
 namespace sf {
 
+    static void log_write_signal_safe(int file_desc, const char* text);
+
     static memory_pool_t s_log_memory_pool = {};
+    static std::atomic<int> s_log_file_desc = { -1 };
+    // g_log_thread_pool accepts tasks only while it's set, submitting counts log_submit() calls, which may still add a task
+    static std::atomic<bool> s_log_running = { false };
+    static std::atomic<u32> s_log_submitting = { 0 };
+
+    // even sequence is 2 * (ticket + 1) of the last completed write, odd one is set while a writer copies its text
+    static u64 log_flight_record_sequence(u64 ticket) {
+        return (ticket + 1) * 2;
+    }
+
+    struct log_flight_record_t final {
+        std::atomic<u64> sequence = { 0 };
+        char text[SF_LOG_RECORD_SIZE] = {};
+    };
+
+    struct log_flight_recorder_t final {
+        std::atomic<u64> head = { 0 };
+        log_flight_record_t records[SF_LOG_FLIGHT_RECORDER_CAPACITY];
+    };
+
+    static log_flight_recorder_t s_log_flight_recorder = {};
 
     void* log_allocator_t::allocate(usize size, usize alignment) {
         return memory_pool_allocate(s_log_memory_pool, size, alignment);
@@ -13,27 +40,51 @@ namespace sf {
     }
 
     void log_file_open(const char* filepath) {
+        // file is open before the log thread starts, so the thread sees g_log_file and crash handler can dump into it right away
+        g_log_file = fopen(filepath, "w+");
+        if (g_log_file == nullptr) {
+            printf("Unable to open Log file %s", filepath);
+            SF_DEBUG_BREAK();
+        } else {
+            s_log_file_desc.store(fileno(g_log_file), std::memory_order_relaxed);
+        }
+
         s_log_memory_pool = memory_pool_init(sf::malloc(1_MB), 1_MB, 100);
         g_log_thread_pool = thread_pool_init<log_allocator_t>(1, 10, "Log", SF_THREAD_PRIORITY_HIGHEST);
-        thread_pool_add_task(g_log_thread_pool, [=] {
-            g_log_file = fopen(filepath, "w+");
-            if (g_log_file == nullptr) {
-                printf("Unable to open Log file %s", filepath);
-                SF_DEBUG_BREAK();
-            }
+        thread_pool_run(g_log_thread_pool);
+        s_log_running.store(true);
+
+        if (g_log_file != nullptr) {
             log_info("Log file %s is open.", filepath);
-        });
+        }
     }
 
     void log_file_close() {
-        thread_pool_add_task(g_log_thread_pool, [=] {
-            log_info("Log file is closing...");
+        log_info("Log file is closing...");
+        s_log_running.store(false);
+        // log_submit() calls, which have seen s_log_running set, have to finish adding their task before the pool is freed
+        while (s_log_submitting.load() != 0) {
+            thread_yield();
+        }
+
+        // log thread runs tasks in order, so all records submitted before are written once this task is done
+        std::atomic<bool> drained = { false };
+        thread_pool_add_task(g_log_thread_pool, [&drained] {
+            drained.store(true, std::memory_order_release);
+        });
+        while (!drained.load(std::memory_order_acquire)) {
+            thread_yield();
+        }
+        thread_pool_free(g_log_thread_pool);
+
+        s_log_file_desc.store(-1, std::memory_order_relaxed);
+        if (g_log_file != nullptr) {
             fflush(g_log_file);
             fclose(g_log_file);
-            thread_pool_free(g_log_thread_pool);
-            memory_pool_free(s_log_memory_pool);
-            sf::free(s_log_memory_pool.memory);
-        });
+            g_log_file = nullptr;
+        }
+        memory_pool_free(s_log_memory_pool);
+        sf::free(s_log_memory_pool.memory);
     }
 
     void log_file_write(const char *log) {
@@ -42,12 +93,111 @@ namespace sf {
         }
     }
 
+    void log_submit(log_console_function_t console_function, SF_LOG_COLOR log_color, const log_record_t& record) {
+        log_flight_recorder_push(record.text);
+        s_log_submitting.fetch_add(1);
+        if (s_log_running.load()) {
+            log_record_t async_record = record;
+            thread_pool_add_task(g_log_thread_pool, [=]() mutable {
+                console_function(log_color, async_record.text);
+                log_file_write(async_record.text);
+            });
+        }
+        s_log_submitting.fetch_sub(1);
+    }
+
+    void log_flight_recorder_push(const char* log) {
+        log_flight_recorder_t& recorder = s_log_flight_recorder;
+        const u64 ticket = recorder.head.fetch_add(1, std::memory_order_relaxed);
+        log_flight_record_t& record = recorder.records[ticket % SF_LOG_FLIGHT_RECORDER_CAPACITY];
+        const u64 sequence = log_flight_record_sequence(ticket);
+
+        // writer, which lapped the ring, can meet another one in the same record, only one of them may copy its text,
+        // record is dropped if it's still being written or if it already holds a newer one
+        u64 current = record.sequence.load(std::memory_order_relaxed);
+        do {
+            if ((current & 1) != 0 || current >= sequence) {
+                return;
+            }
+        } while (!record.sequence.compare_exchange_weak(current, sequence + 1, std::memory_order_relaxed));
+        std::atomic_thread_fence(std::memory_order_release);
+
+        usize i = 0;
+        for (; i < SF_LOG_RECORD_SIZE - 1 && log[i] != 0 ; i++) {
+            record.text[i] = log[i];
+        }
+        record.text[i] = 0;
+
+        record.sequence.store(sequence, std::memory_order_release);
+    }
+
+    // must stay async-signal-safe, it's called from the crash handler
+    void log_flight_recorder_dump(int file_desc) {
+        if (file_desc < 0) {
+            return;
+        }
+
+        log_flight_recorder_t& recorder = s_log_flight_recorder;
+        const u64 head = recorder.head.load(std::memory_order_acquire);
+        const u64 tail = head > SF_LOG_FLIGHT_RECORDER_CAPACITY ? head - SF_LOG_FLIGHT_RECORDER_CAPACITY : 0;
+
+        char text[SF_LOG_RECORD_SIZE];
+        for (u64 ticket = tail ; ticket < head ; ticket++) {
+            const log_flight_record_t& record = recorder.records[ticket % SF_LOG_FLIGHT_RECORDER_CAPACITY];
+            const u64 sequence = log_flight_record_sequence(ticket);
+            // skip records that are overwritten or are still being written, before or during the copy
+            if (record.sequence.load(std::memory_order_acquire) != sequence) {
+                continue;
+            }
+            std::memcpy(text, record.text, SF_LOG_RECORD_SIZE);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (record.sequence.load(std::memory_order_relaxed) != sequence) {
+                continue;
+            }
+            text[SF_LOG_RECORD_SIZE - 1] = 0;
+            log_write_signal_safe(file_desc, text);
+        }
+        log_write_signal_safe(file_desc, "\n");
+    }
+
+    // writes decimal without formatting functions, which aren't async-signal-safe
+    static void log_write_signal_safe(int file_desc, int value) {
+        char text[16];
+        char* p = text + sizeof(text) - 1;
+        *p = 0;
+        u32 u = value < 0 ? 0u - u32(value) : u32(value);
+        do {
+            *--p = char('0' + u % 10);
+            u /= 10;
+        } while (u != 0);
+        if (value < 0) {
+            *--p = '-';
+        }
+        log_write_signal_safe(file_desc, p);
+    }
+
+    static void log_crash_dump(int file_desc, int signal) {
+        log_write_signal_safe(file_desc, "\n[CRASH] Fatal signal ");
+        log_write_signal_safe(file_desc, signal);
+        log_write_signal_safe(file_desc, " received, last log records from flight recorder:");
+        log_flight_recorder_dump(file_desc);
+    }
+
+    static void log_crash_dump(int signal) {
+        log_crash_dump(SF_LOG_STDERR, signal);
+        const int file_desc = s_log_file_desc.load(std::memory_order_relaxed);
+        if (file_desc >= 0) {
+            log_crash_dump(file_desc, signal);
+        }
+    }
+
 }
 
 // SF_WINDOWS_BEGIN
 #if defined(SF_WINDOWS)
 
 #include <windows.h>
+#include <io.h>
 
 namespace sf {
 
@@ -70,6 +220,30 @@ namespace sf {
         0x0F, // SF_LOG_COLOR_LIGHT_WHITE
     };
 
+    static void log_write_signal_safe(int file_desc, const char* text) {
+        _write(file_desc, text, static_cast<unsigned int>(strlen(text)));
+    }
+
+    static void log_crash_handler(int signal) {
+        log_crash_dump(signal);
+        ::signal(signal, SIG_DFL);
+        raise(signal);
+    }
+
+    void log_crash_handler_install() {
+        signal(SIGSEGV, log_crash_handler);
+        signal(SIGABRT, log_crash_handler);
+        signal(SIGILL, log_crash_handler);
+        signal(SIGFPE, log_crash_handler);
+    }
+
+    void log_crash_handler_uninstall() {
+        signal(SIGSEGV, SIG_DFL);
+        signal(SIGABRT, SIG_DFL);
+        signal(SIGILL, SIG_DFL);
+        signal(SIGFPE, SIG_DFL);
+    }
+
     static void print(SF_LOG_COLOR log_color, char* log) {
         HANDLE std_out = GetStdHandle(STD_OUTPUT_HANDLE);
         if (std_out != nullptr && std_out != INVALID_HANDLE_VALUE) {
@@ -108,6 +282,71 @@ namespace sf {
 #endif
 // SF_WINDOWS_END
 
+// SF_POSIX_BEGIN
+#if defined(SF_LINUX) || defined(SF_ANDROID)
+
+#include <cerrno>
+#include <unistd.h>
+
+namespace sf {
+
+    static void log_write_signal_safe(int file_desc, const char* text) {
+        usize size = strlen(text);
+        while (size > 0) {
+            isize written = write(file_desc, text, size);
+            if (written <= 0) {
+                if (written < 0 && errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            text += written;
+            size -= written;
+        }
+    }
+
+    static const int SF_LOG_CRASH_SIGNALS[] = { SIGSEGV, SIGABRT, SIGBUS, SIGILL, SIGFPE };
+
+    /**
+     * Stack overflow can't be reported on the same stack, so the handler runs on its own one.
+     * Alternate stack is per thread and is set only for the thread, which installs the handler,
+     * stack overflow on other threads kills the process without dump, other crashes are still dumped.
+     */
+    static char s_log_crash_stack[64_KB];
+
+    static void log_crash_handler(int signal) {
+        log_crash_dump(signal);
+        // handler is installed with SA_RESETHAND, so raising again will terminate with default behavior
+        raise(signal);
+    }
+
+    void log_crash_handler_install() {
+        stack_t crash_stack = {};
+        crash_stack.ss_sp = s_log_crash_stack;
+        crash_stack.ss_size = sizeof(s_log_crash_stack);
+        crash_stack.ss_flags = 0;
+        sigaltstack(&crash_stack, nullptr);
+
+        struct sigaction action = {};
+        action.sa_handler = log_crash_handler;
+        action.sa_flags = SA_RESETHAND | SA_ONSTACK;
+        sigemptyset(&action.sa_mask);
+        for (int crash_signal : SF_LOG_CRASH_SIGNALS) {
+            sigaction(crash_signal, &action, nullptr);
+        }
+    }
+
+    void log_crash_handler_uninstall() {
+        for (int crash_signal : SF_LOG_CRASH_SIGNALS) {
+            signal(crash_signal, SIG_DFL);
+        }
+    }
+
+}
+
+#endif
+// SF_POSIX_END
+
 // SF_LINUX_BEGIN
 #if defined(SF_LINUX)
 
@@ -53,6 +53,9 @@
 
 #endif
 
+#define SF_LOG_RECORD_SIZE 256
+#define SF_LOG_FLIGHT_RECORDER_CAPACITY 256
+
 enum SF_LOG_COLOR {
     SF_LOG_COLOR_BLACK,
     SF_LOG_COLOR_BLUE,
@@ -95,144 +98,151 @@ namespace sf {
     SF_API void log_console_error(SF_LOG_COLOR log_color, char* log);
     SF_API void log_console_assert(SF_LOG_COLOR log_color, char* log);
 
+    typedef void (*log_console_function_t)(SF_LOG_COLOR log_color, char* log);
+
+    struct SF_API log_record_t final {
+        char text[SF_LOG_RECORD_SIZE];
+    };
+
+    /**
+     * Every record is formatted on the caller thread and copied into the flight recorder,
+     * console and file output is done later by g_log_thread_pool between log_file_open() and log_file_close().
+     */
+    SF_API void log_submit(log_console_function_t console_function, SF_LOG_COLOR log_color, const log_record_t& record);
+
+    /**
+     * Flight recorder is a fixed ring of the last SF_LOG_FLIGHT_RECORDER_CAPACITY records.
+     * It's filled even when file logging is off and it's dumped with async-signal-safe writes on crash,
+     * so records that are still queued in g_log_thread_pool are not lost.
+     * Writer, which meets another one in the same record after lapping the ring, drops its record instead of tearing it.
+     */
+    SF_API void log_flight_recorder_push(const char* log);
+    SF_API void log_flight_recorder_dump(int file_desc);
+
+    // on POSIX stack overflow is dumped only for the installing thread, see log_crash_handler_install() in sf_log.cpp
+    SF_API void log_crash_handler_install();
+    SF_API void log_crash_handler_uninstall();
+
     template<typename... Args>
     static void log_verbose(const char* msg, Args &&... args) {
-        thread_pool_add_task(g_log_thread_pool, [=] {
-            char fmt_buffer[256] = {};
-            char text_buffer[256] = {};
-            date_time_t date_time = date_time_get_current();
+        date_time_t date_time = date_time_get_current();
+        char fmt_buffer[256] = {};
+        log_record_t record = {};
 #if defined(__LP64__)
-            const char *fmt = "\n[%d.%d.%d][%ld:%ld:%ld.%ld][VERBOSE] %s";
+        const char *fmt = "\n[%d.%d.%d][%ld:%ld:%ld.%ld][VERBOSE] %s";
 #else
-            const char* fmt = "\n[%d.%d.%d][%lld:%lld:%lld.%lld][VERBOSE] %s";
+        const char* fmt = "\n[%d.%d.%d][%lld:%lld:%lld.%lld][VERBOSE] %s";
 #endif
-            sprintf(
-                    fmt_buffer,
-                    fmt,
-                    date_time.d, date_time.m, date_time.y, date_time.h, date_time.min, date_time.s, date_time.ms,
-                    msg
-            );
-            sprintf(text_buffer, fmt_buffer, args...);
-            log_console_verbose(SF_LOG_COLOR_LIGHT_GREEN, text_buffer);
-            log_file_write(text_buffer);
-        });
+        sprintf(
+                fmt_buffer,
+                fmt,
+                date_time.d, date_time.m, date_time.y, date_time.h, date_time.min, date_time.s, date_time.ms,
+                msg
+        );
+        snprintf(record.text, sizeof(record.text), fmt_buffer, args...);
+        log_submit(log_console_verbose, SF_LOG_COLOR_LIGHT_GREEN, record);
     }
 
     template<typename... Args>
     static void log_info(const char* msg, Args &&... args) {
-        thread_pool_add_task(g_log_thread_pool, [=] {
-            char fmt_buffer[256] = {};
-            char text_buffer[256] = {};
-            date_time_t date_time = date_time_get_current();
+        date_time_t date_time = date_time_get_current();
+        char fmt_buffer[256] = {};
+        log_record_t record = {};
 #if defined(__LP64__)
-            const char *fmt = "\n[%d.%d.%d][%ld:%ld:%ld.%ld][INFO] %s";
+        const char *fmt = "\n[%d.%d.%d][%ld:%ld:%ld.%ld][INFO] %s";
 #else
-            const char* fmt = "\n[%d.%d.%d][%lld:%lld:%lld.%lld][INFO] %s";
+        const char* fmt = "\n[%d.%d.%d][%lld:%lld:%lld.%lld][INFO] %s";
 #endif
-            sprintf(
-                    fmt_buffer,
-                    fmt,
-                    date_time.d, date_time.m, date_time.y, date_time.h, date_time.min, date_time.s, date_time.ms,
-                    msg
-            );
-            sprintf(text_buffer, fmt_buffer, args...);
-            log_console_info(SF_LOG_COLOR_GREEN, text_buffer);
-            log_file_write(text_buffer);
-        });
+        sprintf(
+                fmt_buffer,
+                fmt,
+                date_time.d, date_time.m, date_time.y, date_time.h, date_time.min, date_time.s, date_time.ms,
+                msg
+        );
+        snprintf(record.text, sizeof(record.text), fmt_buffer, args...);
+        log_submit(log_console_info, SF_LOG_COLOR_GREEN, record);
     }
 
     template<typename... Args>
     static void log_debug(const char* msg, Args &&... args) {
-        thread_pool_add_task(g_log_thread_pool, [=] {
-            char fmt_buffer[256] = {};
-            char text_buffer[256] = {};
-            date_time_t date_time = date_time_get_current();
+        date_time_t date_time = date_time_get_current();
+        char fmt_buffer[256] = {};
+        log_record_t record = {};
 #if defined(__LP64__)
-            const char *fmt = "\n[%d.%d.%d][%ld:%ld:%ld.%ld][DEBUG] %s";
+        const char *fmt = "\n[%d.%d.%d][%ld:%ld:%ld.%ld][DEBUG] %s";
 #else
-            const char* fmt = "\n[%d.%d.%d][%lld:%lld:%lld.%lld][DEBUG] %s";
+        const char* fmt = "\n[%d.%d.%d][%lld:%lld:%lld.%lld][DEBUG] %s";
 #endif
-            sprintf(
-                    fmt_buffer,
-                    fmt,
-                    date_time.d, date_time.m, date_time.y, date_time.h, date_time.min, date_time.s, date_time.ms,
-                    msg
-            );
-            sprintf(text_buffer, fmt_buffer, args...);
-            log_console_debug(SF_LOG_COLOR_WHITE, text_buffer);
-            log_file_write(text_buffer);
-        });
+        sprintf(
+                fmt_buffer,
+                fmt,
+                date_time.d, date_time.m, date_time.y, date_time.h, date_time.min, date_time.s, date_time.ms,
+                msg
+        );
+        snprintf(record.text, sizeof(record.text), fmt_buffer, args...);
+        log_submit(log_console_debug, SF_LOG_COLOR_WHITE, record);
     }
 
     template<typename... Args>
     static void log_warning(const char* msg, Args &&... args) {
-        thread_pool_add_task(g_log_thread_pool, [=] {
-            char fmt_buffer[256] = {};
-            char text_buffer[256] = {};
-            date_time_t date_time = date_time_get_current();
+        date_time_t date_time = date_time_get_current();
+        char fmt_buffer[256] = {};
+        log_record_t record = {};
 #if defined(__LP64__)
-            const char *fmt = "\n[%d.%d.%d][%ld:%ld:%ld.%ld][WARNING] %s";
+        const char *fmt = "\n[%d.%d.%d][%ld:%ld:%ld.%ld][WARNING] %s";
 #else
-            const char* fmt = "\n[%d.%d.%d][%lld:%lld:%lld.%lld][WARNING] %s";
+        const char* fmt = "\n[%d.%d.%d][%lld:%lld:%lld.%lld][WARNING] %s";
 #endif
-            sprintf(
-                    fmt_buffer,
-                    fmt,
-                    date_time.d, date_time.m, date_time.y, date_time.h, date_time.min, date_time.s, date_time.ms,
-                    msg
-            );
-            sprintf(text_buffer, fmt_buffer, args...);
-            log_console_warning(SF_LOG_COLOR_YELLOW, text_buffer);
-            log_file_write(text_buffer);
-        });
+        sprintf(
+                fmt_buffer,
+                fmt,
+                date_time.d, date_time.m, date_time.y, date_time.h, date_time.min, date_time.s, date_time.ms,
+                msg
+        );
+        snprintf(record.text, sizeof(record.text), fmt_buffer, args...);
+        log_submit(log_console_warning, SF_LOG_COLOR_YELLOW, record);
     }
 
     template<typename... Args>
     static void log_error(const char* filename, const char* function, int line, const char* msg, Args &&... args) {
-        thread_pool_add_task(g_log_thread_pool, [=] {
-            char fmt_buffer[256] = {};
-            char text_buffer[256] = {};
-            date_time_t date_time = date_time_get_current();
+        date_time_t date_time = date_time_get_current();
+        char fmt_buffer[256] = {};
+        log_record_t record = {};
 #if defined(__LP64__)
-            const char *fmt = "\n[%d.%d.%d][%ld:%ld:%ld.%ld][ERROR] log_error in %s -> %s(%i line):\n%s";
+        const char *fmt = "\n[%d.%d.%d][%ld:%ld:%ld.%ld][ERROR] log_error in %s -> %s(%i line):\n%s";
 #else
-            const char* fmt = "\n[%d.%d.%d][%lld:%lld:%lld.%lld][ERROR] Error in %s -> %s(%i line):\n%s";
+        const char* fmt = "\n[%d.%d.%d][%lld:%lld:%lld.%lld][ERROR] Error in %s -> %s(%i line):\n%s";
 #endif
-            sprintf(
-                    fmt_buffer,
-                    fmt,
-                    date_time.d, date_time.m, date_time.y, date_time.h, date_time.min, date_time.s, date_time.ms,
-                    filename, function, line,
-                    msg
-            );
-            sprintf(text_buffer, fmt_buffer, args...);
-            log_console_error(SF_LOG_COLOR_RED, text_buffer);
-            log_file_write(text_buffer);
-        });
+        sprintf(
+                fmt_buffer,
+                fmt,
+                date_time.d, date_time.m, date_time.y, date_time.h, date_time.min, date_time.s, date_time.ms,
+                filename, function, line,
+                msg
+        );
+        snprintf(record.text, sizeof(record.text), fmt_buffer, args...);
+        log_submit(log_console_error, SF_LOG_COLOR_RED, record);
     }
 
     template<typename... Args>
     static void log_assert(const char* filename, const char* function, int line, const char* msg, Args &&... args) {
-        thread_pool_add_task(g_log_thread_pool, [=] {
-            char fmt_buffer[256] = {};
-            char text_buffer[256] = {};
-            date_time_t date_time = date_time_get_current();
+        date_time_t date_time = date_time_get_current();
+        char fmt_buffer[256] = {};
+        log_record_t record = {};
 #if defined(__LP64__)
-            const char *fmt = "\n[%d.%d.%d][%ld:%ld:%ld.%ld][ASSERT] Assertion Failed in %s -> %s(%i line):\n%s";
+        const char *fmt = "\n[%d.%d.%d][%ld:%ld:%ld.%ld][ASSERT] Assertion Failed in %s -> %s(%i line):\n%s";
 #else
-            const char* fmt = "\n[%d.%d.%d][%lld:%lld:%lld.%lld][ASSERT] Assertion Failed in %s -> %s(%i line):\n%s";
+        const char* fmt = "\n[%d.%d.%d][%lld:%lld:%lld.%lld][ASSERT] Assertion Failed in %s -> %s(%i line):\n%s";
 #endif
-            sprintf(
-                    fmt_buffer,
-                    fmt,
-                    date_time.d, date_time.m, date_time.y, date_time.h, date_time.min, date_time.s, date_time.ms,
-                    filename, function, line,
-                    msg
-            );
-            sprintf(text_buffer, fmt_buffer, args...);
-            log_console_assert(SF_LOG_COLOR_RED, text_buffer);
-            log_file_write(text_buffer);
-        });
+        sprintf(
+                fmt_buffer,
+                fmt,
+                date_time.d, date_time.m, date_time.y, date_time.h, date_time.min, date_time.s, date_time.ms,
+                filename, function, line,
+                msg
+        );
+        snprintf(record.text, sizeof(record.text), fmt_buffer, args...);
+        log_submit(log_console_assert, SF_LOG_COLOR_RED, record);
     }
 
 }
\ No newline at end of file
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <sf.hpp>
+#include <sf_simd.hpp>
 #include <cmath>
+#include <limits>
 #include <random>
+#include <type_traits>
 
 constexpr float operator ""_PI(unsigned long long x) {
     return x * 3.14159265359f;
@@ -14,14 +17,100 @@ constexpr float operator ""_E(unsigned long long x) {
 
 #define SF_RADIANS(x) ((x) * 1_PI / 180.0f)
 
+// true while a constexpr function is evaluated by compiler, so that it can keep SIMD and C runtime paths at runtime
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define SF_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#endif
+#if !defined(SF_CONSTANT_EVALUATED) && ((defined(__GNUC__) && __GNUC__ >= 9) || (defined(_MSC_VER) && _MSC_VER >= 1925))
+#define SF_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+// constant false would send constexpr math into intrinsics and C runtime, which can't be evaluated by compiler
+#if !defined(SF_CONSTANT_EVALUATED)
+#error "sf_math.hpp requires __builtin_is_constant_evaluated(), use Clang 9, GCC 9 or MSVC 19.25 and newer!"
+#endif
+
 constexpr float operator ""_RAD(unsigned long long x) {
     return SF_RADIANS(x);
 }
 
 namespace sf {
 
+    /**
+     * Compile time versions of sqrt and trigonometric functions, evaluated in double and accurate to float precision.
+     * They are slow loops, so math_* functions select them only in constant expressions and call C runtime otherwise.
+     */
+
+    // Newton iterations from above decrease monotonically until they converge
+    constexpr double constexpr_sqrt(double x) {
+        if (x <= 0 || !(x < std::numeric_limits<double>::infinity())) {
+            return x < 0 ? std::numeric_limits<double>::quiet_NaN() : x;
+        }
+        double r = x > 1 ? x : 1;
+        while (true) {
+            double next = 0.5 * (r + x / r);
+            if (next >= r) {
+                return r;
+            }
+            r = next;
+        }
+    }
+
+    // argument is reduced to [-pi, pi], Taylor series runs until terms don't change the sum
+    constexpr double constexpr_sin(double x) {
+        constexpr double pi = 3.14159265358979323846;
+        double k = x / (2 * pi);
+        x -= 2 * pi * double(static_cast<long long>(k < 0 ? k - 0.5 : k + 0.5));
+        double term = x;
+        double sum = x;
+        for (int i = 1 ; sum + term != sum ; i++) {
+            term *= -x * x / ((2 * i) * (2 * i + 1));
+            sum += term;
+        }
+        return sum;
+    }
+
+    constexpr double constexpr_cos(double x) {
+        constexpr double pi = 3.14159265358979323846;
+        double k = x / (2 * pi);
+        x -= 2 * pi * double(static_cast<long long>(k < 0 ? k - 0.5 : k + 0.5));
+        double term = 1;
+        double sum = 1;
+        for (int i = 1 ; sum + term != sum ; i++) {
+            term *= -x * x / ((2 * i - 1) * (2 * i));
+            sum += term;
+        }
+        return sum;
+    }
+
+    constexpr double constexpr_tan(double x) {
+        return constexpr_sin(x) / constexpr_cos(x);
+    }
+
+    template<typename T>
+    constexpr T math_sqrt(T x) {
+        return SF_CONSTANT_EVALUATED() ? T(constexpr_sqrt(x)) : T(std::sqrt(x));
+    }
+
+    template<typename T>
+    constexpr T math_sin(T x) {
+        return SF_CONSTANT_EVALUATED() ? T(constexpr_sin(x)) : T(std::sin(x));
+    }
+
+    template<typename T>
+    constexpr T math_cos(T x) {
+        return SF_CONSTANT_EVALUATED() ? T(constexpr_cos(x)) : T(std::cos(x));
+    }
+
+    template<typename T>
+    constexpr T math_tan(T x) {
+        return SF_CONSTANT_EVALUATED() ? T(constexpr_tan(x)) : T(std::tan(x));
+    }
+
+    // x limited to [a, b]
     inline float clamp(float a, float b, float x) {
-        return std::min(std::max(x, b), a);
+        return std::min(std::max(x, a), b);
     }
 
     inline float lerp(float a, float b, float x) {
@@ -38,86 +127,259 @@ namespace sf {
         return y;
     }
 
+    // exponential smoothing, which gives the same curve for any frame rate, lambda is approach rate per second
+    template<typename T>
+    inline T damp(const T& a, const T& b, float lambda, float dt) {
+        return a + (b - a) * (1.0f - std::exp(-lambda * dt));
+    }
+
+    /**
+     * Critically damped spring moves value toward target in about smooth_time without overshooting.
+     * Exponent is approximated by polynomial, which stays stable for any dt.
+     */
+    template<typename T>
+    inline void spring_damp(T& value, T& velocity, const T& target, float smooth_time, float dt) {
+        const float omega = 2.0f / std::max(smooth_time, 1e-4f);
+        const float x = omega * dt;
+        const float e = 1.0f / (1.0f + x + 0.48f * x * x + 0.235f * x * x * x);
+        const T change = value - target;
+        const T temp = (velocity + change * omega) * dt;
+        velocity = (velocity - temp * omega) * e;
+        value = target + (change + temp) * e;
+    }
+
     struct degree_t final {
         float a;
 
-        explicit degree_t(float a = 0) : a(a) {}
+        constexpr explicit degree_t(float a = 0) : a(a) {}
 
-        operator float() const { return a; }
+        constexpr operator float() const { return a; }
     };
 
     struct radians_t final {
         float a;
 
-        explicit radians_t(float a = 0) : a(a) {}
-        explicit radians_t(const degree_t& d) : a(SF_RADIANS(d)) {}
+        constexpr explicit radians_t(float a = 0) : a(a) {}
+        constexpr explicit radians_t(const degree_t& d) : a(SF_RADIANS(d)) {}
+
+        constexpr operator float() const { return a; }
+    };
+
+    /**
+     * Accuracy policies are passed as template parameter to select implementation of transcendental functions per call site:
+     * sincos<accuracy_fast_t>(x, s, c), acos<accuracy_fast_t>(x), rsqrt<accuracy_fast_t>(x).
+     * Each policy has scalar and simd4f_t versions of the same function with the same results per lane.
+     *
+     * accuracy_precise_t is backed by the C runtime, results are within 1 ulp.
+     *
+     * accuracy_fast_t is backed by polynomials and hardware estimates, max errors measured over the whole input range:
+     * sincos - absolute error 8e-8 for |x| <= 8192, range reduction loses precision beyond that
+     * acos   - absolute error 4.5e-7 rad for x in [-1, 1]
+     * rsqrt  - relative error 2.5e-7 with SSE (1 Newton step), 1.5e-7 with NEON (2 Newton steps, bound for 2^-8 estimate error),
+     *          1.6e-7 with scalar fallback (3 Newton steps), results differ between backends within these bounds
+     */
+
+    struct accuracy_precise_t final {
+
+        static inline void sincos(simd4f_t x, simd4f_t& s, simd4f_t& c) {
+            alignas(SF_SIMD_ALIGNMENT) float v[4];
+            alignas(SF_SIMD_ALIGNMENT) float vs[4];
+            alignas(SF_SIMD_ALIGNMENT) float vc[4];
+            simd4f_store(v, x);
+            for (int i = 0 ; i < 4 ; i++) {
+                vs[i] = std::sin(v[i]);
+                vc[i] = std::cos(v[i]);
+            }
+            s = simd4f_load(vs);
+            c = simd4f_load(vc);
+        }
+
+        static inline simd4f_t acos(simd4f_t x) {
+            alignas(SF_SIMD_ALIGNMENT) float v[4];
+            simd4f_store(v, x);
+            for (float& a : v) {
+                a = acos(a);
+            }
+            return simd4f_load(v);
+        }
+
+        static inline simd4f_t rsqrt(simd4f_t x) {
+            return simd4f_div(simd4f_splat(1.0f), simd4f_sqrt(x));
+        }
+
+        static inline void sincos(float x, float& s, float& c) {
+            s = std::sin(x);
+            c = std::cos(x);
+        }
+
+        // input is clamped to [-1, 1], so that rounding errors of dot products don't produce NaN
+        static inline float acos(float x) {
+            return std::acos(std::min(std::max(x, -1.0f), 1.0f));
+        }
+
+        static inline float rsqrt(float x) {
+            return 1.0f / std::sqrt(x);
+        }
+    };
+
+    struct accuracy_fast_t final {
+
+        // x = q * pi/2 + r, where pi/2 is split into 3 parts (Cody-Waite), so that q * part is exact for |q| < 2^16
+        // sin(r) and cos(r) are minimax polynomials on [-pi/4, pi/4], quadrant q mod 4 swaps and negates them
+        static inline void sincos(simd4f_t x, simd4f_t& s, simd4f_t& c) {
+            const simd4f_t q = simd4f_floor(simd4f_add(simd4f_mul(x, simd4f_splat(0.636619772f)), simd4f_splat(0.5f)));
+
+            simd4f_t r = simd4f_sub(x, simd4f_mul(q, simd4f_splat(1.5703125f)));
+            r = simd4f_sub(r, simd4f_mul(q, simd4f_splat(4.83751296997070312e-4f)));
+            r = simd4f_sub(r, simd4f_mul(q, simd4f_splat(7.54978995489188216e-8f)));
+            const simd4f_t z = simd4f_mul(r, r);
+
+            simd4f_t ps = simd4f_add(simd4f_mul(simd4f_splat(-1.9515295891e-4f), z), simd4f_splat(8.3321608736e-3f));
+            ps = simd4f_add(simd4f_mul(ps, z), simd4f_splat(-1.6666654611e-1f));
+            ps = simd4f_add(simd4f_mul(simd4f_mul(ps, z), r), r);
+
+            simd4f_t pc = simd4f_add(simd4f_mul(simd4f_splat(2.443315711809948e-5f), z), simd4f_splat(-1.388731625493765e-3f));
+            pc = simd4f_add(simd4f_mul(pc, z), simd4f_splat(4.166664568298827e-2f));
+            pc = simd4f_add(simd4f_sub(simd4f_mul(simd4f_mul(pc, z), z), simd4f_mul(simd4f_splat(0.5f), z)), simd4f_splat(1.0f));
+
+            // all the quadrant arithmetic is exact on small integers
+            const simd4f_t one = simd4f_splat(1.0f);
+            const simd4f_t two = simd4f_splat(2.0f);
+            const simd4f_t half = simd4f_splat(0.5f);
+            const simd4f_t quadrant = simd4f_sub(q, simd4f_mul(simd4f_splat(4.0f), simd4f_floor(simd4f_mul(q, simd4f_splat(0.25f)))));
+            const simd4f_t odd = simd4f_sub(quadrant, simd4f_mul(two, simd4f_floor(simd4f_mul(quadrant, half))));
+            const simd4f_t swap = simd4f_less(half, odd);
+            // sin is negative in quadrants 2, 3 and cos is negative in quadrants 1, 2
+            const simd4f_t sin_sign = simd4f_sub(one, simd4f_mul(two, simd4f_floor(simd4f_mul(quadrant, half))));
+            const simd4f_t u = simd4f_floor(simd4f_mul(simd4f_add(quadrant, one), half));
+            const simd4f_t cos_sign = simd4f_sub(one, simd4f_mul(two, simd4f_sub(u, simd4f_mul(two, simd4f_floor(simd4f_mul(u, half))))));
+
+            s = simd4f_mul(simd4f_select(swap, pc, ps), sin_sign);
+            c = simd4f_mul(simd4f_select(swap, ps, pc), cos_sign);
+        }
+
+        // Abramowitz and Stegun 4.4.46: acos(x) = sqrt(1 - x) * p(x) for x in [0, 1] and acos(-x) = pi - acos(x)
+        static inline simd4f_t acos(simd4f_t x) {
+            x = simd4f_min(simd4f_max(x, simd4f_splat(-1.0f)), simd4f_splat(1.0f));
+            const simd4f_t a = simd4f_abs(x);
+
+            simd4f_t p = simd4f_add(simd4f_mul(simd4f_splat(-0.0012624911f), a), simd4f_splat(0.0066700901f));
+            p = simd4f_add(simd4f_mul(p, a), simd4f_splat(-0.0170881256f));
+            p = simd4f_add(simd4f_mul(p, a), simd4f_splat(0.0308918810f));
+            p = simd4f_add(simd4f_mul(p, a), simd4f_splat(-0.0501743046f));
+            p = simd4f_add(simd4f_mul(p, a), simd4f_splat(0.0889789874f));
+            p = simd4f_add(simd4f_mul(p, a), simd4f_splat(-0.2145988016f));
+            p = simd4f_add(simd4f_mul(p, a), simd4f_splat(1.5707963050f));
+
+            const simd4f_t r = simd4f_mul(simd4f_sqrt(simd4f_sub(simd4f_splat(1.0f), a)), p);
+            return simd4f_select(simd4f_less(x, simd4f_zero()), simd4f_sub(simd4f_splat(1_PI), r), r);
+        }
+
+        // hardware estimate refined by Newton steps: y = y * (1.5 - 0.5 * x * y * y)
+        static inline simd4f_t rsqrt(simd4f_t x) {
+            const simd4f_t half_x = simd4f_mul(simd4f_splat(0.5f), x);
+            simd4f_t y = simd4f_rsqrt_estimate(x);
+            for (int i = 0 ; i < SF_SIMD_RSQRT_STEPS ; i++) {
+                y = simd4f_mul(y, simd4f_sub(simd4f_splat(1.5f), simd4f_mul(half_x, simd4f_mul(y, y))));
+            }
+            return y;
+        }
+
+        static inline void sincos(float x, float& s, float& c) {
+            simd4f_t vs, vc;
+            sincos(simd4f_splat(x), vs, vc);
+            s = simd4f_lane<0>(vs);
+            c = simd4f_lane<0>(vc);
+        }
+
+        static inline float acos(float x) {
+            return simd4f_lane<0>(acos(simd4f_splat(x)));
+        }
 
-        operator float() const { return a; }
+        static inline float rsqrt(float x) {
+            return simd4f_lane<0>(rsqrt(simd4f_splat(x)));
+        }
     };
 
+    template<typename accuracy_t = accuracy_precise_t>
+    inline void sincos(float x, float& s, float& c) {
+        accuracy_t::sincos(x, s, c);
+    }
+
+    template<typename accuracy_t = accuracy_precise_t>
+    inline float acos(float x) {
+        return accuracy_t::acos(x);
+    }
+
+    template<typename accuracy_t = accuracy_precise_t>
+    inline float rsqrt(float x) {
+        return accuracy_t::rsqrt(x);
+    }
+
     template<typename T>
     struct vec2_t {
         T x, y;
 
         vec2_t() = default;
 
-        vec2_t(T x, T y) : x(x), y(y) {}
+        constexpr vec2_t(T x, T y) : x(x), y(y) {}
 
         vec2_t(const vec2_t<T>& v) = default;
 
-        inline T& operator [](int i) {
-            return *(&x + i);
+        // branches instead of pointer arithmetic over members, so that it's usable in constant expressions
+        constexpr T& operator [](int i) {
+            return i == 0 ? x : y;
         }
 
-        inline const T& operator [](int i) const {
-            return *(&x + i);
+        constexpr const T& operator [](int i) const {
+            return i == 0 ? x : y;
         }
 
-        inline friend vec2_t operator +(const vec2_t& v1, const vec2_t& v2) {
+        constexpr friend vec2_t operator +(const vec2_t& v1, const vec2_t& v2) {
             return { v1.x + v2.x, v1.y + v2.y };
         }
 
-        inline friend vec2_t operator -(const vec2_t& v1, const vec2_t& v2) {
+        constexpr friend vec2_t operator -(const vec2_t& v1, const vec2_t& v2) {
             return { v1.x - v2.x, v1.y - v2.y };
         }
 
-        inline friend vec2_t operator *(const vec2_t& v1, const vec2_t& v2) {
+        constexpr friend vec2_t operator *(const vec2_t& v1, const vec2_t& v2) {
             return { v1.x * v2.x, v1.y * v2.y };
         }
 
-        inline friend vec2_t operator /(const vec2_t& v1, const vec2_t& v2) {
+        constexpr friend vec2_t operator /(const vec2_t& v1, const vec2_t& v2) {
             return { v1.x / v2.x, v1.y / v2.y };
         }
 
-        inline friend vec2_t operator +(const vec2_t& v1, const T& s) {
+        constexpr friend vec2_t operator +(const vec2_t& v1, const T& s) {
             return { v1.x + s, v1.y + s };
         }
 
-        inline friend vec2_t operator -(const vec2_t& v1, const T& s) {
+        constexpr friend vec2_t operator -(const vec2_t& v1, const T& s) {
             return { v1.x - s, v1.y - s };
         }
 
-        inline friend vec2_t operator *(const vec2_t& v1, const T& s) {
+        constexpr friend vec2_t operator *(const vec2_t& v1, const T& s) {
             return { v1.x * s, v1.y * s };
         }
 
-        inline friend vec2_t operator /(const vec2_t& v1, const T& s) {
+        constexpr friend vec2_t operator /(const vec2_t& v1, const T& s) {
             return { v1.x / s, v1.y / s };
         }
 
-        inline friend vec2_t operator +(const T& s, const vec2_t& v2) {
+        constexpr friend vec2_t operator +(const T& s, const vec2_t& v2) {
             return { s + v2.x, s + v2.y };
         }
 
-        inline friend vec2_t operator -(const T& s, const vec2_t& v2) {
+        constexpr friend vec2_t operator -(const T& s, const vec2_t& v2) {
             return { s - v2.x, s - v2.y };
         }
 
-        inline friend vec2_t operator *(const T& s, const vec2_t& v2) {
+        constexpr friend vec2_t operator *(const T& s, const vec2_t& v2) {
             return { s * v2.x, s * v2.y };
         }
 
-        inline friend vec2_t operator /(const T& s, const vec2_t& v2) {
+        constexpr friend vec2_t operator /(const T& s, const vec2_t& v2) {
             return { s / v2.x, s / v2.y };
         }
 
@@ -125,29 +387,29 @@ namespace sf {
             return { Pow(v.x, p), Pow(v.y, p) };
         }
 
-        inline friend vec2_t operator -(const vec2_t& v) {
+        constexpr friend vec2_t operator -(const vec2_t& v) {
             return { -v.x, -v.y };
         }
     };
 
     template<typename T>
-    inline T length(const vec2_t<T>& v) {
-        return std::sqrt(v.x * v.x + v.y * v.y);
+    constexpr T length(const vec2_t<T>& v) {
+        return math_sqrt(v.x * v.x + v.y * v.y);
     }
 
     template<typename T>
-    inline vec2_t<T> normalize(const vec2_t<T>& v) {
+    constexpr vec2_t<T> normalize(const vec2_t<T>& v) {
         T l = length(v);
         return { v.x / l, v.y / l };
     }
 
     template<typename T>
-    inline T dot(const vec2_t<T>& v1, const vec2_t<T>& v2) {
+    constexpr T dot(const vec2_t<T>& v1, const vec2_t<T>& v2) {
         return v1.x * v2.x + v1.y * v2.y;
     }
 
     template<typename T>
-    inline T cross(const vec2_t<T>& v1, const vec2_t<T>& v2) {
+    constexpr T cross(const vec2_t<T>& v1, const vec2_t<T>& v2) {
         return v1.x * v2.y - v1.y * v2.x;
     }
 
@@ -157,65 +419,65 @@ namespace sf {
 
         vec3_t() = default;
 
-        vec3_t(T x, T y, T z) : x(x), y(y), z(z) {}
+        constexpr vec3_t(T x, T y, T z) : x(x), y(y), z(z) {}
 
-        vec3_t(const vec2_t<T>& v) : x(v.x), y(v.y) {}
+        constexpr vec3_t(const vec2_t<T>& v) : x(v.x), y(v.y), z(0) {}
 
         vec3_t(const vec3_t<T>& v) = default;
 
-        inline T& operator [](int i) {
-            return *(&x + i);
+        constexpr T& operator [](int i) {
+            return i == 0 ? x : i == 1 ? y : z;
         }
 
-        inline const T& operator [](int i) const {
-            return *(&x + i);
+        constexpr const T& operator [](int i) const {
+            return i == 0 ? x : i == 1 ? y : z;
         }
 
-        inline friend vec3_t operator +(const vec3_t& v1, const vec3_t& v2) {
+        constexpr friend vec3_t operator +(const vec3_t& v1, const vec3_t& v2) {
             return { v1.x + v2.x, v1.y + v2.y, v1.z + v2.z };
         }
 
-        inline friend vec3_t operator -(const vec3_t& v1, const vec3_t& v2) {
+        constexpr friend vec3_t operator -(const vec3_t& v1, const vec3_t& v2) {
             return { v1.x - v2.x, v1.y - v2.y, v1.z - v2.z };
         }
 
-        inline friend vec3_t operator *(const vec3_t& v1, const vec3_t& v2) {
+        constexpr friend vec3_t operator *(const vec3_t& v1, const vec3_t& v2) {
             return { v1.x * v2.x, v1.y * v2.y, v1.z * v2.z };
         }
 
-        inline friend vec3_t operator /(const vec3_t& v1, const vec3_t& v2) {
+        constexpr friend vec3_t operator /(const vec3_t& v1, const vec3_t& v2) {
             return { v1.x / v2.x, v1.y / v2.y, v1.z / v2.z };
         }
 
-        inline friend vec3_t operator +(const vec3_t& v1, const T& s) {
+        constexpr friend vec3_t operator +(const vec3_t& v1, const T& s) {
             return { v1.x + s, v1.y + s, v1.z + s };
         }
 
-        inline friend vec3_t operator -(const vec3_t& v1, const T& s) {
+        constexpr friend vec3_t operator -(const vec3_t& v1, const T& s) {
             return { v1.x - s, v1.y - s, v1.z - s };
         }
 
-        inline friend vec3_t operator *(const vec3_t& v1, const T& s) {
+        constexpr friend vec3_t operator *(const vec3_t& v1, const T& s) {
             return { v1.x * s, v1.y * s, v1.z * s };
         }
 
-        inline friend vec3_t operator /(const vec3_t& v1, const T& s) {
+        constexpr friend vec3_t operator /(const vec3_t& v1, const T& s) {
             return { v1.x / s, v1.y / s, v1.z / s };
         }
 
-        inline friend vec3_t operator +(const T& s, const vec3_t& v2) {
+        constexpr friend vec3_t operator +(const T& s, const vec3_t& v2) {
             return { s + v2.x, s + v2.y, s + v2.z };
         }
 
-        inline friend vec3_t operator -(const T& s, const vec3_t& v2) {
+        constexpr friend vec3_t operator -(const T& s, const vec3_t& v2) {
             return { s - v2.x, s - v2.y, s - v2.z };
         }
 
-        inline friend vec3_t operator *(const T& s, const vec3_t& v2) {
+        constexpr friend vec3_t operator *(const T& s, const vec3_t& v2) {
             return { s * v2.x, s * v2.y, s * v2.z };
         }
 
-        inline friend vec3_t operator /(const T& s, const vec3_t& v2) {
+        constexpr friend vec3_t operator /(const T& s, const vec3_t& v2) {
             return { s / v2.x, s / v2.y, s / v2.z };
         }
 
@@ -223,33 +485,33 @@ namespace sf {
             return { Pow(v.x, p), Pow(v.y, p), Pow(v.z, p) };
         }
 
-        inline friend vec3_t operator -(const vec3_t& v) {
+        constexpr friend vec3_t operator -(const vec3_t& v) {
             return { -v.x, -v.y, -v.z };
         }
 
-        inline vec2_t<T> xy() const {
+        constexpr vec2_t<T> xy() const {
             return { x, y };
         }
     };
 
     template<typename T>
-    inline T length(const vec3_t<T>& v) {
-        return std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+    constexpr T length(const vec3_t<T>& v) {
+        return math_sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
     }
 
     template<typename T>
-    inline vec3_t<T> normalize(const vec3_t<T>& v) {
+    constexpr vec3_t<T> normalize(const vec3_t<T>& v) {
         T l = length(v);
         return { v.x / l, v.y / l, v.z / l };
     }
 
     template<typename T>
-    inline T dot(const vec3_t<T>& v1, const vec3_t<T>& v2) {
+    constexpr T dot(const vec3_t<T>& v1, const vec3_t<T>& v2) {
         return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
     }
 
     template<typename T>
-    inline vec3_t<T> cross(const vec3_t<T>& v1, const vec3_t<T>& v2) {
+    constexpr vec3_t<T> cross(const vec3_t<T>& v1, const vec3_t<T>& v2) {
         return {
                 v1.y * v2.z - v1.z * v2.y,
                 v1.z * v2.x - v1.x * v2.z,
@@ -263,67 +525,67 @@ namespace sf {
 
         vec4_t() = default;
 
-        vec4_t(T x, T y, T z, T w) : x(x), y(y), z(z), w(w) {}
+        constexpr vec4_t(T x, T y, T z, T w) : x(x), y(y), z(z), w(w) {}
 
-        vec4_t(const vec2_t<T>& v) : x(v.x), y(v.y) {}
+        constexpr vec4_t(const vec2_t<T>& v) : x(v.x), y(v.y), z(0), w(0) {}
 
-        vec4_t(const vec3_t<T>& v) : x(v.x), y(v.y), z(v.z) {}
+        constexpr vec4_t(const vec3_t<T>& v) : x(v.x), y(v.y), z(v.z), w(0) {}
 
         vec4_t(const vec4_t<T>& v) = default;
 
-        inline T& operator [](int i) {
-            return *(&x + i);
+        constexpr T& operator [](int i) {
+            return i == 0 ? x : i == 1 ? y : i == 2 ? z : w;
         }
 
-        inline const T& operator [](int i) const {
-            return *(&x + i);
+        constexpr const T& operator [](int i) const {
+            return i == 0 ? x : i == 1 ? y : i == 2 ? z : w;
         }
 
-        inline friend vec4_t operator +(const vec4_t& v1, const vec4_t& v2) {
+        constexpr friend vec4_t operator +(const vec4_t& v1, const vec4_t& v2) {
             return { v1.x + v2.x, v1.y + v2.y, v1.z + v2.z, v1.w + v2.w };
         }
 
-        inline friend vec4_t operator -(const vec4_t v1, const vec4_t& v2) {
+        constexpr friend vec4_t operator -(const vec4_t v1, const vec4_t& v2) {
             return { v1.x - v2.x, v1.y - v2.y, v1.z - v2.z, v1.w - v2.w };
         }
 
-        inline friend vec4_t operator *(const vec4_t& v1, const vec4_t& v2) {
+        constexpr friend vec4_t operator *(const vec4_t& v1, const vec4_t& v2) {
             return { v1.x * v2.x, v1.y * v2.y, v1.z * v2.z, v1.w * v2.w };
         }
 
-        inline friend vec4_t operator /(const vec4_t& v1, const vec4_t& v2) {
+        constexpr friend vec4_t operator /(const vec4_t& v1, const vec4_t& v2) {
             return { v1.x / v2.x, v1.y / v2.y, v1.z / v2.z, v1.w / v2.w };
         }
 
-        inline friend vec4_t operator +(const vec4_t& v1, const T& s) {
+        constexpr friend vec4_t operator +(const vec4_t& v1, const T& s) {
             return { v1.x + s, v1.y + s, v1.z + s, v1.w + s };
         }
 
-        inline friend vec4_t operator -(const vec4_t& v1, const T& s) {
+        constexpr friend vec4_t operator -(const vec4_t& v1, const T& s) {
             return { v1.x - s, v1.y - s, v1.z - s, v1.w - s };
         }
 
-        inline friend vec4_t operator *(const vec4_t& v1, const T& s) {
+        constexpr friend vec4_t operator *(const vec4_t& v1, const T& s) {
             return { v1.x * s, v1.y * s, v1.z * s, v1.w * s };
         }
 
-        inline friend vec4_t operator /(const vec4_t& v1, const T& s) {
+        constexpr friend vec4_t operator /(const vec4_t& v1, const T& s) {
             return { v1.x / s, v1.y / s, v1.z / s, v1.w / s };
         }
 
-        inline friend vec4_t operator +(const T& s, const vec4_t& v2) {
+        constexpr friend vec4_t operator +(const T& s, const vec4_t& v2) {
             return { s + v2.x, s + v2.y, s + v2.z, s + v2.w };
         }
 
-        inline friend vec4_t operator -(const T& s, const vec4_t& v2) {
+        constexpr friend vec4_t operator -(const T& s, const vec4_t& v2) {
             return { s - v2.x, s - v2.y, s - v2.z, s - v2.w };
         }
 
-        inline friend vec4_t operator *(const T& s, const vec4_t& v2) {
+        constexpr friend vec4_t operator *(const T& s, const vec4_t& v2) {
             return { s * v2.x, s * v2.y, s * v2.z, s * v2.w };
         }
 
-        inline friend vec4_t operator /(const T& s, const vec4_t& v2) {
+        constexpr friend vec4_t operator /(const T& s, const vec4_t& v2) {
             return { s / v2.x, s / v2.y, s / v2.z, s / v2.w };
         }
 
@@ -331,43 +593,198 @@ namespace sf {
             return { Pow(v.x, p), Pow(v.y, p), Pow(v.z, p), Pow(v.w, p) };
         }
 
-        inline friend vec4_t operator -(const vec4_t& v) {
+        constexpr friend vec4_t operator -(const vec4_t& v) {
             return { -v.x, -v.y, -v.z, -v.w };
         }
 
-        inline vec2_t<T> xy() const {
+        constexpr vec2_t<T> xy() const {
             return { x, y };
         }
 
-        inline vec3_t<T> xyz() const {
+        constexpr vec3_t<T> xyz() const {
             return { x, y, z };
         }
     };
 
     template<typename T>
-    inline T length(const vec4_t<T>& v) {
-        return std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z + v.w * v.w);
+    constexpr T length(const vec4_t<T>& v) {
+        return math_sqrt(v.x * v.x + v.y * v.y + v.z * v.z + v.w * v.w);
     }
 
     template<typename T>
-    inline vec4_t<T> normalize(const vec4_t<T>& v) {
+    constexpr vec4_t<T> normalize(const vec4_t<T>& v) {
         T l = length(v);
         return { v.x / l, v.y / l, v.z / l, v.w / l };
     }
 
     template<typename T>
-    inline T dot(const vec4_t<T>& v1, const vec4_t<T>& v2) {
+    constexpr T dot(const vec4_t<T>& v1, const vec4_t<T>& v2) {
         return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z + v1.w * v2.w;
     }
 
     // TODO(cheerwizard): do I really need a wedged/geometry products?
     template<typename T>
-    inline vec4_t<T> cross(const vec4_t<T>& v1, const vec4_t<T>& v2) {
+    constexpr vec4_t<T> cross(const vec4_t<T>& v1, const vec4_t<T>& v2) {
         // TODO(cheerwizard): not implemented!
         return {};
     }
 
-    struct quat_t {
+    // float4 is specialized with SIMD backend, it's 16 bytes aligned to be loaded with a single instruction
+    template<>
+    struct alignas(SF_SIMD_ALIGNMENT) vec4_t<float> {
+        float x, y, z, w;
+
+        vec4_t() = default;
+
+        constexpr vec4_t(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+
+        constexpr vec4_t(const vec2_t<float>& v) : x(v.x), y(v.y), z(0), w(0) {}
+
+        constexpr vec4_t(const vec3_t<float>& v) : x(v.x), y(v.y), z(v.z), w(0) {}
+
+        vec4_t(const vec4_t<float>& v) = default;
+
+        static inline vec4_t from_simd(simd4f_t s) {
+            vec4_t v;
+            simd4f_store(&v.x, s);
+            return v;
+        }
+
+        inline simd4f_t to_simd() const {
+            return simd4f_load(&x);
+        }
+
+        constexpr float& operator [](int i) {
+            return i == 0 ? x : i == 1 ? y : i == 2 ? z : w;
+        }
+
+        constexpr const float& operator [](int i) const {
+            return i == 0 ? x : i == 1 ? y : i == 2 ? z : w;
+        }
+
+        constexpr friend vec4_t operator +(const vec4_t& v1, const vec4_t& v2) {
+            if (SF_CONSTANT_EVALUATED()) {
+                return { v1.x + v2.x, v1.y + v2.y, v1.z + v2.z, v1.w + v2.w };
+            }
+            return from_simd(simd4f_add(v1.to_simd(), v2.to_simd()));
+        }
+
+        constexpr friend vec4_t operator -(const vec4_t& v1, const vec4_t& v2) {
+            if (SF_CONSTANT_EVALUATED()) {
+                return { v1.x - v2.x, v1.y - v2.y, v1.z - v2.z, v1.w - v2.w };
+            }
+            return from_simd(simd4f_sub(v1.to_simd(), v2.to_simd()));
+        }
+
+        constexpr friend vec4_t operator *(const vec4_t& v1, const vec4_t& v2) {
+            if (SF_CONSTANT_EVALUATED()) {
+                return { v1.x * v2.x, v1.y * v2.y, v1.z * v2.z, v1.w * v2.w };
+            }
+            return from_simd(simd4f_mul(v1.to_simd(), v2.to_simd()));
+        }
+
+        constexpr friend vec4_t operator /(const vec4_t& v1, const vec4_t& v2) {
+            if (SF_CONSTANT_EVALUATED()) {
+                return { v1.x / v2.x, v1.y / v2.y, v1.z / v2.z, v1.w / v2.w };
+            }
+            return from_simd(simd4f_div(v1.to_simd(), v2.to_simd()));
+        }
+
+        constexpr friend vec4_t operator +(const vec4_t& v1, const float& s) {
+            if (SF_CONSTANT_EVALUATED()) {
+                return { v1.x + s, v1.y + s, v1.z + s, v1.w + s };
+            }
+            return from_simd(simd4f_add(v1.to_simd(), simd4f_splat(s)));
+        }
+
+        constexpr friend vec4_t operator -(const vec4_t& v1, const float& s) {
+            if (SF_CONSTANT_EVALUATED()) {
+                return { v1.x - s, v1.y - s, v1.z - s, v1.w - s };
+            }
+            return from_simd(simd4f_sub(v1.to_simd(), simd4f_splat(s)));
+        }
+
+        constexpr friend vec4_t operator *(const vec4_t& v1, const float& s) {
+            if (SF_CONSTANT_EVALUATED()) {
+                return { v1.x * s, v1.y * s, v1.z * s, v1.w * s };
+            }
+            return from_simd(simd4f_mul(v1.to_simd(), simd4f_splat(s)));
+        }
+
+        constexpr friend vec4_t operator /(const vec4_t& v1, const float& s) {
+            if (SF_CONSTANT_EVALUATED()) {
+                return { v1.x / s, v1.y / s, v1.z / s, v1.w / s };
+            }
+            return from_simd(simd4f_div(v1.to_simd(), simd4f_splat(s)));
+        }
+
+        constexpr friend vec4_t operator +(const float& s, const vec4_t& v2) {
+            if (SF_CONSTANT_EVALUATED()) {
+                return { s + v2.x, s + v2.y, s + v2.z, s + v2.w };
+            }
+            return from_simd(simd4f_add(simd4f_splat(s), v2.to_simd()));
+        }
+
+        constexpr friend vec4_t operator -(const float& s, const vec4_t& v2) {
+            if (SF_CONSTANT_EVALUATED()) {
+                return { s - v2.x, s - v2.y, s - v2.z, s - v2.w };
+            }
+            return from_simd(simd4f_sub(simd4f_splat(s), v2.to_simd()));
+        }
+
+        constexpr friend vec4_t operator *(const float& s, const vec4_t& v2) {
+            if (SF_CONSTANT_EVALUATED()) {
+                return { s * v2.x, s * v2.y, s * v2.z, s * v2.w };
+            }
+            return from_simd(simd4f_mul(simd4f_splat(s), v2.to_simd()));
+        }
+
+        constexpr friend vec4_t operator /(const float& s, const vec4_t& v2) {
+            if (SF_CONSTANT_EVALUATED()) {
+                return { s / v2.x, s / v2.y, s / v2.z, s / v2.w };
+            }
+            return from_simd(simd4f_div(simd4f_splat(s), v2.to_simd()));
+        }
+
+        inline friend vec4_t operator ^(const vec4_t& v, const float& p) {
+            return { std::pow(v.x, p), std::pow(v.y, p), std::pow(v.z, p), std::pow(v.w, p) };
+        }
+
+        constexpr friend vec4_t operator -(const vec4_t& v) {
+            if (SF_CONSTANT_EVALUATED()) {
+                return { -v.x, -v.y, -v.z, -v.w };
+            }
+            return from_simd(simd4f_neg(v.to_simd()));
+        }
+
+        constexpr vec2_t<float> xy() const {
+            return { x, y };
+        }
+
+        constexpr vec3_t<float> xyz() const {
+            return { x, y, z };
+        }
+    };
+
+    constexpr float dot(const vec4_t<float>& v1, const vec4_t<float>& v2) {
+        if (SF_CONSTANT_EVALUATED()) {
+            return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z + v1.w * v2.w;
+        }
+        return simd4f_sum(simd4f_mul(v1.to_simd(), v2.to_simd()));
+    }
+
+    constexpr float length(const vec4_t<float>& v) {
+        return math_sqrt(dot(v, v));
+    }
+
+    constexpr vec4_t<float> normalize(const vec4_t<float>& v) {
+        if (SF_CONSTANT_EVALUATED()) {
+            return v / length(v);
+        }
+        return vec4_t<float>::from_simd(simd4f_div(v.to_simd(), simd4f_splat(length(v))));
+    }
+
+    struct alignas(SF_SIMD_ALIGNMENT) quat_t {
         float x = 0;
         float y = 0;
         float z = 0;
@@ -375,24 +792,48 @@ namespace sf {
 
         quat_t() = default;
 
-        quat_t(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+        constexpr quat_t(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+
+        constexpr quat_t(float nx, float ny, float nz, const radians_t& r = radians_t(0)) {
+            float s = 0;
+            float c = 0;
+            if (SF_CONSTANT_EVALUATED()) {
+                s = float(constexpr_sin(r * 0.5f));
+                c = float(constexpr_cos(r * 0.5f));
+            } else {
+                sincos(r * 0.5f, s, c);
+            }
+            x = nx * s;
+            y = ny * s;
+            z = nz * s;
+            w = c;
+        }
+
+        constexpr quat_t(const vec3_t<float>& n, const radians_t& r = radians_t(0)) : quat_t(n.x, n.y, n.z , r) {}
 
-        quat_t(float nx, float ny, float nz, const radians_t& r = radians_t(0)) {
-            x = nx * std::sin(r * 0.5f);
-            y = ny * std::sin(r * 0.5f);
-            z = nz * std::sin(r * 0.5f);
-            w = std::cos(r * 0.5f);
+        static inline quat_t from_simd(simd4f_t s) {
+            quat_t q;
+            simd4f_store(&q.x, s);
+            return q;
         }
 
-        quat_t(const vec3_t<float>& n, const radians_t& r = radians_t(0)) : quat_t(n.x, n.y, n.z , r) {}
+        inline simd4f_t to_simd() const {
+            return simd4f_load(&x);
+        }
 
+        // Hamilton product, lanes are summed in the same order as the scalar form:
+        // x = w1 * x2 + x1 * w2 + y1 * z2 - z1 * y2
+        // y = w1 * y2 - x1 * z2 + y1 * w2 + z1 * x2
+        // z = w1 * z2 + x1 * y2 - y1 * x2 + z1 * w2
+        // w = w1 * w2 - x1 * x2 - y1 * y2 - z1 * z2
         inline friend quat_t operator *(const quat_t& q1, const quat_t& q2) {
-            quat_t q3;
-            q3.x = q1.w * q2.x + q1.x * q2.w + q1.y * q2.z - q1.z * q2.y;
-            q3.y = q1.w * q2.y - q1.x * q2.z + q1.y * q2.w + q1.z * q2.x;
-            q3.z = q1.w * q2.z + q1.x * q2.y - q1.y * q2.x + q1.z * q2.w;
-            q3.w = q1.w * q2.w - q1.x * q2.x - q1.y * q2.y - q1.z * q2.z;
-            return q3;
+            const simd4f_t a = q1.to_simd();
+            const simd4f_t b = q2.to_simd();
+            const simd4f_t t0 = simd4f_mul(simd4f_splat_lane<3>(a), b);
+            const simd4f_t t1 = simd4f_mul(simd4f_mul(simd4f_splat_lane<0>(a), simd4f_shuffle<3, 2, 1, 0>(b, b)), simd4f_set(1, -1, 1, -1));
+            const simd4f_t t2 = simd4f_mul(simd4f_mul(simd4f_splat_lane<1>(a), simd4f_shuffle<2, 3, 0, 1>(b, b)), simd4f_set(1, 1, -1, -1));
+            const simd4f_t t3 = simd4f_mul(simd4f_mul(simd4f_splat_lane<2>(a), simd4f_shuffle<1, 0, 3, 2>(b, b)), simd4f_set(-1, 1, 1, -1));
+            return from_simd(simd4f_add(simd4f_add(simd4f_add(t0, t1), t2), t3));
         }
 
         inline friend quat_t operator-(const quat_t& q) {
@@ -409,44 +850,120 @@ namespace sf {
     };
 
     inline float length(const quat_t& q) {
-        return std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z);
+        const simd4f_t s = q.to_simd();
+        return std::sqrt(simd4f_sum(simd4f_mul(s, s)));
     }
 
+    // precise version divides by length, fast version multiplies by reciprocal square root
+    template<typename accuracy_t = accuracy_precise_t>
     inline quat_t normalize(const quat_t& q) {
-        float l = length(q);
-        return { q.x / l, q.y / l, q.z / l, q.w };
+        if constexpr (std::is_same_v<accuracy_t, accuracy_precise_t>) {
+            return quat_t::from_simd(simd4f_div(q.to_simd(), simd4f_splat(length(q))));
+        } else {
+            const simd4f_t s = q.to_simd();
+            return quat_t::from_simd(simd4f_mul(s, accuracy_t::rsqrt(simd4f_splat(simd4f_sum(simd4f_mul(s, s))))));
+        }
+    }
+
+    template<typename accuracy_t = accuracy_precise_t>
+    inline quat_t quat_axis_angle(const vec3_t<float>& n, const radians_t& r) {
+        float s, c;
+        sincos<accuracy_t>(r * 0.5f, s, c);
+        return { n.x * s, n.y * s, n.z * s, c };
     }
 
     inline quat_t rotate(const quat_t& q, const vec3_t<float>& n) {
-        return q * quat_t(n) * -q;
+        // pure quaternion, quat_t(n) would be a zero angle rotation
+        return q * quat_t(n.x, n.y, n.z, 0.0f) * -q;
     }
 
-    inline quat_t slerp(const quat_t& q1, const quat_t& q2, float t) {
-        quat_t q3;
-        float dot = q1.x * q2.x + q1.y * q2.y + q1.z * q2.z + q1.w * q2.w;
-        float theta, st, sut, sout, coeff1, coeff2;
+    inline float dot(const quat_t& q1, const quat_t& q2) {
+        return simd4f_sum(simd4f_mul(q1.to_simd(), q2.to_simd()));
+    }
+
+    // q and -q are the same rotation, q2 is flipped to the same hemisphere as q1 to interpolate by the shortest arc
+    inline quat_t quat_shortest(const quat_t& q1, const quat_t& q2) {
+        return dot(q1, q2) < 0 ? quat_t::from_simd(simd4f_neg(q2.to_simd())) : q2;
+    }
+
+    template<typename accuracy_t = accuracy_precise_t>
+    inline quat_t nlerp(const quat_t& q1, const quat_t& q2, float t) {
+        const simd4f_t a = q1.to_simd();
+        const simd4f_t b = quat_shortest(q1, q2).to_simd();
+        return normalize<accuracy_t>(quat_t::from_simd(simd4f_add(a, simd4f_mul(simd4f_splat(t), simd4f_sub(b, a)))));
+    }
 
-        t /= 2.0;
+    // nlerp with t adjusted by a cubic fitted to slerp over the cosine of the angle (Kapoulkine, "Approximating slerp"),
+    // max angular error is ~1e-3 rad, while plain nlerp drifts up to ~0.14 rad at 180 degrees
+    inline float nlerp_correction(float d, float t) {
+        d = std::abs(d);
+        float a = 1.0904f + d * (-3.2452f + d * (3.55645f - d * 1.43519f));
+        float b = 0.848013f + d * (-1.06021f + d * 0.215638f);
+        float k = a * (t - 0.5f) * (t - 0.5f) + b;
+        return t + t * (t - 0.5f) * (t - 1.0f) * k;
+    }
+
+    template<typename accuracy_t = accuracy_precise_t>
+    inline quat_t nlerp_corrected(const quat_t& q1, const quat_t& q2, float t) {
+        return nlerp<accuracy_t>(q1, q2, nlerp_correction(dot(q1, q2), t));
+    }
+
+    // shortest arc slerp, nearly parallel quaternions fall back to nlerp, where sin(theta) loses all the precision
+    // sines of theta, (1 - t) * theta and t * theta are evaluated with one sincos call
+    template<typename accuracy_t = accuracy_precise_t>
+    inline quat_t slerp(const quat_t& q1, const quat_t& q2, float t) {
+        const quat_t q3 = quat_shortest(q1, q2);
+        const float d = dot(q1, q3);
 
-        theta = std::acos(dot);
-        if (theta < 0.0) {
-            theta=-theta;
+        if (d > 0.9995f) {
+            return nlerp<accuracy_t>(q1, q3, t);
         }
 
-        st = std::sin(theta);
-        sut = std::sin(t*theta);
-        sout = std::sin((1-t)*theta);
-        coeff1 = sout/st;
-        coeff2 = sut/st;
+        float theta = acos<accuracy_t>(d);
 
-        q3.x = coeff1*q1.x + coeff2*q2.x;
-        q3.y = coeff1*q1.y + coeff2*q2.y;
-        q3.z = coeff1*q1.z + coeff2*q2.z;
-        q3.w = coeff1*q1.w + coeff2*q2.w;
+        simd4f_t s, c;
+        accuracy_t::sincos(simd4f_set(theta, (1 - t) * theta, t * theta, 0), s, c);
+        float st = simd4f_lane<0>(s);
+        float coeff1 = simd4f_lane<1>(s) / st;
+        float coeff2 = simd4f_lane<2>(s) / st;
 
-        q3 = normalize(q3);
+        // coefficients are computed from approximated sines and acos, so the result is normalized like in SIMD kernels
+        return normalize<accuracy_t>(quat_t::from_simd(simd4f_add(
+                simd4f_mul(simd4f_splat(coeff1), q1.to_simd()),
+                simd4f_mul(simd4f_splat(coeff2), q3.to_simd())
+        )));
+    }
 
-        return q3;
+    // logarithm of unit quaternion is pure quaternion (axis * half angle, 0)
+    inline quat_t quat_log(const quat_t& q) {
+        float theta = std::acos(std::min(std::max(q.w, -1.0f), 1.0f));
+        float s = std::sin(theta);
+        float k = s > 1e-6f ? theta / s : 1.0f;
+        return { q.x * k, q.y * k, q.z * k, 0 };
+    }
+
+    // exponent of pure quaternion is unit quaternion
+    inline quat_t quat_exp(const quat_t& q) {
+        float theta = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z);
+        float s, c;
+        sincos(theta, s, c);
+        float k = theta > 1e-6f ? s / theta : 1.0f;
+        return { q.x * k, q.y * k, q.z * k, c };
+    }
+
+    // inner control point of key q between q_prev and q_next for squad: q * exp(-(log(q^-1 * q_next) + log(q^-1 * q_prev)) / 4)
+    inline quat_t squad_tangent(const quat_t& q_prev, const quat_t& q, const quat_t& q_next) {
+        const quat_t inv = -q;
+        const quat_t l1 = quat_log(inv * quat_shortest(q, q_next));
+        const quat_t l2 = quat_log(inv * quat_shortest(q, q_prev));
+        const simd4f_t l = simd4f_mul(simd4f_add(l1.to_simd(), l2.to_simd()), simd4f_splat(-0.25f));
+        return q * quat_exp(quat_t::from_simd(l));
+    }
+
+    // spherical cubic between q1 and q2 with control points a1 = squad_tangent(.., q1, q2) and a2 = squad_tangent(q1, q2, ..)
+    template<typename accuracy_t = accuracy_precise_t>
+    inline quat_t squad(const quat_t& q1, const quat_t& q2, const quat_t& a1, const quat_t& a2, float t) {
+        return slerp<accuracy_t>(slerp<accuracy_t>(q1, q2, t), slerp<accuracy_t>(a1, a2, t), 2.0f * t * (1.0f - t));
     }
 
     template<typename T>
@@ -521,15 +1038,12 @@ namespace sf {
     }
 
     template<typename T>
-    mat2_t<T> inverse(const mat2_t<T>& m) {
-        mat2_t<T> c;
-        T d = det(m);
-        c[0][0] = m[1][1];
-        c[0][1] =-m[1][0];
-        c[1][0] =-m[0][1];
-        c[1][1] = m[0][0];
-        c /= d;
-        return c;
+    inline mat2_t<T> inverse(const mat2_t<T>& m) {
+        T inv_d = T(1) / det(m);
+        return {
+                m[1][1] * inv_d, -m[0][1] * inv_d,
+                -m[1][0] * inv_d, m[0][0] * inv_d
+        };
     }
 
     template<typename T>
@@ -623,60 +1137,18 @@ namespace sf {
         return d;
     }
 
+    // columns of the inverse are cross products of rows divided by determinant
     template<typename T>
-    mat3_t<T> inverse(const mat3_t<T>& m) {
-        T d = det(m);
-
-        mat3_t<T> c;
-
-        c[0][0] = det(mat2_t<T> {
-                m[1][1], m[1][2],
-                m[2][1], m[2][2]
-        });
-
-        c[0][1] = -det(mat2_t<T> {
-                m[1][0], m[1][2],
-                m[2][0], m[2][2]
-        });
-
-        c[0][2] = det(mat2_t<T> {
-                m[1][0], m[1][1],
-                m[2][0], m[2][1]
-        });
-
-        c[1][0] = -det(mat2_t<T> {
-                m[0][0], m[0][1],
-                m[2][0], m[2][1]
-        });
-
-        c[1][1] = det(mat2_t<T> {
-                m[0][0], m[0][2],
-                m[2][0], m[2][2]
-        });
-
-        c[1][2] = -det(mat2_t<T> {
-                m[0][0], m[0][1],
-                m[2][0], m[2][1]
-        });
-
-        c[2][0] = det(mat2_t<T> {
-                m[0][1], m[0][2],
-                m[1][1], m[1][2]
-        });
-
-        c[2][1] = -det(mat2_t<T> {
-                m[0][0], m[0][2],
-                m[1][0], m[1][2]
-        });
-
-        c[2][2] = det(mat2_t<T> {
-                m[0][0], m[0][1],
-                m[1][0], m[1][1]
-        });
-
-        c /= d;
-
-        return c;
+    inline mat3_t<T> inverse(const mat3_t<T>& m) {
+        const vec3_t<T> c0 = cross(m[1], m[2]);
+        const vec3_t<T> c1 = cross(m[2], m[0]);
+        const vec3_t<T> c2 = cross(m[0], m[1]);
+        const T inv_d = T(1) / dot(m[0], c0);
+        return {
+                c0.x * inv_d, c1.x * inv_d, c2.x * inv_d,
+                c0.y * inv_d, c1.y * inv_d, c2.y * inv_d,
+                c0.z * inv_d, c1.z * inv_d, c2.z * inv_d
+        };
     }
 
     template<typename T>
@@ -685,97 +1157,39 @@ namespace sf {
 
         mat4_t() = default;
 
-        mat4_t(
+        constexpr mat4_t(
                 T m00, T m01, T m02, T m03,
                 T m10, T m11, T m12, T m13,
                 T m20, T m21, T m22, T m23,
                 T m30, T m31, T m32, T m33
-        ) {
-            m[0][0] = m00;
-            m[0][1] = m01;
-            m[0][2] = m02;
-            m[0][3] = m03;
-
-            m[1][0] = m10;
-            m[1][1] = m11;
-            m[1][2] = m12;
-            m[1][3] = m13;
+        ) : m {
+                { m00, m01, m02, m03 },
+                { m10, m11, m12, m13 },
+                { m20, m21, m22, m23 },
+                { m30, m31, m32, m33 }
+        } {}
 
-            m[2][0] = m20;
-            m[2][1] = m21;
-            m[2][2] = m22;
-            m[2][3] = m23;
+        constexpr mat4_t(const vec4_t<T> &v0, const vec4_t<T> &v1, const vec4_t<T> &v2, const vec4_t<T> &v3) : m { v0, v1, v2, v3 } {}
 
-            m[3][0] = m30;
-            m[3][1] = m31;
-            m[3][2] = m32;
-            m[3][3] = m33;
-        }
+        constexpr mat4_t(const vec3_t<T> &v0, const vec3_t<T> &v1, const vec3_t<T> &v2, const vec3_t<T> &v3) : m { v0, v1, v2, v3 } {}
 
-        mat4_t(const vec4_t<T> &v0, const vec4_t<T> &v1, const vec4_t<T> &v2, const vec4_t<T> &v3) {
-            m[0] = v0;
-            m[1] = v1;
-            m[2] = v2;
-            m[3] = v3;
-        }
+        constexpr mat4_t(const quat_t &q) : mat4_t(
+                1.0f - 2.0f * (q.y * q.y + q.z * q.z), 2.0f * (q.x * q.y + q.w * q.z), 2.0f * (q.x * q.z - q.w * q.y), 0,
+                2.0f * (q.x * q.y - q.w * q.z), 1.0f - 2.0f * (q.x * q.x + q.z * q.z), 2.0f * (q.y * q.z + q.w * q.x), 0,
+                2.0f * (q.x * q.z + q.w * q.y), 2.0f * (q.y * q.z - q.w * q.x), 1.0f - 2.0f * (q.x * q.x + q.y * q.y), 0,
+                0, 0, 0, 1
+        ) {}
 
-        mat4_t(const vec3_t<T> &v0, const vec3_t<T> &v1, const vec3_t<T> &v2, const vec3_t<T> &v3) {
-            m[0] = v0;
-            m[1] = v1;
-            m[2] = v2;
-            m[3] = v3;
-        }
-
-        mat4_t(const quat_t &q) {
-            T xx = q.x * q.x;
-            T xy = q.x * q.y;
-            T xz = q.x * q.z;
-            T yy = q.y * q.y;
-            T zz = q.z * q.z;
-            T yz = q.y * q.z;
-            T wx = q.w * q.x;
-            T wy = q.w * q.y;
-            T wz = q.w * q.z;
-
-            m[0][0] = 1.0f - 2.0f * (yy + zz);
-            m[1][0] = 2.0f * (xy - wz);
-            m[2][0] = 2.0f * (xz + wy);
-            m[3][0] = 0.0;
-
-            m[0][1] = 2.0f * (xy + wz);
-            m[1][1] = 1.0f - 2.0f * (xx + zz);
-            m[2][1] = 2.0f * (yz - wx);
-            m[3][1] = 0.0;
-
-            m[0][2] = 2.0f * (xz - wy);
-            m[1][2] = 2.0f * (yz + wx);
-            m[2][2] = 1.0f - 2.0f * (xx + yy);
-            m[3][2] = 0.0;
-
-            m[0][3] = 0;
-            m[1][3] = 0;
-            m[2][3] = 0;
-            m[3][3] = 1;
-        }
-
-        inline vec4_t<T>& operator[](int i) {
+        constexpr vec4_t<T>& operator[](int i) {
             return m[i];
         }
 
-        inline const vec4_t<T>& operator[](int i) const {
+        constexpr const vec4_t<T>& operator[](int i) const {
             return m[i];
         }
 
-        inline friend mat4_t operator*(const mat4_t &m1, const mat4_t &m2) {
-            mat4_t m3;
-            for (int r = 0; r < 4; r++) {
-                for (int c = 0; c < 4; c++) {
-                    for (int i = 0; i < 4; i++) {
-                        m3[r][c] += m1[r][i] * m2[i][c];
-                    }
-                }
-            }
-            return m3;
+        constexpr friend mat4_t operator*(const mat4_t &m1, const mat4_t &m2) {
+            return mat4_mul(m1, m2);
         }
 
         inline mat4_t operator-() const {
@@ -798,181 +1212,334 @@ namespace sf {
             return m2;
         }
 
-        inline friend mat4_t operator/=(const mat4_t& m1, T v) {
-            mat4_t m2 = m1;
+        inline mat4_t& operator/=(T v) {
             for (int r = 0; r < 4; r++) {
                 for (int c = 0; c < 4; c++) {
-                    m2[r][c] /= v;
+                    m[r][c] /= v;
                 }
             }
-            return m2;
+            return *this;
         }
     };
 
     template<typename T>
-    inline mat4_t<T> transpose(const mat4_t<T>& m) {
-        mat4_t t = m;
-
-        // Swap(t[0][0], t[0][0]);
-        std::swap(t[0][1], t[1][0]);
-        std::swap(t[0][2], t[2][0]);
-        std::swap(t[0][3], t[3][0]);
-
-        // Swap(t[1][0], t[0][1]);
-        // Swap(t[1][1], t[1][1]);
-        std::swap(t[1][2], t[2][1]);
-        std::swap(t[1][3], t[3][1]);
-
-        // Swap(t[2][0], t[0][2]);
-        // Swap(t[2][1], t[1][2]);
-        // Swap(t[2][2], t[2][2]);
-        std::swap(t[2][3], t[3][2]);
-
-        // Swap(t[3][0], t[0][3]);
-        // Swap(t[3][1], t[1][3]);
-        // Swap(t[3][2], t[2][3]);
-        // Swap(t[3][3], t[3][3]);
+    constexpr mat4_t<T> mat4_mul(const mat4_t<T>& m1, const mat4_t<T>& m2) {
+        mat4_t<T> m3 = {};
+        for (int r = 0; r < 4; r++) {
+            for (int c = 0; c < 4; c++) {
+                T s = m1[r][0] * m2[0][c];
+                for (int i = 1; i < 4; i++) {
+                    s = s + m1[r][i] * m2[i][c];
+                }
+                m3[r][c] = s;
+            }
+        }
+        return m3;
+    }
 
-        return t;
+    // each row of result is a linear combination of m2 rows, accumulated in the same order as scalar version
+    inline mat4_t<float> mat4_mul_simd(const mat4_t<float>& m1, const mat4_t<float>& m2) {
+        mat4_t<float> m3;
+#if defined(SF_SIMD_AVX)
+        const __m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m2[0]));
+        const __m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m2[1]));
+        const __m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m2[2]));
+        const __m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m2[3]));
+        for (int r = 0 ; r < 4 ; r += 2) {
+            const __m256 a = _mm256_loadu_ps(&m1[r].x);
+            __m256 s = _mm256_mul_ps(_mm256_permute_ps(a, 0x00), b0);
+            s = _mm256_add_ps(s, _mm256_mul_ps(_mm256_permute_ps(a, 0x55), b1));
+            s = _mm256_add_ps(s, _mm256_mul_ps(_mm256_permute_ps(a, 0xAA), b2));
+            s = _mm256_add_ps(s, _mm256_mul_ps(_mm256_permute_ps(a, 0xFF), b3));
+            _mm256_storeu_ps(&m3[r].x, s);
+        }
+#else
+        const simd4f_t b0 = m2[0].to_simd();
+        const simd4f_t b1 = m2[1].to_simd();
+        const simd4f_t b2 = m2[2].to_simd();
+        const simd4f_t b3 = m2[3].to_simd();
+        for (int r = 0 ; r < 4 ; r++) {
+            const simd4f_t a = m1[r].to_simd();
+            simd4f_t s = simd4f_mul(simd4f_splat_lane<0>(a), b0);
+            s = simd4f_add(s, simd4f_mul(simd4f_splat_lane<1>(a), b1));
+            s = simd4f_add(s, simd4f_mul(simd4f_splat_lane<2>(a), b2));
+            s = simd4f_add(s, simd4f_mul(simd4f_splat_lane<3>(a), b3));
+            simd4f_store(&m3[r].x, s);
+        }
+#endif
+        return m3;
     }
 
-    template<typename T>
-    inline T det(const mat4_t<T>& m) {
-        T d = m[0][0] * m[1][1] * m[2][2] * m[3][3]
-              + m[0][1] * m[1][2] * m[2][3] * m[3][0]
-              + m[0][2] * m[1][3] * m[2][0] * m[3][1]
-              - m[3][0] * m[2][1] * m[1][2] * m[0][3]
-              - m[3][1] * m[2][2] * m[1][3] * m[0][0]
-              - m[3][2] * m[2][3] * m[1][0] * m[0][1];
-        return d;
+    constexpr mat4_t<float> mat4_mul(const mat4_t<float>& m1, const mat4_t<float>& m2) {
+        return SF_CONSTANT_EVALUATED() ? mat4_mul<float>(m1, m2) : mat4_mul_simd(m1, m2);
     }
 
     template<typename T>
-    mat4_t<T> inverse(const mat4_t<T>& m) {
-        T d = det(m);
-
-        mat4_t<T> c;
-
-        c[0][0] = det(mat3_t<T>{
-                m[1][1], m[1][2], m[1][3],
-                m[2][1], m[2][2], m[2][3],
-                m[3][1], m[3][2], m[3][3]
-        });
-
-        c[0][1] = -det(mat3_t<T>{
-                m[1][0], m[1][2], m[1][3],
-                m[2][0], m[2][2], m[2][3],
-                m[3][0], m[3][2], m[3][3]
-        });
-
-        c[0][2] = det(mat3_t<T>{
-                m[1][0], m[1][1], m[1][3],
-                m[2][0], m[2][1], m[2][3],
-                m[3][0], m[3][1], m[3][3]
-        });
-
-        c[0][3] = -det(mat3_t<T>{
-                m[1][0], m[1][1], m[1][2],
-                m[2][0], m[2][1], m[2][2],
-                m[3][0], m[3][1], m[3][2]
-        });
+    constexpr mat4_t<T> transpose(const mat4_t<T>& m) {
+        return {
+                m[0][0], m[1][0], m[2][0], m[3][0],
+                m[0][1], m[1][1], m[2][1], m[3][1],
+                m[0][2], m[1][2], m[2][2], m[3][2],
+                m[0][3], m[1][3], m[2][3], m[3][3]
+        };
+    }
 
-        c[1][0] = -det(mat3_t<T>{
-                m[0][1], m[0][2], m[0][3],
-                m[2][1], m[2][2], m[2][3],
-                m[3][1], m[3][2], m[3][3]
-        });
+    inline mat4_t<float> transpose_simd(const mat4_t<float>& m) {
+        simd4f_t r0 = m[0].to_simd();
+        simd4f_t r1 = m[1].to_simd();
+        simd4f_t r2 = m[2].to_simd();
+        simd4f_t r3 = m[3].to_simd();
+        simd4f_transpose(r0, r1, r2, r3);
+        return { vec4_t<float>::from_simd(r0), vec4_t<float>::from_simd(r1), vec4_t<float>::from_simd(r2), vec4_t<float>::from_simd(r3) };
+    }
 
-        c[1][1] = det(mat3_t<T>{
-                m[0][0], m[0][2], m[0][3],
-                m[2][0], m[2][2], m[2][3],
-                m[3][0], m[3][2], m[3][3]
-        });
+    constexpr mat4_t<float> transpose(const mat4_t<float>& m) {
+        return SF_CONSTANT_EVALUATED() ? transpose<float>(m) : transpose_simd(m);
+    }
 
-        c[1][2] = -det(mat3_t<T>{
-                m[0][0], m[0][1], m[0][3],
-                m[2][0], m[2][1], m[2][3],
-                m[3][0], m[3][1], m[3][3]
-        });
+    // Laplace expansion by 2x2 minors of the first two rows (s) and the last two rows (c)
+    template<typename T>
+    constexpr T det(const mat4_t<T>& m) {
+        T s0 = m[0][0] * m[1][1] - m[0][1] * m[1][0];
+        T s1 = m[0][0] * m[1][2] - m[0][2] * m[1][0];
+        T s2 = m[0][0] * m[1][3] - m[0][3] * m[1][0];
+        T s3 = m[0][1] * m[1][2] - m[0][2] * m[1][1];
+        T s4 = m[0][1] * m[1][3] - m[0][3] * m[1][1];
+        T s5 = m[0][2] * m[1][3] - m[0][3] * m[1][2];
+
+        T c5 = m[2][2] * m[3][3] - m[2][3] * m[3][2];
+        T c4 = m[2][1] * m[3][3] - m[2][3] * m[3][1];
+        T c3 = m[2][1] * m[3][2] - m[2][2] * m[3][1];
+        T c2 = m[2][0] * m[3][3] - m[2][3] * m[3][0];
+        T c1 = m[2][0] * m[3][2] - m[2][2] * m[3][0];
+        T c0 = m[2][0] * m[3][1] - m[2][1] * m[3][0];
+
+        return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    }
 
-        c[1][3] = det(mat3_t<T>{
-                m[0][0], m[0][1], m[0][2],
-                m[2][0], m[2][1], m[2][2],
-                m[3][0], m[3][1], m[3][2]
-        });
+    inline float det(const mat4_t<float>& m) {
+        const simd4f_t r0 = m[0].to_simd();
+        const simd4f_t r1 = m[1].to_simd();
+        const simd4f_t r2 = m[2].to_simd();
+        const simd4f_t r3 = m[3].to_simd();
+
+        // { s0, s1, s2, s3 }
+        const simd4f_t s = simd4f_sub(
+                simd4f_mul(simd4f_shuffle<0, 0, 0, 1>(r0, r0), simd4f_shuffle<1, 2, 3, 2>(r1, r1)),
+                simd4f_mul(simd4f_shuffle<1, 2, 3, 2>(r0, r0), simd4f_shuffle<0, 0, 0, 1>(r1, r1))
+        );
+        // { c5, c4, c3, c2 }
+        const simd4f_t c = simd4f_sub(
+                simd4f_mul(simd4f_shuffle<2, 1, 1, 0>(r2, r2), simd4f_shuffle<3, 3, 2, 3>(r3, r3)),
+                simd4f_mul(simd4f_shuffle<3, 3, 2, 3>(r2, r2), simd4f_shuffle<2, 1, 1, 0>(r3, r3))
+        );
+        // { s4, s5, c1, c0 }
+        const simd4f_t e = simd4f_sub(
+                simd4f_mul(simd4f_shuffle<1, 2, 0, 0>(r0, r2), simd4f_shuffle<3, 3, 2, 1>(r1, r3)),
+                simd4f_mul(simd4f_shuffle<3, 3, 2, 1>(r0, r2), simd4f_shuffle<1, 2, 0, 0>(r1, r3))
+        );
+
+        const simd4f_t p = simd4f_mul(s, c);
+        const float q0 = simd4f_lane<0>(e) * simd4f_lane<2>(e);
+        const float q1 = simd4f_lane<1>(e) * simd4f_lane<3>(e);
+
+        return simd4f_lane<0>(p) - simd4f_lane<1>(p) + simd4f_lane<2>(p) + simd4f_lane<3>(p) - q0 + q1;
+    }
 
-        c[2][0] = det(mat3_t<T>{
-                m[0][1], m[0][2], m[0][3],
-                m[1][1], m[1][2], m[1][3],
-                m[3][1], m[3][2], m[3][3]
-        });
+    // adjugate from the same 2x2 minors as det(), each cofactor is a 3x3 determinant expanded by one row of minors
+    template<typename T>
+    inline mat4_t<T> inverse(const mat4_t<T>& m) {
+        T s0 = m[0][0] * m[1][1] - m[0][1] * m[1][0];
+        T s1 = m[0][0] * m[1][2] - m[0][2] * m[1][0];
+        T s2 = m[0][0] * m[1][3] - m[0][3] * m[1][0];
+        T s3 = m[0][1] * m[1][2] - m[0][2] * m[1][1];
+        T s4 = m[0][1] * m[1][3] - m[0][3] * m[1][1];
+        T s5 = m[0][2] * m[1][3] - m[0][3] * m[1][2];
+
+        T c5 = m[2][2] * m[3][3] - m[2][3] * m[3][2];
+        T c4 = m[2][1] * m[3][3] - m[2][3] * m[3][1];
+        T c3 = m[2][1] * m[3][2] - m[2][2] * m[3][1];
+        T c2 = m[2][0] * m[3][3] - m[2][3] * m[3][0];
+        T c1 = m[2][0] * m[3][2] - m[2][2] * m[3][0];
+        T c0 = m[2][0] * m[3][1] - m[2][1] * m[3][0];
+
+        T inv_d = T(1) / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+        mat4_t<T> i;
+
+        i[0][0] =  (m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3) * inv_d;
+        i[0][1] = -(m[0][1] * c5 - m[0][2] * c4 + m[0][3] * c3) * inv_d;
+        i[0][2] =  (m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3) * inv_d;
+        i[0][3] = -(m[2][1] * s5 - m[2][2] * s4 + m[2][3] * s3) * inv_d;
+
+        i[1][0] = -(m[1][0] * c5 - m[1][2] * c2 + m[1][3] * c1) * inv_d;
+        i[1][1] =  (m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1) * inv_d;
+        i[1][2] = -(m[3][0] * s5 - m[3][2] * s2 + m[3][3] * s1) * inv_d;
+        i[1][3] =  (m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1) * inv_d;
+
+        i[2][0] =  (m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0) * inv_d;
+        i[2][1] = -(m[0][0] * c4 - m[0][1] * c2 + m[0][3] * c0) * inv_d;
+        i[2][2] =  (m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0) * inv_d;
+        i[2][3] = -(m[2][0] * s4 - m[2][1] * s2 + m[2][3] * s0) * inv_d;
+
+        i[3][0] = -(m[1][0] * c3 - m[1][1] * c1 + m[1][2] * c0) * inv_d;
+        i[3][1] =  (m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0) * inv_d;
+        i[3][2] = -(m[3][0] * s3 - m[3][1] * s1 + m[3][2] * s0) * inv_d;
+        i[3][3] =  (m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0) * inv_d;
+
+        return i;
+    }
 
-        c[2][1] = -det(mat3_t<T>{
-                m[0][0], m[0][2], m[0][3],
-                m[1][0], m[1][2], m[1][3],
-                m[3][0], m[3][2], m[3][3]
-        });
+    inline mat4_t<float> inverse(const mat4_t<float>& m) {
+        const simd4f_t r0 = m[0].to_simd();
+        const simd4f_t r1 = m[1].to_simd();
+        const simd4f_t r2 = m[2].to_simd();
+        const simd4f_t r3 = m[3].to_simd();
+
+        // same minors as det()
+        const simd4f_t s = simd4f_sub(
+                simd4f_mul(simd4f_shuffle<0, 0, 0, 1>(r0, r0), simd4f_shuffle<1, 2, 3, 2>(r1, r1)),
+                simd4f_mul(simd4f_shuffle<1, 2, 3, 2>(r0, r0), simd4f_shuffle<0, 0, 0, 1>(r1, r1))
+        );
+        const simd4f_t c = simd4f_sub(
+                simd4f_mul(simd4f_shuffle<2, 1, 1, 0>(r2, r2), simd4f_shuffle<3, 3, 2, 3>(r3, r3)),
+                simd4f_mul(simd4f_shuffle<3, 3, 2, 3>(r2, r2), simd4f_shuffle<2, 1, 1, 0>(r3, r3))
+        );
+        const simd4f_t e = simd4f_sub(
+                simd4f_mul(simd4f_shuffle<1, 2, 0, 0>(r0, r2), simd4f_shuffle<3, 3, 2, 1>(r1, r3)),
+                simd4f_mul(simd4f_shuffle<3, 3, 2, 1>(r0, r2), simd4f_shuffle<1, 2, 0, 0>(r1, r3))
+        );
+
+        const simd4f_t p = simd4f_mul(s, c);
+        const float q0 = simd4f_lane<0>(e) * simd4f_lane<2>(e);
+        const float q1 = simd4f_lane<1>(e) * simd4f_lane<3>(e);
+        const simd4f_t inv_d = simd4f_splat(1.0f / (simd4f_lane<0>(p) - simd4f_lane<1>(p) + simd4f_lane<2>(p) + simd4f_lane<3>(p) - q0 + q1));
+
+        // { cK, cK, sK, sK } pairs the minor of the bottom rows used by lanes 0-1 with the minor of the top rows used by lanes 2-3
+        const simd4f_t k5 = simd4f_shuffle<0, 0, 1, 1>(c, e);
+        const simd4f_t k4 = simd4f_shuffle<1, 1, 0, 0>(c, e);
+        const simd4f_t k3 = simd4f_shuffle<2, 2, 3, 3>(c, s);
+        const simd4f_t k2 = simd4f_shuffle<3, 3, 2, 2>(c, s);
+        const simd4f_t k1 = simd4f_shuffle<2, 2, 1, 1>(e, s);
+        const simd4f_t k0 = simd4f_shuffle<3, 3, 0, 0>(e, s);
+
+        // { m[1][j], m[0][j], m[3][j], m[2][j] }
+        simd4f_t a0 = r0, a1 = r1, a2 = r2, a3 = r3;
+        simd4f_transpose(a0, a1, a2, a3);
+        a0 = simd4f_shuffle<1, 0, 3, 2>(a0, a0);
+        a1 = simd4f_shuffle<1, 0, 3, 2>(a1, a1);
+        a2 = simd4f_shuffle<1, 0, 3, 2>(a2, a2);
+        a3 = simd4f_shuffle<1, 0, 3, 2>(a3, a3);
+
+        const simd4f_t even = simd4f_mul(simd4f_set(1.0f, -1.0f, 1.0f, -1.0f), inv_d);
+        const simd4f_t odd = simd4f_mul(simd4f_set(-1.0f, 1.0f, -1.0f, 1.0f), inv_d);
+
+        const simd4f_t i0 = simd4f_add(simd4f_sub(simd4f_mul(a1, k5), simd4f_mul(a2, k4)), simd4f_mul(a3, k3));
+        const simd4f_t i1 = simd4f_add(simd4f_sub(simd4f_mul(a0, k5), simd4f_mul(a2, k2)), simd4f_mul(a3, k1));
+        const simd4f_t i2 = simd4f_add(simd4f_sub(simd4f_mul(a0, k4), simd4f_mul(a1, k2)), simd4f_mul(a3, k0));
+        const simd4f_t i3 = simd4f_add(simd4f_sub(simd4f_mul(a0, k3), simd4f_mul(a1, k1)), simd4f_mul(a2, k0));
 
-        c[2][2] = det(mat3_t<T>{
-                m[0][0], m[0][1], m[0][3],
-                m[1][0], m[1][1], m[1][3],
-                m[3][0], m[3][1], m[3][3]
-        });
+        return {
+                vec4_t<float>::from_simd(simd4f_mul(i0, even)),
+                vec4_t<float>::from_simd(simd4f_mul(i1, odd)),
+                vec4_t<float>::from_simd(simd4f_mul(i2, even)),
+                vec4_t<float>::from_simd(simd4f_mul(i3, odd))
+        };
+    }
 
-        c[2][3] = -det(mat3_t<T>{
-                m[0][0], m[0][1], m[0][2],
-                m[1][0], m[1][1], m[1][2],
-                m[3][0], m[3][1], m[3][2]
-        });
+    // affine transform with the last column (0, 0, 0, 1): inverse of the 3x3 part and translation moved back through it
+    template<typename T>
+    inline mat4_t<T> inverse_affine(const mat4_t<T>& m) {
+        const vec3_t<T> r0 = { m[0][0], m[0][1], m[0][2] };
+        const vec3_t<T> r1 = { m[1][0], m[1][1], m[1][2] };
+        const vec3_t<T> r2 = { m[2][0], m[2][1], m[2][2] };
+        const vec3_t<T> t = { m[3][0], m[3][1], m[3][2] };
+
+        const vec3_t<T> c0 = cross(r1, r2);
+        const vec3_t<T> c1 = cross(r2, r0);
+        const vec3_t<T> c2 = cross(r0, r1);
+        const T inv_d = T(1) / dot(r0, c0);
+
+        mat4_t<T> i;
+        i[0] = { c0.x * inv_d, c1.x * inv_d, c2.x * inv_d, 0 };
+        i[1] = { c0.y * inv_d, c1.y * inv_d, c2.y * inv_d, 0 };
+        i[2] = { c0.z * inv_d, c1.z * inv_d, c2.z * inv_d, 0 };
+        i[3] = { -dot(t, c0) * inv_d, -dot(t, c1) * inv_d, -dot(t, c2) * inv_d, 1 };
+        return i;
+    }
 
-        c[3][0] = -det(mat3_t<T>{
-                m[0][1], m[0][2], m[0][3],
-                m[1][1], m[1][2], m[1][3],
-                m[2][1], m[2][2], m[2][3]
-        });
+    // rotation and translation only: inverse of rotation is its transpose
+    template<typename T>
+    constexpr mat4_t<T> inverse_rigid(const mat4_t<T>& m) {
+        const vec3_t<T> r0 = { m[0][0], m[0][1], m[0][2] };
+        const vec3_t<T> r1 = { m[1][0], m[1][1], m[1][2] };
+        const vec3_t<T> r2 = { m[2][0], m[2][1], m[2][2] };
+        const vec3_t<T> t = { m[3][0], m[3][1], m[3][2] };
+
+        mat4_t<T> i = {};
+        i[0] = { r0.x, r1.x, r2.x, 0 };
+        i[1] = { r0.y, r1.y, r2.y, 0 };
+        i[2] = { r0.z, r1.z, r2.z, 0 };
+        i[3] = { -dot(t, r0), -dot(t, r1), -dot(t, r2), 1 };
+        return i;
+    }
 
-        c[3][1] = det(mat3_t<T>{
-                m[0][0], m[0][2], m[0][3],
-                m[1][0], m[1][2], m[1][3],
-                m[2][0], m[2][2], m[2][3]
-        });
+    inline mat4_t<float> inverse_rigid_simd(const mat4_t<float>& m) {
+        simd4f_t r0 = m[0].to_simd();
+        simd4f_t r1 = m[1].to_simd();
+        simd4f_t r2 = m[2].to_simd();
+        // zero row moves into w lanes of the rotation rows, transposed w column is dropped
+        simd4f_t r3 = simd4f_zero();
+        const simd4f_t t = m[3].to_simd();
 
-        c[3][2] = -det(mat3_t<T>{
-                m[0][0], m[0][1], m[0][3],
-                m[1][0], m[1][1], m[1][3],
-                m[2][0], m[2][1], m[2][3]
-        });
+        simd4f_transpose(r0, r1, r2, r3);
 
-        c[3][3] = det(mat3_t<T>{
-                m[0][0], m[0][1], m[0][2],
-                m[1][0], m[1][1], m[1][2],
-                m[2][0], m[2][1], m[2][2]
-        });
+        simd4f_t d = simd4f_mul(simd4f_splat_lane<0>(t), r0);
+        d = simd4f_add(d, simd4f_mul(simd4f_splat_lane<1>(t), r1));
+        d = simd4f_add(d, simd4f_mul(simd4f_splat_lane<2>(t), r2));
 
-        c /= d;
+        // negated like -dot() of scalar path, so zero translation gives -0 on both
+        vec4_t<float> translation = vec4_t<float>::from_simd(simd4f_neg(d));
+        translation.w = 1.0f;
+        return {
+                vec4_t<float>::from_simd(r0),
+                vec4_t<float>::from_simd(r1),
+                vec4_t<float>::from_simd(r2),
+                translation
+        };
+    }
 
-        return c;
+    constexpr mat4_t<float> inverse_rigid(const mat4_t<float>& m) {
+        return SF_CONSTANT_EVALUATED() ? inverse_rigid<float>(m) : inverse_rigid_simd(m);
     }
 
-    template<typename T>
-    mat4_t<T> inverse_fast(const mat4_t<T>& m) {
-        // TODO(cheerwizard): not implemented!
-        return {};
+    /**
+     * Matrices are used with row vectors: p' = p * m, which is the convention of mat4_perspective and mat4_ortho.
+     * Translation is stored in m[3], model matrix is composed as scale * rotation * translation.
+     */
+
+    constexpr mat4_t<float> mat4_identity() {
+        return {
+                1, 0, 0, 0,
+                0, 1, 0, 0,
+                0, 0, 1, 0,
+                0, 0, 0, 1
+        };
     }
 
-    void translate(mat4_t<float>& m, const vec3_t<float>& translation) {
-        m[0][3] += translation.x;
-        m[1][3] += translation.y;
-        m[2][3] += translation.z;
+    inline void translate(mat4_t<float>& m, const vec3_t<float>& translation) {
+        m[3][0] += translation.x;
+        m[3][1] += translation.y;
+        m[3][2] += translation.z;
     }
 
-    void scale(mat4_t<float>& m, const vec3_t<float>& scalar) {
+    inline void scale(mat4_t<float>& m, const vec3_t<float>& scalar) {
         m[0][0] *= scalar.x;
         m[1][1] *= scalar.y;
         m[2][2] *= scalar.z;
     }
 
-    void rotate(mat4_t<float>& m, const vec3_t<radians_t>& r, const vec3_t<float>& axis) {
+    inline void rotate(mat4_t<float>& m, const vec3_t<radians_t>& r, const vec3_t<float>& axis) {
         mat4_t<float> rx;
         {
             float sinx = std::sin(r.x);
@@ -1009,47 +1576,54 @@ namespace sf {
         m = m * rz * ry * rx;
     }
 
-    mat4_t<float> mat4_model(const vec3_t<float>& translation, const vec3_t<radians_t>& rotation, const vec3_t<float>& scalar) {
-        mat4_t<float> m;
+    inline mat4_t<float> mat4_model(const vec3_t<float>& translation, const vec3_t<radians_t>& rotation, const vec3_t<float>& scalar) {
+        mat4_t<float> m = mat4_identity();
         translate(m, translation);
         rotate(m, rotation, { 1, 1, 1 });
         scale(m, scalar);
         return m;
     }
 
-    mat4_t<float> mat4_model(const vec3_t<float>& translation, const quat_t& rotation, const vec3_t<float>& scalar) {
-        mat4_t<float> m;
-        translate(m, translation);
-        m = m * mat4_t<float>(rotation);
-        scale(m, scalar);
+    // rows of rotation are scaled and translation goes to the last row, same as scale * rotation * translation
+    constexpr mat4_t<float> mat4_trs(const vec3_t<float>& translation, const quat_t& rotation, const vec3_t<float>& scalar) {
+        mat4_t<float> m(rotation);
+        m[0] = { m[0].x * scalar.x, m[0].y * scalar.x, m[0].z * scalar.x, 0 };
+        m[1] = { m[1].x * scalar.y, m[1].y * scalar.y, m[1].z * scalar.y, 0 };
+        m[2] = { m[2].x * scalar.z, m[2].y * scalar.z, m[2].z * scalar.z, 0 };
+        m[3] = { translation.x, translation.y, translation.z, 1 };
         return m;
     }
 
-    mat4_t<float> mat4_rigid(const vec3_t<float>& translation, const vec3_t<radians_t>& rotation) {
-        mat4_t<float> m;
+    constexpr mat4_t<float> mat4_model(const vec3_t<float>& translation, const quat_t& rotation, const vec3_t<float>& scalar) {
+        return mat4_trs(translation, rotation, scalar);
+    }
+
+    inline mat4_t<float> mat4_rigid(const vec3_t<float>& translation, const vec3_t<radians_t>& rotation) {
+        mat4_t<float> m = mat4_identity();
         translate(m, translation);
         rotate(m, rotation, { 1, 1, 1 });
         return m;
     }
 
-    inline mat4_t<float> mat4_rigid(const vec3_t<float>& translation, const quat_t& rotation) {
-        mat4_t<float> m;
-        translate(m, translation);
-        m = m * mat4_t<float>(rotation);
+    constexpr mat4_t<float> mat4_rigid(const vec3_t<float>& translation, const quat_t& rotation) {
+        mat4_t<float> m(rotation);
+        m[3] = { translation.x, translation.y, translation.z, 1 };
         return m;
     }
 
-    inline mat4_t<float> mat4_view(const vec3_t<float>& position, const vec3_t<float>& front, const vec3_t<float>& up) {
+    // inverse of the camera world transform with basis rows right, up, back and position
+    constexpr mat4_t<float> mat4_view(const vec3_t<float>& position, const vec3_t<float>& front, const vec3_t<float>& up) {
         vec3_t<float> right = normalize(cross(front, up));
-        return inverse_fast(transpose(mat4_t<float>(
-                right,
-                cross(right, front),
-                -front,
-                position
-        )));
+        vec3_t<float> camera_up = cross(right, front);
+        return inverse_rigid(mat4_t<float> {
+                { right.x, right.y, right.z, 0.0f },
+                { camera_up.x, camera_up.y, camera_up.z, 0.0f },
+                { -front.x, -front.y, -front.z, 0.0f },
+                { position.x, position.y, position.z, 1.0f }
+        });
     }
 
-    inline mat4_t<float> mat4_ortho(float left, float right, float bottom, float top, float z_near, float z_far) {
+    constexpr mat4_t<float> mat4_ortho(float left, float right, float bottom, float top, float z_near, float z_far) {
         return mat4_t<float> {
                 { 2.0f / (right - left), 0.0f, 0.0f, 0.0f },
                 { 0.0f, 2.0f / (bottom - top), 0.0f, 0.0f },
@@ -1058,8 +1632,8 @@ namespace sf {
         };
     }
 
-    inline mat4_t<float> mat4_perspective(float aspect, degree_t fov, float z_near, float z_far) {
-        float f = 1.0f / tan(radians_t(0.5f * fov));
+    constexpr mat4_t<float> mat4_perspective(float aspect, degree_t fov, float z_near, float z_far) {
+        float f = 1.0f / math_tan(float(radians_t(degree_t(0.5f * fov))));
         return mat4_t<float> {
                 { f / aspect, 0.0f, 0.0f, 0.0f },
                 { 0.0f, -f, 0.0f, 0.0f },
@@ -1068,9 +1642,21 @@ namespace sf {
         };
     }
 
+    // inverse transpose of the 3x3 part, rows are cross products of model rows divided by determinant
     inline mat4_t<float> mat4_normal(const mat4_t<float>& model) {
-        mat4_t<float> m = transpose(inverse(model));
-        return m;
+        const vec3_t<float> r0 = { model[0][0], model[0][1], model[0][2] };
+        const vec3_t<float> r1 = { model[1][0], model[1][1], model[1][2] };
+        const vec3_t<float> r2 = { model[2][0], model[2][1], model[2][2] };
+        const vec3_t<float> c0 = cross(r1, r2);
+        const vec3_t<float> c1 = cross(r2, r0);
+        const vec3_t<float> c2 = cross(r0, r1);
+        const float inv_d = 1.0f / dot(r0, c0);
+        return mat4_t<float> {
+                { c0.x * inv_d, c0.y * inv_d, c0.z * inv_d, 0.0f },
+                { c1.x * inv_d, c1.y * inv_d, c1.z * inv_d, 0.0f },
+                { c2.x * inv_d, c2.y * inv_d, c2.z * inv_d, 0.0f },
+                { 0.0f, 0.0f, 0.0f, 1.0f }
+        };
     }
 
     typedef vec2_t<float> float2_t;
@@ -1100,4 +1686,186 @@ namespace sf {
     using double3x3_t = mat3_t<double>;
     using double4x4_t = mat4_t<double>;
 
+    /**
+     * Structure of arrays for batched kernels, arrays are owned by the caller and may be unaligned.
+     * Kernels process SF_SIMD_WIDTH lanes per iteration and finish the tail with scalar code,
+     * per lane results are the same as from matching scalar functions.
+     */
+
+    struct SF_API float3_soa_t final {
+        float* x = nullptr;
+        float* y = nullptr;
+        float* z = nullptr;
+    };
+
+    struct SF_API quat_soa_t final {
+        float* x = nullptr;
+        float* y = nullptr;
+        float* z = nullptr;
+        float* w = nullptr;
+    };
+
+    struct SF_API double3_soa_t final {
+        double* x = nullptr;
+        double* y = nullptr;
+        double* z = nullptr;
+    };
+
+    /**
+     * World positions are kept in double, rendering works in float relative to some origin near the camera.
+     * Difference is taken in double, so objects close to origin keep full float precision anywhere in the world.
+     */
+    inline float3_t rebase(const double3_t& position, const double3_t& origin) {
+        return { float(position.x - origin.x), float(position.y - origin.y), float(position.z - origin.z) };
+    }
+
+    // same result as rebase() for every lane
+    inline void rebase_soa(const double3_soa_t& positions, const double3_t& origin, const float3_soa_t& out, usize count) {
+        usize i = 0;
+
+        for (; i + SF_SIMD_WIDTH <= count ; i += SF_SIMD_WIDTH) {
+            simdf_store(out.x + i, simdf_load_relative(positions.x + i, origin.x));
+            simdf_store(out.y + i, simdf_load_relative(positions.y + i, origin.y));
+            simdf_store(out.z + i, simdf_load_relative(positions.z + i, origin.z));
+        }
+
+        for (; i < count ; i++) {
+            out.x[i] = float(positions.x[i] - origin.x);
+            out.y[i] = float(positions.y[i] - origin.y);
+            out.z[i] = float(positions.z[i] - origin.z);
+        }
+    }
+
+    // out = points * m, points are treated as positions with w = 1, out may alias points
+    inline void transform_points_soa(const float4x4_t& m, const float3_soa_t& points, const float3_soa_t& out, usize count) {
+        usize i = 0;
+
+        const simdf_t m00 = simdf_splat(m[0][0]), m01 = simdf_splat(m[0][1]), m02 = simdf_splat(m[0][2]);
+        const simdf_t m10 = simdf_splat(m[1][0]), m11 = simdf_splat(m[1][1]), m12 = simdf_splat(m[1][2]);
+        const simdf_t m20 = simdf_splat(m[2][0]), m21 = simdf_splat(m[2][1]), m22 = simdf_splat(m[2][2]);
+        const simdf_t m30 = simdf_splat(m[3][0]), m31 = simdf_splat(m[3][1]), m32 = simdf_splat(m[3][2]);
+
+        for (; i + SF_SIMD_WIDTH <= count ; i += SF_SIMD_WIDTH) {
+            const simdf_t x = simdf_load(points.x + i);
+            const simdf_t y = simdf_load(points.y + i);
+            const simdf_t z = simdf_load(points.z + i);
+            simdf_store(out.x + i, simdf_add(simdf_add(simdf_add(simdf_mul(x, m00), simdf_mul(y, m10)), simdf_mul(z, m20)), m30));
+            simdf_store(out.y + i, simdf_add(simdf_add(simdf_add(simdf_mul(x, m01), simdf_mul(y, m11)), simdf_mul(z, m21)), m31));
+            simdf_store(out.z + i, simdf_add(simdf_add(simdf_add(simdf_mul(x, m02), simdf_mul(y, m12)), simdf_mul(z, m22)), m32));
+        }
+
+        for (; i < count ; i++) {
+            const float x = points.x[i];
+            const float y = points.y[i];
+            const float z = points.z[i];
+            out.x[i] = x * m[0][0] + y * m[1][0] + z * m[2][0] + m[3][0];
+            out.y[i] = x * m[0][1] + y * m[1][1] + z * m[2][1] + m[3][1];
+            out.z[i] = x * m[0][2] + y * m[1][2] + z * m[2][2] + m[3][2];
+        }
+    }
+
+    // same result as normalize(quat_t) for every lane
+    inline void normalize_soa(const quat_soa_t& rotations, usize count) {
+        usize i = 0;
+
+        for (; i + SF_SIMD_WIDTH <= count ; i += SF_SIMD_WIDTH) {
+            const simdf_t x = simdf_load(rotations.x + i);
+            const simdf_t y = simdf_load(rotations.y + i);
+            const simdf_t z = simdf_load(rotations.z + i);
+            const simdf_t w = simdf_load(rotations.w + i);
+            const simdf_t l = simdf_sqrt(simdf_add(simdf_add(simdf_add(simdf_mul(x, x), simdf_mul(y, y)), simdf_mul(z, z)), simdf_mul(w, w)));
+            simdf_store(rotations.x + i, simdf_div(x, l));
+            simdf_store(rotations.y + i, simdf_div(y, l));
+            simdf_store(rotations.z + i, simdf_div(z, l));
+            simdf_store(rotations.w + i, simdf_div(w, l));
+        }
+
+        for (; i < count ; i++) {
+            const quat_t q = normalize(quat_t(rotations.x[i], rotations.y[i], rotations.z[i], rotations.w[i]));
+            rotations.x[i] = q.x;
+            rotations.y[i] = q.y;
+            rotations.z[i] = q.z;
+            rotations.w[i] = q.w;
+        }
+    }
+
+    // same result as mat4_trs() for every object, 4 objects are composed in SoA form and transposed into rows of 4 matrices
+    inline void mat4_trs_soa(
+            const float3_soa_t& translations,
+            const quat_soa_t& rotations,
+            const float3_soa_t& scales,
+            float4x4_t* out,
+            usize count
+    ) {
+        usize i = 0;
+
+        const simd4f_t one = simd4f_splat(1.0f);
+        const simd4f_t two = simd4f_splat(2.0f);
+
+        for (; i + 4 <= count ; i += 4) {
+            const simd4f_t x = simd4f_loadu(rotations.x + i);
+            const simd4f_t y = simd4f_loadu(rotations.y + i);
+            const simd4f_t z = simd4f_loadu(rotations.z + i);
+            const simd4f_t w = simd4f_loadu(rotations.w + i);
+
+            const simd4f_t xx = simd4f_mul(x, x), xy = simd4f_mul(x, y), xz = simd4f_mul(x, z);
+            const simd4f_t yy = simd4f_mul(y, y), yz = simd4f_mul(y, z), zz = simd4f_mul(z, z);
+            const simd4f_t wx = simd4f_mul(w, x), wy = simd4f_mul(w, y), wz = simd4f_mul(w, z);
+
+            const simd4f_t sx = simd4f_loadu(scales.x + i);
+            const simd4f_t sy = simd4f_loadu(scales.y + i);
+            const simd4f_t sz = simd4f_loadu(scales.z + i);
+
+            simd4f_t r00 = simd4f_mul(simd4f_sub(one, simd4f_mul(two, simd4f_add(yy, zz))), sx);
+            simd4f_t r01 = simd4f_mul(simd4f_mul(two, simd4f_add(xy, wz)), sx);
+            simd4f_t r02 = simd4f_mul(simd4f_mul(two, simd4f_sub(xz, wy)), sx);
+            simd4f_t r03 = simd4f_zero();
+
+            simd4f_t r10 = simd4f_mul(simd4f_mul(two, simd4f_sub(xy, wz)), sy);
+            simd4f_t r11 = simd4f_mul(simd4f_sub(one, simd4f_mul(two, simd4f_add(xx, zz))), sy);
+            simd4f_t r12 = simd4f_mul(simd4f_mul(two, simd4f_add(yz, wx)), sy);
+            simd4f_t r13 = simd4f_zero();
+
+            simd4f_t r20 = simd4f_mul(simd4f_mul(two, simd4f_add(xz, wy)), sz);
+            simd4f_t r21 = simd4f_mul(simd4f_mul(two, simd4f_sub(yz, wx)), sz);
+            simd4f_t r22 = simd4f_mul(simd4f_sub(one, simd4f_mul(two, simd4f_add(xx, yy))), sz);
+            simd4f_t r23 = simd4f_zero();
+
+            simd4f_t r30 = simd4f_loadu(translations.x + i);
+            simd4f_t r31 = simd4f_loadu(translations.y + i);
+            simd4f_t r32 = simd4f_loadu(translations.z + i);
+            simd4f_t r33 = one;
+
+            simd4f_transpose(r00, r01, r02, r03);
+            simd4f_transpose(r10, r11, r12, r13);
+            simd4f_transpose(r20, r21, r22, r23);
+            simd4f_transpose(r30, r31, r32, r33);
+
+            simd4f_store(&out[i][0].x, r00);
+            simd4f_store(&out[i][1].x, r10);
+            simd4f_store(&out[i][2].x, r20);
+            simd4f_store(&out[i][3].x, r30);
+            simd4f_store(&out[i + 1][0].x, r01);
+            simd4f_store(&out[i + 1][1].x, r11);
+            simd4f_store(&out[i + 1][2].x, r21);
+            simd4f_store(&out[i + 1][3].x, r31);
+            simd4f_store(&out[i + 2][0].x, r02);
+            simd4f_store(&out[i + 2][1].x, r12);
+            simd4f_store(&out[i + 2][2].x, r22);
+            simd4f_store(&out[i + 2][3].x, r32);
+            simd4f_store(&out[i + 3][0].x, r03);
+            simd4f_store(&out[i + 3][1].x, r13);
+            simd4f_store(&out[i + 3][2].x, r23);
+            simd4f_store(&out[i + 3][3].x, r33);
+        }
+
+        for (; i < count ; i++) {
+            out[i] = mat4_trs(
+                    { translations.x[i], translations.y[i], translations.z[i] },
+                    quat_t(rotations.x[i], rotations.y[i], rotations.z[i], rotations.w[i]),
+                    { scales.x[i], scales.y[i], scales.z[i] }
+            );
+        }
+    }
+
 }
\ No newline at end of file
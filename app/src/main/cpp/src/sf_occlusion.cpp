@@ -0,0 +1,137 @@
+#include <sf_occlusion.hpp>
+
+namespace sf {
+
+    occlusion_t occlusion_init(u32 occluder_triangle_capacity, u32 width, u32 height) {
+        occlusion_t occlusion;
+        occlusion.raster = raster_init(width, height, occluder_triangle_capacity);
+        return occlusion;
+    }
+
+    void occlusion_free(occlusion_t& occlusion) {
+        raster_free(occlusion.raster);
+    }
+
+    void occlusion_begin(occlusion_t& occlusion, const float4x4_t& view_projection) {
+        occlusion.view_projection = view_projection;
+        raster_clear(occlusion.raster);
+    }
+
+    u32 occlusion_add_occluder(occlusion_t& occlusion, const float4x4_t& model, const float3_t* positions, const u32* indices, u32 index_count) {
+        return raster_submit(occlusion.raster, model * occlusion.view_projection, positions, indices, index_count, 0);
+    }
+
+    void occlusion_render(occlusion_t& occlusion) {
+        raster_render(occlusion.raster);
+    }
+
+    static float occlusion_min_lane(simd4f_t v) {
+        return std::min(std::min(simd4f_lane<0>(v), simd4f_lane<1>(v)), std::min(simd4f_lane<2>(v), simd4f_lane<3>(v)));
+    }
+
+    static float occlusion_max_lane(simd4f_t v) {
+        return std::max(std::max(simd4f_lane<0>(v), simd4f_lane<1>(v)), std::max(simd4f_lane<2>(v), simd4f_lane<3>(v)));
+    }
+
+    // any depth under pixels [x0, x1) x [y0, y1) of the block is farther than depth
+    static bool occlusion_test_block(const raster_t& raster, u32 x, u32 y, u32 x0, u32 y0, u32 x1, u32 y1, float depth) {
+        const simd4f_t offsets = simd4f_set(0.0f, 1.0f, 2.0f, 3.0f);
+        const simd4f_t begin = simd4f_splat(float(x0) - 0.5f);
+        const simd4f_t end = simd4f_splat(float(x1));
+        const simd4f_t z = simd4f_splat(depth);
+        const u32 row_begin = std::max(y, y0);
+        const u32 row_end = std::min(y + SF_RASTER_BLOCK_SIZE, y1);
+
+        for (u32 row = row_begin ; row < row_end ; row++) {
+            const float* depth_row = raster.depth + usize(row) * raster.stride + x;
+            for (u32 half = 0 ; half < SF_RASTER_BLOCK_SIZE ; half += 4) {
+                const simd4f_t px = simd4f_add(simd4f_splat(float(x + half)), offsets);
+                simd4f_t mask = simd4f_less(z, simd4f_loadu(depth_row + half));
+                mask = simd4f_select(mask, simd4f_less(begin, px), mask);
+                mask = simd4f_select(mask, simd4f_less(px, end), mask);
+                if (simd4f_movemask(mask) != 0) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    bool occlusion_test_aabb(const occlusion_t& occlusion, const aabb_t& aabb) {
+        const raster_t& raster = occlusion.raster;
+        const float4x4_t& m = occlusion.view_projection;
+
+        // 4 corners of bottom and top layers are projected at once, x and y parts are shared by both layers
+        const simd4f_t x = simd4f_set(aabb.min.x, aabb.max.x, aabb.min.x, aabb.max.x);
+        const simd4f_t y = simd4f_set(aabb.min.y, aabb.min.y, aabb.max.y, aabb.max.y);
+        simd4f_t xy[4];
+        for (int c = 0 ; c < 4 ; c++) {
+            xy[c] = simd4f_add(simd4f_add(simd4f_mul(x, simd4f_splat(m[0][c])), simd4f_mul(y, simd4f_splat(m[1][c]))), simd4f_splat(m[3][c]));
+        }
+
+        simd4f_t screen_min_x = simd4f_splat(std::numeric_limits<float>::max());
+        simd4f_t screen_min_y = screen_min_x;
+        simd4f_t screen_min_z = screen_min_x;
+        simd4f_t screen_max_x = simd4f_neg(screen_min_x);
+        simd4f_t screen_max_y = screen_max_x;
+        const float layers[2] = { aabb.min.z, aabb.max.z };
+        for (float layer : layers) {
+            const simd4f_t z = simd4f_splat(layer);
+            const simd4f_t clip_x = simd4f_add(xy[0], simd4f_mul(z, simd4f_splat(m[2][0])));
+            const simd4f_t clip_y = simd4f_add(xy[1], simd4f_mul(z, simd4f_splat(m[2][1])));
+            const simd4f_t clip_z = simd4f_add(xy[2], simd4f_mul(z, simd4f_splat(m[2][2])));
+            const simd4f_t clip_w = simd4f_add(xy[3], simd4f_mul(z, simd4f_splat(m[2][3])));
+            if (simd4f_movemask(simd4f_less(clip_z, simd4f_zero())) != 0) {
+                return true;
+            }
+
+            const simd4f_t inv_w = simd4f_div(simd4f_splat(1.0f), clip_w);
+            const simd4f_t screen_x = simd4f_mul(clip_x, inv_w);
+            const simd4f_t screen_y = simd4f_mul(clip_y, inv_w);
+            screen_min_x = simd4f_min(screen_min_x, screen_x);
+            screen_min_y = simd4f_min(screen_min_y, screen_y);
+            screen_max_x = simd4f_max(screen_max_x, screen_x);
+            screen_max_y = simd4f_max(screen_max_y, screen_y);
+            screen_min_z = simd4f_min(screen_min_z, simd4f_mul(clip_z, inv_w));
+        }
+
+        const float depth = occlusion_min_lane(screen_min_z);
+        const float min_x = std::max((occlusion_min_lane(screen_min_x) * 0.5f + 0.5f) * float(raster.width), 0.0f);
+        const float min_y = std::max((occlusion_min_lane(screen_min_y) * 0.5f + 0.5f) * float(raster.height), 0.0f);
+        const float max_x = std::min((occlusion_max_lane(screen_max_x) * 0.5f + 0.5f) * float(raster.width), float(raster.width));
+        const float max_y = std::min((occlusion_max_lane(screen_max_y) * 0.5f + 0.5f) * float(raster.height), float(raster.height));
+        // outside of screen or beyond far plane
+        if (min_x >= max_x || min_y >= max_y || depth > 1.0f) {
+            return false;
+        }
+
+        // neighbour pixels are tested too, so the box isn't hidden by occluder edge, which covers only the center of a pixel
+        const u32 x0 = u32(std::max(std::floor(min_x) - 1.0f, 0.0f));
+        const u32 y0 = u32(std::max(std::floor(min_y) - 1.0f, 0.0f));
+        const u32 x1 = u32(std::min(std::ceil(max_x) + 1.0f, float(raster.width)));
+        const u32 y1 = u32(std::min(std::ceil(max_y) + 1.0f, float(raster.height)));
+        for (u32 y = y0 / SF_RASTER_BLOCK_SIZE * SF_RASTER_BLOCK_SIZE ; y < y1 ; y += SF_RASTER_BLOCK_SIZE) {
+            for (u32 x = x0 / SF_RASTER_BLOCK_SIZE * SF_RASTER_BLOCK_SIZE ; x < x1 ; x += SF_RASTER_BLOCK_SIZE) {
+                // farthest depth of the block is still nearer than the box
+                if (raster.hiz[usize(y / SF_RASTER_BLOCK_SIZE) * raster.hiz_stride + x / SF_RASTER_BLOCK_SIZE] <= depth) {
+                    continue;
+                }
+                if (occlusion_test_block(raster, x, y, x0, y0, x1, y1, depth)) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    u32 occlusion_cull_aabbs(const occlusion_t& occlusion, const aabb_t* aabbs, u32 count, u32* visible) {
+        u32 visible_count = 0;
+        for (u32 i = 0 ; i < count ; i++) {
+            if (occlusion_test_aabb(occlusion, aabbs[i])) {
+                visible[visible_count++] = i;
+            }
+        }
+        return visible_count;
+    }
+
+}
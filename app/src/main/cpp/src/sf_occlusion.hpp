@@ -0,0 +1,52 @@
+#pragma once
+
+#include <sf_raster.hpp>
+
+#define SF_OCCLUSION_WIDTH 256
+#define SF_OCCLUSION_HEIGHT 128
+
+namespace sf {
+
+    /**
+     * Few large occluders are rasterized into coarse depth buffer, then bounds of objects are tested against it.
+     * Box is projected into screen rectangle with its nearest depth, it's hidden when every pixel under the rectangle is nearer.
+     * Blocks of hierarchical depth are checked first, so most hidden boxes never touch pixels.
+     * Depth is sampled at pixel centers, so an occluder edge can cover the center of a pixel and leave the rest of it open,
+     * box rectangle is expanded by one pixel, so box is hidden only when occluders reach past every pixel it touches.
+     * Thin occluders covering less than a pixel are lost.
+     */
+
+    struct SF_API occlusion_t final {
+        raster_t raster;
+        float4x4_t view_projection = mat4_identity();
+    };
+
+    SF_API occlusion_t occlusion_init(u32 occluder_triangle_capacity, u32 width = SF_OCCLUSION_WIDTH, u32 height = SF_OCCLUSION_HEIGHT);
+    SF_API void occlusion_free(occlusion_t& occlusion);
+    // view_projection is usually camera.view_projection, made from mat4_view and mat4_perspective
+    SF_API void occlusion_begin(occlusion_t& occlusion, const float4x4_t& view_projection);
+    // returns stored triangles, occluders beyond capacity are counted in raster.dropped_count and only make fewer boxes hidden
+    SF_API u32 occlusion_add_occluder(occlusion_t& occlusion, const float4x4_t& model, const float3_t* positions, const u32* indices, u32 index_count);
+    SF_API void occlusion_render(occlusion_t& occlusion);
+
+    // world space box, boxes crossing near plane are always visible
+    SF_API bool occlusion_test_aabb(const occlusion_t& occlusion, const aabb_t& aabb);
+    // indices of visible boxes are written to visible, returns their number
+    SF_API u32 occlusion_cull_aabbs(const occlusion_t& occlusion, const aabb_t* aabbs, u32 count, u32* visible);
+
+    template<typename A>
+    void occlusion_render_parallel(thread_pool_t<A>& thread_pool, occlusion_t& occlusion) {
+        raster_render_parallel(thread_pool, occlusion.raster);
+    }
+
+    // visible[i] is set to 1 for visible and 0 for hidden box, so chunks don't need to be compacted
+    template<typename A>
+    void occlusion_test_aabbs_parallel(thread_pool_t<A>& thread_pool, const occlusion_t& occlusion, const aabb_t* aabbs, u32 count, u8* visible) {
+        thread_pool_parallel_for(thread_pool, count, [&](u32, u32 begin, u32 end) {
+            for (u32 i = begin ; i < end ; i++) {
+                visible[i] = occlusion_test_aabb(occlusion, aabbs[i]) ? 1 : 0;
+            }
+        });
+    }
+
+}
@@ -1,8 +1,565 @@
 #include <sf_platform.hpp>
 
+#include <atomic>
+#include <cstdlib>
+
 namespace sf {
 
+    #define SF_INPUT_STATE_WORDS (sizeof(input_state_t) / sizeof(u64))
+
+    static_assert(sizeof(input_state_t) % sizeof(u64) == 0, "input_state_t must be copyable by whole words!");
+
+    // odd sequence means that slot is being written, state is copied by atomic words, so readers never race with writer
+    struct input_slot_t final {
+        std::atomic<u32> sequence;
+        std::atomic<u64> words[SF_INPUT_STATE_WORDS];
+    };
+
+    struct input_t final {
+        input_state_t state;
+        input_slot_t slots[2];
+        std::atomic<u32> published;
+    };
+
+    static input_t s_input;
+
+    struct input_event_queue_t final {
+        input_event_t events[SF_INPUT_EVENT_QUEUE_SIZE];
+        // head is written by producer, tail by consumer, they are kept on different cache lines
+        alignas(64) std::atomic<u32> head;
+        alignas(64) std::atomic<u32> tail;
+        std::atomic<u32> dropped;
+        // consumer only
+        u64 unpresented_ns = 0;
+        input_latency_t latency;
+    };
+
+    static input_event_queue_t s_input_event_queue;
+
+    struct input_record_t final {
+        bool active = false;
+        u8* data = nullptr;
+        usize size = 0;
+        usize capacity = 0;
+        u32 event_count = 0;
+        u64 start_ns = 0;
+        // previous values for deltas
+        i64 time_ns = 0;
+        i64 server_time_ms = 0;
+    };
+
+    struct input_record_header_t final {
+        u32 magic;
+        u32 version;
+        u32 event_count;
+        u32 size;
+    };
+
+    static input_record_t s_input_record;
+
+    static void input_record_event(const input_event_t& event);
+
+    void input_set_key(SF_KEYCODE keycode, bool pressed) {
+        if (keycode <= SF_KEYCODE_NONE || keycode > SF_KEYCODE_MENU) {
+            return;
+        }
+        u64& word = s_input.state.keys[keycode / 64];
+        const u64 bit = u64(1) << (keycode % 64);
+        word = pressed ? word | bit : word & ~bit;
+    }
+
+    void input_set_mouse(SF_MOUSE_CODE mouse_code, bool pressed) {
+        if (mouse_code > SF_MOUSE_CODE_BTN_LAST) {
+            return;
+        }
+        u32& buttons = s_input.state.mouse_buttons;
+        buttons = pressed ? buttons | 1u << mouse_code : buttons & ~(1u << mouse_code);
+    }
+
+    void input_set_gamepad(SF_GAMEPAD_CODE gamepad_code, bool pressed) {
+        if (gamepad_code > SF_GAMEPAD_CODE_PAD_LAST) {
+            return;
+        }
+        u32& buttons = s_input.state.gamepad_buttons;
+        buttons = pressed ? buttons | 1u << gamepad_code : buttons & ~(1u << gamepad_code);
+    }
+
+    void input_set_gamepad_axis(SF_GAMEPAD_AXIS axis, float value) {
+        if (axis <= SF_GAMEPAD_AXIS_LAST) {
+            s_input.state.gamepad_axes[axis] = value;
+        }
+    }
+
+    void input_set_cursor(int x, int y) {
+        s_input.state.cursor = { x, y };
+    }
+
+    void input_add_raw_motion(int dx, int dy) {
+        s_input.state.raw_motion_x += dx;
+        s_input.state.raw_motion_y += dy;
+    }
+
+    // writes into the slot, which isn't published, and then swaps them
+    void input_publish() {
+        input_t& input = s_input;
+        input.state.version++;
+
+        u64 words[SF_INPUT_STATE_WORDS];
+        std::memcpy(words, &input.state, sizeof(input_state_t));
+
+        const u32 index = (input.published.load(std::memory_order_relaxed) + 1) & 1;
+        input_slot_t& slot = input.slots[index];
+        const u32 sequence = slot.sequence.load(std::memory_order_relaxed);
+        slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (usize i = 0 ; i < SF_INPUT_STATE_WORDS ; i++) {
+            slot.words[i].store(words[i], std::memory_order_relaxed);
+        }
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+        input.published.store(index, std::memory_order_release);
+    }
+
+    input_state_t input_get_state() {
+        input_t& input = s_input;
+        u64 words[SF_INPUT_STATE_WORDS];
+        while (true) {
+            const input_slot_t& slot = input.slots[input.published.load(std::memory_order_acquire)];
+            const u32 sequence = slot.sequence.load(std::memory_order_acquire);
+            if ((sequence & 1) != 0) {
+                continue;
+            }
+
+            for (usize i = 0 ; i < SF_INPUT_STATE_WORDS ; i++) {
+                words[i] = slot.words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (slot.sequence.load(std::memory_order_relaxed) == sequence) {
+                input_state_t state;
+                std::memcpy(&state, words, sizeof(input_state_t));
+                return state;
+            }
+        }
+    }
+
+    void input_dispatch(window_t& window, const input_event_t& event) {
+        window_t::desktop_events_t& events = window.desktop_events;
+        input_push_event(event);
+        if (s_input_record.active) {
+            input_record_event(event);
+        }
+
+        switch (event.type) {
+            case SF_INPUT_EVENT_KEY_PRESS: {
+                input_set_key(static_cast<SF_KEYCODE>(event.code), true);
+                if (events.event_key_press != nullptr) {
+                    events.event_key_press(static_cast<SF_KEYCODE>(event.code));
+                }
+                break;
+            }
+            case SF_INPUT_EVENT_KEY_RELEASE: {
+                input_set_key(static_cast<SF_KEYCODE>(event.code), false);
+                if (events.event_key_release != nullptr) {
+                    events.event_key_release(static_cast<SF_KEYCODE>(event.code));
+                }
+                break;
+            }
+            case SF_INPUT_EVENT_MOUSE_PRESS: {
+                input_set_mouse(static_cast<SF_MOUSE_CODE>(event.code), true);
+                if (events.event_mouse_press != nullptr) {
+                    events.event_mouse_press(static_cast<SF_MOUSE_CODE>(event.code));
+                }
+                break;
+            }
+            case SF_INPUT_EVENT_MOUSE_RELEASE: {
+                input_set_mouse(static_cast<SF_MOUSE_CODE>(event.code), false);
+                if (events.event_mouse_release != nullptr) {
+                    events.event_mouse_release(static_cast<SF_MOUSE_CODE>(event.code));
+                }
+                break;
+            }
+            case SF_INPUT_EVENT_GAMEPAD_PRESS: {
+                input_set_gamepad(static_cast<SF_GAMEPAD_CODE>(event.code), true);
+                if (events.event_gamepad_press != nullptr) {
+                    events.event_gamepad_press(static_cast<SF_GAMEPAD_CODE>(event.code));
+                }
+                break;
+            }
+            case SF_INPUT_EVENT_GAMEPAD_RELEASE: {
+                input_set_gamepad(static_cast<SF_GAMEPAD_CODE>(event.code), false);
+                if (events.event_gamepad_release != nullptr) {
+                    events.event_gamepad_release(static_cast<SF_GAMEPAD_CODE>(event.code));
+                }
+                break;
+            }
+            case SF_INPUT_EVENT_CURSOR_MOVE: {
+                input_set_cursor(event.x, event.y);
+                if (events.event_on_cursor_move != nullptr) {
+                    events.event_on_cursor_move(event.x, event.y);
+                }
+                break;
+            }
+            case SF_INPUT_EVENT_RAW_MOTION: {
+                input_add_raw_motion(event.x, event.y);
+                if (events.event_on_mouse_raw_move != nullptr) {
+                    events.event_on_mouse_raw_move(event.x, event.y);
+                }
+                break;
+            }
+            case SF_INPUT_EVENT_WINDOW_RESIZE: {
+                if (events.event_window_resize != nullptr) {
+                    events.event_window_resize(event.x, event.y);
+                }
+                break;
+            }
+            case SF_INPUT_EVENT_WINDOW_MOVE: {
+                if (events.event_window_move != nullptr) {
+                    events.event_window_move(event.x, event.y);
+                }
+                break;
+            }
+        }
+    }
+
+    bool input_push_event(const input_event_t& event) {
+        input_event_queue_t& queue = s_input_event_queue;
+        const u32 head = queue.head.load(std::memory_order_relaxed);
+        if (head - queue.tail.load(std::memory_order_acquire) == SF_INPUT_EVENT_QUEUE_SIZE) {
+            queue.dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        queue.events[head & (SF_INPUT_EVENT_QUEUE_SIZE - 1)] = event;
+        queue.head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool input_pop_event(input_event_t& event, u64 until_ns) {
+        input_event_queue_t& queue = s_input_event_queue;
+        const u32 tail = queue.tail.load(std::memory_order_relaxed);
+        if (tail == queue.head.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        const input_event_t& next = queue.events[tail & (SF_INPUT_EVENT_QUEUE_SIZE - 1)];
+        if (next.time_ns > until_ns) {
+            return false;
+        }
+
+        event = next;
+        queue.tail.store(tail + 1, std::memory_order_release);
+        if (queue.unpresented_ns == 0 || event.time_ns < queue.unpresented_ns) {
+            queue.unpresented_ns = event.time_ns;
+        }
+        return true;
+    }
+
+    u32 input_get_dropped_event_count() {
+        return s_input_event_queue.dropped.load(std::memory_order_relaxed);
+    }
+
+    void input_present(u64 present_ns) {
+        input_event_queue_t& queue = s_input_event_queue;
+        if (queue.unpresented_ns == 0) {
+            return;
+        }
+
+        input_latency_t& latency = queue.latency;
+        latency.last_ns = present_ns > queue.unpresented_ns ? present_ns - queue.unpresented_ns : 0;
+        latency.max_ns = std::max(latency.max_ns, latency.last_ns);
+        // exponential moving average over about 16 frames
+        latency.average_ns = latency.frame_count == 0 ? latency.last_ns : (latency.average_ns * 15 + latency.last_ns) / 16;
+        latency.frame_count++;
+        queue.unpresented_ns = 0;
+    }
+
+    input_latency_t input_get_latency() {
+        return s_input_event_queue.latency;
+    }
+
+    static u64 input_record_zigzag(i64 value) {
+        return (static_cast<u64>(value) << 1) ^ static_cast<u64>(value >> 63);
+    }
+
+    static i64 input_record_unzigzag(u64 value) {
+        return static_cast<i64>(value >> 1) ^ -static_cast<i64>(value & 1);
+    }
+
+    static void input_record_write(input_record_t& record, u64 value) {
+        // varint takes at most 10 bytes
+        if (record.size + 10 > record.capacity) {
+            const usize capacity = std::max(record.capacity * 2, usize(4096));
+            u8* data = malloc_t<u8>(capacity);
+            if (record.data != nullptr) {
+                std::memcpy(data, record.data, record.size);
+                sf::free(record.data);
+            }
+            record.data = data;
+            record.capacity = capacity;
+        }
+        do {
+            const u8 byte = value & 0x7F;
+            value >>= 7;
+            record.data[record.size++] = value != 0 ? byte | 0x80 : byte;
+        } while (value != 0);
+    }
+
+    static bool input_record_read(const u8* data, usize size, usize& offset, u64& value) {
+        value = 0;
+        for (u32 shift = 0 ; shift < 64 && offset < size ; shift += 7) {
+            const u8 byte = data[offset++];
+            value |= static_cast<u64>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // type, code, time delta, receive delay, x, y and server time delta, signed values are zigzag encoded
+    static void input_record_event(const input_event_t& event) {
+        input_record_t& record = s_input_record;
+        const i64 time_ns = event.time_ns > record.start_ns ? static_cast<i64>(event.time_ns - record.start_ns) : 0;
+        input_record_write(record, event.type);
+        input_record_write(record, event.code);
+        input_record_write(record, input_record_zigzag(time_ns - record.time_ns));
+        input_record_write(record, event.receive_ns > event.time_ns ? event.receive_ns - event.time_ns : 0);
+        input_record_write(record, input_record_zigzag(event.x));
+        input_record_write(record, input_record_zigzag(event.y));
+        input_record_write(record, input_record_zigzag(static_cast<i64>(event.server_time_ms) - record.server_time_ms));
+        record.time_ns = time_ns;
+        record.server_time_ms = event.server_time_ms;
+        record.event_count++;
+    }
+
+    void input_record_begin(u64 start_ns) {
+        input_record_t& record = s_input_record;
+        record.active = true;
+        record.size = 0;
+        record.event_count = 0;
+        record.start_ns = start_ns;
+        record.time_ns = 0;
+        record.server_time_ms = 0;
+    }
+
+    bool input_record_end(const char* filepath) {
+        input_record_t& record = s_input_record;
+        record.active = false;
+
+        FILE* file = fopen(filepath, "wb");
+        bool written = file != nullptr;
+        if (written) {
+            input_record_header_t header;
+            header.magic = SF_INPUT_RECORD_MAGIC;
+            header.version = SF_INPUT_RECORD_VERSION;
+            header.event_count = record.event_count;
+            header.size = static_cast<u32>(record.size);
+            written = fwrite(&header, sizeof(header), 1, file) == 1;
+            written &= record.size == 0 || fwrite(record.data, record.size, 1, file) == 1;
+            written &= fclose(file) == 0;
+        }
+
+        sf::free(record.data);
+        record.data = nullptr;
+        record.size = 0;
+        record.capacity = 0;
+        return written;
+    }
+
+    bool input_replay_load(input_replay_t& replay, const char* filepath) {
+        FILE* file = fopen(filepath, "rb");
+        if (file == nullptr) {
+            return false;
+        }
+
+        input_record_header_t header = {};
+        // every event takes 7 varints of at least one byte, so bigger count can't be encoded by payload
+        if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != SF_INPUT_RECORD_MAGIC || header.version != SF_INPUT_RECORD_VERSION
+            || u64(header.event_count) * 7 > header.size) {
+            fclose(file);
+            return false;
+        }
+
+        u8* data = malloc_t<u8>(std::max(header.size, 1u));
+        bool read = header.size == 0 || fread(data, header.size, 1, file) == 1;
+        // payload must be the rest of file
+        read &= fgetc(file) == EOF;
+        fclose(file);
+
+        replay = {};
+        replay.events = malloc_t<input_event_t>(std::max(header.event_count, 1u));
+        usize offset = 0;
+        i64 time_ns = 0;
+        i64 server_time_ms = 0;
+        bool decoded = read;
+        for (; decoded && replay.count < header.event_count ; replay.count++) {
+            u64 values[7];
+            for (u64& value : values) {
+                decoded &= input_record_read(data, header.size, offset, value);
+            }
+            time_ns += input_record_unzigzag(values[2]);
+            server_time_ms += input_record_unzigzag(values[6]);
+
+            input_event_t& event = replay.events[replay.count];
+            event.type = static_cast<u16>(values[0]);
+            event.code = static_cast<u16>(values[1]);
+            event.time_ns = static_cast<u64>(time_ns);
+            event.receive_ns = event.time_ns + values[3];
+            event.x = static_cast<int>(input_record_unzigzag(values[4]));
+            event.y = static_cast<int>(input_record_unzigzag(values[5]));
+            event.server_time_ms = static_cast<u32>(server_time_ms);
+        }
+
+        sf::free(data);
+        // all events must be decoded from the whole payload, without truncated varints or bytes left over
+        decoded &= offset == header.size;
+        if (!decoded) {
+            input_replay_free(replay);
+        }
+        return decoded;
+    }
+
+    void input_replay_free(input_replay_t& replay) {
+        sf::free(replay.events);
+        replay = {};
+    }
+
+    void input_replay_update(input_replay_t& replay, window_t& window, u64 now_ns) {
+        if (!replay.started) {
+            replay.start_ns = now_ns;
+            replay.started = true;
+        }
+
+        for (; replay.index < replay.count ; replay.index++) {
+            input_event_t event = replay.events[replay.index];
+            event.time_ns += replay.start_ns;
+            if (event.time_ns > now_ns) {
+                break;
+            }
+            event.receive_ns += replay.start_ns;
+            input_dispatch(window, event);
+        }
+    }
+
+    struct window_headless_t final {
+        u32* buffers[2] = { nullptr, nullptr };
+        u32 back = 0;
+        int width = 0;
+        int height = 0;
+        u64 time_ns = 0;
+        u64 frame_ns = SF_WINDOW_HEADLESS_FRAME_NS;
+        u64 update_count = 0;
+        u64 frame_limit = 0;
+        u64 frame_count = 0;
+        const input_event_t* script = nullptr;
+        u32 script_count = 0;
+        u32 script_index = 0;
+    };
+
+    static window_headless_t s_headless;
+
+    static bool window_headless_requested(SF_WINDOW_BACKEND backend) {
+        return backend == SF_WINDOW_BACKEND_HEADLESS || std::getenv("SF_HEADLESS") != nullptr;
+    }
+
+    static void window_headless_resize(int w, int h) {
+        window_headless_t& headless = s_headless;
+        sf::free(headless.buffers[0]);
+        sf::free(headless.buffers[1]);
+        headless.width = std::max(w, 1);
+        headless.height = std::max(h, 1);
+        headless.buffers[0] = calloc_t<u32>(usize(headless.width) * usize(headless.height));
+        headless.buffers[1] = calloc_t<u32>(usize(headless.width) * usize(headless.height));
+        headless.back = 0;
+    }
+
+    // script and frame settings are kept, so they can be set before window_init()
+    static window_t window_headless_init(int w, int h) {
+        window_headless_t& headless = s_headless;
+        window_headless_resize(w, h);
+        headless.time_ns = 0;
+        headless.update_count = 0;
+        headless.frame_count = 0;
+        headless.script_index = 0;
+
+        window_t window;
+        window.handle = nullptr;
+        window.refresh_rate = static_cast<u32>(1000000000ull / headless.frame_ns);
+        window.backend = SF_WINDOW_BACKEND_HEADLESS;
+        return window;
+    }
+
+    static void window_headless_free() {
+        window_headless_t& headless = s_headless;
+        sf::free(headless.buffers[0]);
+        sf::free(headless.buffers[1]);
+        headless.buffers[0] = nullptr;
+        headless.buffers[1] = nullptr;
+    }
+
+    static bool window_headless_update(window_t& window) {
+        window_headless_t& headless = s_headless;
+        if (headless.frame_limit != 0 && headless.update_count >= headless.frame_limit) {
+            return false;
+        }
+
+        for (; headless.script_index < headless.script_count ; headless.script_index++) {
+            input_event_t event = headless.script[headless.script_index];
+            if (event.time_ns > headless.time_ns) {
+                break;
+            }
+            event.receive_ns = headless.time_ns;
+            if (event.type == SF_INPUT_EVENT_WINDOW_RESIZE) {
+                window_headless_resize(event.x, event.y);
+            }
+            input_dispatch(window, event);
+        }
+
+        input_publish();
+        headless.time_ns += headless.frame_ns;
+        headless.update_count++;
+        return true;
+    }
+
+    static framebuffer_t window_headless_get_framebuffer(u32 buffer) {
+        const window_headless_t& headless = s_headless;
+        framebuffer_t framebuffer;
+        framebuffer.pixels = headless.buffers[buffer];
+        framebuffer.width = headless.width;
+        framebuffer.height = headless.height;
+        framebuffer.stride = headless.width;
+        return framebuffer;
+    }
+
+    static void window_headless_present() {
+        window_headless_t& headless = s_headless;
+        headless.back ^= 1;
+        headless.frame_count++;
+        input_present(headless.time_ns);
+    }
+
+    void window_headless_set_input(const input_event_t* events, u32 count) {
+        s_headless.script = events;
+        s_headless.script_count = count;
+        s_headless.script_index = 0;
+    }
+
+    void window_headless_set_frames(u64 frame_limit, u64 frame_ns) {
+        SF_ASSERT(frame_ns > 0, "window_headless_set_frames(): frame time must be positive!");
+        s_headless.frame_limit = frame_limit;
+        s_headless.frame_ns = frame_ns;
+    }
+
+    u64 window_headless_get_time_ns() {
+        return s_headless.time_ns;
+    }
+
+    u64 window_headless_get_frame_count() {
+        return s_headless.frame_count;
+    }
 
+    framebuffer_t window_headless_get_frame() {
+        return window_headless_get_framebuffer(s_headless.back ^ 1);
+    }
 
 }
 
@@ -82,7 +639,11 @@ namespace sf {
         return DefWindowProc(handle, msg, w_param, l_param);
     }
 
-    window_t window_init(const char *title, int x, int y, int w, int h, bool sync) {
+    window_t window_init(const char *title, int x, int y, int w, int h, bool sync, SF_WINDOW_BACKEND backend) {
+        if (window_headless_requested(backend)) {
+            return window_headless_init(w, h);
+        }
+
         window_t window;
 
         HINSTANCE instance = (HINSTANCE) GetCurrentProcess();
@@ -126,18 +687,47 @@ namespace sf {
     }
 
     void window_free(const window_t& window) {
+        if (window.backend == SF_WINDOW_BACKEND_HEADLESS) {
+            window_headless_free();
+            return;
+        }
         DestroyWindow(SF_WINDOW_WIN);
     }
 
-    bool window_update(window_t& window) {
+    bool window_update(window_t& window, int timeout_ms) {
+        if (window.backend == SF_WINDOW_BACKEND_HEADLESS) {
+            return window_headless_update(window);
+        }
+
         MSG msg = {};
-        if (GetMessage(&msg, nullptr, 0, 0) > 0) {
+        if (timeout_ms != 0 && !PeekMessage(&msg, nullptr, 0, 0, PM_NOREMOVE)) {
+            MsgWaitForMultipleObjects(0, nullptr, FALSE, timeout_ms < 0 ? INFINITE : static_cast<DWORD>(timeout_ms), QS_ALLINPUT);
+        }
+        // WM_MOUSEMOVE and WM_SIZE are already coalesced by the system
+        while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
+            if (msg.message == WM_QUIT) {
+                return false;
+            }
             TranslateMessage(&msg);
             DispatchMessage(&msg);
         }
         return IsWindow(SF_WINDOW_WIN);
     }
 
+    // native window is presented by GPU swapchain, it has no CPU framebuffer
+    framebuffer_t window_get_framebuffer(window_t& window) {
+        if (window.backend == SF_WINDOW_BACKEND_HEADLESS) {
+            return window_headless_get_framebuffer(s_headless.back);
+        }
+        return {};
+    }
+
+    void window_present(window_t& window) {
+        if (window.backend == SF_WINDOW_BACKEND_HEADLESS) {
+            window_headless_present();
+        }
+    }
+
     bool key_is_pressed(SF_KEYCODE keycode) {
         return GetAsyncKeyState(keycode) & 0b1;
     }
@@ -167,7 +757,15 @@ namespace sf {
 #include <X11/Xlib.h>
 #include <X11/Xos.h>
 #include <X11/Xutil.h>
+#include <X11/keysym.h>
 #include <X11/extensions/Xrandr.h>
+#include <X11/extensions/XInput2.h>
+#include <X11/extensions/XShm.h>
+
+#include <poll.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <time.h>
 
 namespace sf {
 
@@ -176,8 +774,189 @@ namespace sf {
     static Display* s_display = nullptr;
     static int s_screen;
     static GC s_context;
+    static Atom s_wm_delete_window;
+    static bool s_window_open = false;
+    static XConfigureEvent s_window_configure = {};
+    static bool s_window_focused = false;
+    // -1 when XInput2 isn't available, there is no raw motion then
+    static int s_xi_opcode = -1;
+    // raw deltas are accumulated in device units, fractions are carried to the next dispatch
+    static double s_raw_motion_x = 0;
+    static double s_raw_motion_y = 0;
+    static Time s_raw_motion_time = CurrentTime;
+
+    // busy framebuffer is still read by server, it's released by ShmCompletion event
+    struct x11_framebuffer_t final {
+        XImage* image = nullptr;
+        XShmSegmentInfo shm = {};
+        bool busy = false;
+    };
+
+    static x11_framebuffer_t s_framebuffers[SF_WINDOW_MAX_FRAMEBUFFERS];
+    static u32 s_framebuffer_count = 0;
+    static u32 s_framebuffer_back = 0;
+    static int s_framebuffer_front = -1;
+    // false when MIT-SHM isn't available, e.g. for remote display, then images are copied by XPutImage
+    static bool s_framebuffer_shm = false;
+    static int s_shm_completion = -1;
+    static u64 s_present_ns = 0;
+    static bool s_x11_error = false;
+
+    static int x11_error_handler(Display*, XErrorEvent*) {
+        s_x11_error = true;
+        return 0;
+    }
+
+    static void x11_framebuffers_free() {
+        if (s_framebuffer_shm && s_framebuffer_count > 0) {
+            for (u32 i = 0 ; i < s_framebuffer_count ; i++) {
+                XShmDetach(s_display, &s_framebuffers[i].shm);
+            }
+            // server has to detach segments before they are unmapped
+            XSync(s_display, False);
+        }
+
+        for (u32 i = 0 ; i < s_framebuffer_count ; i++) {
+            x11_framebuffer_t& framebuffer = s_framebuffers[i];
+            if (s_framebuffer_shm) {
+                shmdt(framebuffer.shm.shmaddr);
+            } else {
+                sf::free(framebuffer.image->data);
+            }
+            framebuffer.image->data = nullptr;
+            XDestroyImage(framebuffer.image);
+            framebuffer = {};
+        }
+
+        s_framebuffer_count = 0;
+        s_framebuffer_back = 0;
+        s_framebuffer_front = -1;
+    }
+
+    // attach error is reported asynchronously, so it's caught by temporary error handler after round trip
+    static bool x11_framebuffer_init_shm(x11_framebuffer_t& framebuffer, int w, int h) {
+        framebuffer.image = XShmCreateImage(s_display, DefaultVisual(s_display, s_screen), DefaultDepth(s_display, s_screen), ZPixmap, nullptr, &framebuffer.shm, w, h);
+        if (framebuffer.image == nullptr) {
+            return false;
+        }
+
+        framebuffer.shm.shmid = shmget(IPC_PRIVATE, usize(framebuffer.image->bytes_per_line) * usize(h), IPC_CREAT | 0600);
+        void* address = framebuffer.shm.shmid < 0 ? reinterpret_cast<void*>(-1) : shmat(framebuffer.shm.shmid, nullptr, 0);
+        bool attached = address != reinterpret_cast<void*>(-1);
+
+        if (attached) {
+            framebuffer.shm.shmaddr = framebuffer.image->data = static_cast<char*>(address);
+            framebuffer.shm.readOnly = False;
+            s_x11_error = false;
+            XErrorHandler error_handler = XSetErrorHandler(x11_error_handler);
+            attached = XShmAttach(s_display, &framebuffer.shm);
+            XSync(s_display, False);
+            XSetErrorHandler(error_handler);
+            attached &= !s_x11_error;
+        }
+
+        // segment is destroyed once both sides detach from it
+        if (framebuffer.shm.shmid >= 0) {
+            shmctl(framebuffer.shm.shmid, IPC_RMID, nullptr);
+        }
+
+        if (!attached) {
+            if (address != reinterpret_cast<void*>(-1)) {
+                shmdt(address);
+            }
+            framebuffer.image->data = nullptr;
+            XDestroyImage(framebuffer.image);
+            framebuffer = {};
+        }
+        return attached;
+    }
+
+    static void x11_framebuffers_init(u32 count, int w, int h) {
+        s_framebuffer_shm = XShmQueryExtension(s_display);
+        for (u32 i = 0 ; s_framebuffer_shm && i < count ; i++) {
+            if (!x11_framebuffer_init_shm(s_framebuffers[i], w, h)) {
+                s_framebuffer_count = i;
+                x11_framebuffers_free();
+                s_framebuffer_shm = false;
+            }
+        }
+
+        if (s_framebuffer_shm) {
+            s_shm_completion = XShmGetEventBase(s_display) + ShmCompletion;
+        } else {
+            for (u32 i = 0 ; i < count ; i++) {
+                char* data = static_cast<char*>(sf::malloc(usize(w) * usize(h) * sizeof(u32)));
+                s_framebuffers[i].image = XCreateImage(s_display, DefaultVisual(s_display, s_screen), DefaultDepth(s_display, s_screen), ZPixmap, 0, data, w, h, 32, 0);
+            }
+        }
+
+        s_framebuffer_count = count;
+        s_framebuffer_back = 0;
+        s_framebuffer_front = -1;
+    }
+
+    static void x11_handle_shm_completion(const XEvent& event) {
+        const XShmCompletionEvent& completion = reinterpret_cast<const XShmCompletionEvent&>(event);
+        for (u32 i = 0 ; i < s_framebuffer_count ; i++) {
+            if (s_framebuffers[i].shm.shmseg == completion.shmseg) {
+                s_framebuffers[i].busy = false;
+            }
+        }
+    }
+
+    static Bool x11_is_shm_completion(Display*, XEvent* event, XPointer) {
+        return event->type == s_shm_completion;
+    }
+
+    static void x11_framebuffer_put(window_t& window, x11_framebuffer_t& framebuffer, bool notify) {
+        XImage* image = framebuffer.image;
+        if (s_framebuffer_shm) {
+            XShmPutImage(s_display, SF_WINDOW_X11, s_context, image, 0, 0, 0, 0, image->width, image->height, notify);
+            framebuffer.busy |= notify;
+        } else {
+            XPutImage(s_display, SF_WINDOW_X11, s_context, image, 0, 0, 0, 0, image->width, image->height);
+        }
+    }
+
+    // last presented frame is put again, window is only cleared before the first present
+    static void x11_framebuffer_expose(window_t& window) {
+        if (s_framebuffer_front >= 0) {
+            x11_framebuffer_put(window, s_framebuffers[s_framebuffer_front], false);
+        } else {
+            XClearWindow(s_display, SF_WINDOW_X11);
+        }
+    }
+
+    // raw motion is selected on root window, because it isn't delivered to client windows
+    static void x11_select_raw_motion() {
+        int event_base;
+        int error_base;
+        if (!XQueryExtension(s_display, "XInputExtension", &s_xi_opcode, &event_base, &error_base)) {
+            s_xi_opcode = -1;
+            return;
+        }
+
+        int major = 2;
+        int minor = 0;
+        if (XIQueryVersion(s_display, &major, &minor) != Success) {
+            s_xi_opcode = -1;
+            return;
+        }
+
+        unsigned char mask_bits[XIMaskLen(XI_LASTEVENT)] = {};
+        XISetMask(mask_bits, XI_RawMotion);
+        XIEventMask mask;
+        mask.deviceid = XIAllMasterDevices;
+        mask.mask_len = sizeof(mask_bits);
+        mask.mask = mask_bits;
+        XISelectEvents(s_display, DefaultRootWindow(s_display), &mask, 1);
+    }
+
+    window_t window_init(const char *title, int x, int y, int w, int h, bool sync, SF_WINDOW_BACKEND backend) {
+        if (window_headless_requested(backend)) {
+            return window_headless_init(w, h);
+        }
 
-    window_t window_init(const char *title, int x, int y, int w, int h, bool sync) {
         window_t window;
 
         s_display = XOpenDisplay(nullptr);
@@ -217,10 +996,25 @@ namespace sf {
                 s_display,
                 SF_WINDOW_X11,
                 ExposureMask |
+                KeyPressMask |
+                KeyReleaseMask |
                 ButtonPressMask |
-                KeyPressMask
+                ButtonReleaseMask |
+                PointerMotionMask |
+                StructureNotifyMask |
+                FocusChangeMask
         );
 
+        x11_select_raw_motion();
+
+        s_wm_delete_window = XInternAtom(s_display, "WM_DELETE_WINDOW", False);
+        XSetWMProtocols(s_display, SF_WINDOW_X11, &s_wm_delete_window, 1);
+        s_window_open = true;
+        s_window_configure.x = x;
+        s_window_configure.y = y;
+        s_window_configure.width = w;
+        s_window_configure.height = h;
+
         s_context = XCreateGC(s_display, SF_WINDOW_X11, 0, 0);
 
         XSetBackground(s_display, s_context, white);
@@ -237,56 +1031,380 @@ namespace sf {
     }
 
     void window_free(const window_t &window) {
+        if (window.backend == SF_WINDOW_BACKEND_HEADLESS) {
+            window_headless_free();
+            return;
+        }
+        x11_framebuffers_free();
         XFreeGC(s_display, s_context);
         XDestroyWindow(s_display, SF_WINDOW_X11);
         XCloseDisplay(s_display);
     }
 
+    static SF_KEYCODE x11_keycode(const XKeyEvent& event) {
+        XKeyEvent key = event;
+        const KeySym keysym = XLookupKeysym(&key, 0);
+
+        if (keysym >= XK_a && keysym <= XK_z) {
+            return static_cast<SF_KEYCODE>(SF_KEYCODE_A + (keysym - XK_a));
+        }
+        if (keysym >= XK_0 && keysym <= XK_9) {
+            return static_cast<SF_KEYCODE>(SF_KEYCODE_D0 + (keysym - XK_0));
+        }
+        if (keysym >= XK_F1 && keysym <= XK_F25) {
+            return static_cast<SF_KEYCODE>(SF_KEYCODE_F1 + (keysym - XK_F1));
+        }
+        if (keysym >= XK_KP_0 && keysym <= XK_KP_9) {
+            return static_cast<SF_KEYCODE>(SF_KEYCODE_KP0 + (keysym - XK_KP_0));
+        }
+
+        switch (keysym) {
+            case XK_space: return SF_KEYCODE_SPACE;
+            case XK_apostrophe: return SF_KEYCODE_APOSTROPHE;
+            case XK_comma: return SF_KEYCODE_COMMA;
+            case XK_minus: return SF_KEYCODE_MINUS;
+            case XK_period: return SF_KEYCODE_PERIOD;
+            case XK_slash: return SF_KEYCODE_SLASH;
+            case XK_semicolon: return SF_KEYCODE_SEMICOLON;
+            case XK_equal: return SF_KEYCODE_EQUAL;
+            case XK_bracketleft: return SF_KEYCODE_LEFT_BRACKET;
+            case XK_backslash: return SF_KEYCODE_BACKSLASH;
+            case XK_bracketright: return SF_KEYCODE_RIGHT_BRACKET;
+            case XK_grave: return SF_KEYCODE_GRAVE_ACCENT;
+            case XK_Escape: return SF_KEYCODE_ESC;
+            case XK_Return: return SF_KEYCODE_ENTER;
+            case XK_Tab: return SF_KEYCODE_TAB;
+            case XK_BackSpace: return SF_KEYCODE_BACKSPACE;
+            case XK_Insert: return SF_KEYCODE_INSERT;
+            case XK_Delete: return SF_KEYCODE_DELETE;
+            case XK_Right: return SF_KEYCODE_RIGHT;
+            case XK_Left: return SF_KEYCODE_LEFT;
+            case XK_Down: return SF_KEYCODE_DOWN;
+            case XK_Up: return SF_KEYCODE_UP;
+            case XK_Page_Up: return SF_KEYCODE_PAGE_UP;
+            case XK_Page_Down: return SF_KEYCODE_PAGE_DOWN;
+            case XK_Home: return SF_KEYCODE_HOME;
+            case XK_End: return SF_KEYCODE_END;
+            case XK_Caps_Lock: return SF_KEYCODE_CAPS_LOCK;
+            case XK_Scroll_Lock: return SF_KEYCODE_SCROLL_LOCK;
+            case XK_Num_Lock: return SF_KEYCODE_NUM_LOCK;
+            case XK_Print: return SF_KEYCODE_PRINT_SCREEN;
+            case XK_Pause: return SF_KEYCODE_PAUSE;
+            case XK_KP_Decimal: return SF_KEYCODE_KP_DECIMAL;
+            case XK_KP_Divide: return SF_KEYCODE_KP_DIVIDE;
+            case XK_KP_Multiply: return SF_KEYCODE_KP_MULTIPLY;
+            case XK_KP_Subtract: return SF_KEYCODE_KP_SUBTRACT;
+            case XK_KP_Add: return SF_KEYCODE_KP_ADD;
+            case XK_KP_Enter: return SF_KEYCODE_KP_ENTER;
+            case XK_KP_Equal: return SF_KEYCODE_KP_EQUAL;
+            case XK_Shift_L: return SF_KEYCODE_LEFT_SHIFT;
+            case XK_Control_L: return SF_KEYCODE_LEFT_CTRL;
+            case XK_Alt_L: return SF_KEYCODE_LEFT_ALT;
+            case XK_Super_L: return SF_KEYCODE_LEFT_SUPER;
+            case XK_Shift_R: return SF_KEYCODE_RIGHT_SHIFT;
+            case XK_Control_R: return SF_KEYCODE_RIGHT_CTRL;
+            case XK_Alt_R: return SF_KEYCODE_RIGHT_ALT;
+            case XK_Super_R: return SF_KEYCODE_RIGHT_SUPER;
+            case XK_Menu: return SF_KEYCODE_MENU;
+            default: return SF_KEYCODE_NONE;
+        }
+    }
+
+    // buttons 4..7 are wheel and are not tracked as pressed
+    static SF_MOUSE_CODE x11_mouse_code(unsigned int button) {
+        switch (button) {
+            case Button1: return SF_MOUSE_CODE_BTN_LEFT;
+            case Button2: return SF_MOUSE_CODE_BTN_MIDDLE;
+            case Button3: return SF_MOUSE_CODE_BTN_RIGHT;
+            case 8: return SF_MOUSE_CODE_BTN3;
+            case 9: return SF_MOUSE_CODE_BTN4;
+            default: return SF_MOUSE_CODE_NONE;
+        }
+    }
+
+    // monotonic time when the current batch of events was read
+    static u64 s_receive_ns = 0;
+    static i64 s_server_time_offset_ns = 0;
+    static Time s_last_server_time = 0;
+
+    /**
+     * Offset between X server time and monotonic clock is estimated by the smallest difference seen so far,
+     * which belongs to the event delivered with the least delay. It's reset when server time goes back after wrap.
+     */
+    static input_event_t x11_input_event(SF_INPUT_EVENT type, u16 code, Time time, int x, int y) {
+        input_event_t event;
+        event.type = type;
+        event.code = code;
+        event.x = x;
+        event.y = y;
+        event.receive_ns = s_receive_ns;
+        event.time_ns = s_receive_ns;
+        event.server_time_ms = static_cast<u32>(time);
+
+        if (time != CurrentTime) {
+            const i64 server_ns = static_cast<i64>(time) * 1000000;
+            const i64 offset_ns = static_cast<i64>(s_receive_ns) - server_ns;
+            if (s_last_server_time == 0 || time < s_last_server_time || offset_ns < s_server_time_offset_ns) {
+                s_server_time_offset_ns = offset_ns;
+            }
+            s_last_server_time = time;
+            event.time_ns = std::min(static_cast<u64>(server_ns + s_server_time_offset_ns), s_receive_ns);
+        }
+
+        return event;
+    }
+
     static void handle_event(window_t& window, const XEvent& event) {
-        window_t::desktop_events_t& events = window.desktop_events;
         switch (event.type) {
             case Expose: {
                 if (event.xexpose.count == 0) {
-                    XClearWindow(s_display, SF_WINDOW_X11);
+                    x11_framebuffer_expose(window);
                 }
                 break;
             }
-            case KeyPress: {
-                events.event_key_press(static_cast<SF_KEYCODE>(event.xkey.keycode));
+            case KeyPress:
+            case KeyRelease: {
+                const SF_KEYCODE keycode = x11_keycode(event.xkey);
+                if (keycode != SF_KEYCODE_NONE) {
+                    const SF_INPUT_EVENT type = event.type == KeyPress ? SF_INPUT_EVENT_KEY_PRESS : SF_INPUT_EVENT_KEY_RELEASE;
+                    input_dispatch(window, x11_input_event(type, keycode, event.xkey.time, event.xkey.x, event.xkey.y));
+                }
                 break;
             }
-            case KeyRelease: {
-                events.event_key_release(static_cast<SF_KEYCODE>(event.xkey.keycode));
+            case ButtonPress:
+            case ButtonRelease: {
+                const SF_MOUSE_CODE mouse_code = x11_mouse_code(event.xbutton.button);
+                if (mouse_code != SF_MOUSE_CODE_NONE) {
+                    const SF_INPUT_EVENT type = event.type == ButtonPress ? SF_INPUT_EVENT_MOUSE_PRESS : SF_INPUT_EVENT_MOUSE_RELEASE;
+                    input_dispatch(window, x11_input_event(type, mouse_code, event.xbutton.time, event.xbutton.x, event.xbutton.y));
+                }
                 break;
             }
-            case ButtonPress: {
-                events.event_mouse_press(static_cast<SF_MOUSE_CODE>(event.xbutton.button));
+            case MotionNotify: {
+                input_dispatch(window, x11_input_event(SF_INPUT_EVENT_CURSOR_MOVE, 0, event.xmotion.time, event.xmotion.x, event.xmotion.y));
                 break;
             }
-            case ButtonRelease: {
-                events.event_mouse_release(static_cast<SF_MOUSE_CODE>(event.xbutton.button));
+            case ConfigureNotify: {
+                const XConfigureEvent& configure = event.xconfigure;
+                if (configure.x != s_window_configure.x || configure.y != s_window_configure.y) {
+                    input_dispatch(window, x11_input_event(SF_INPUT_EVENT_WINDOW_MOVE, 0, CurrentTime, configure.x, configure.y));
+                }
+                if (configure.width != s_window_configure.width || configure.height != s_window_configure.height) {
+                    input_dispatch(window, x11_input_event(SF_INPUT_EVENT_WINDOW_RESIZE, 0, CurrentTime, configure.width, configure.height));
+                }
+                s_window_configure = configure;
+                break;
+            }
+            case ClientMessage: {
+                if (static_cast<Atom>(event.xclient.data.l[0]) == s_wm_delete_window) {
+                    s_window_open = false;
+                }
+                break;
+            }
+            case DestroyNotify: {
+                s_window_open = false;
+                break;
+            }
+            case FocusIn: {
+                s_window_focused = true;
                 break;
             }
+            case FocusOut: {
+                s_window_focused = false;
+                break;
+            }
+        }
+    }
+
+    static void x11_flush_raw_motion(window_t& window) {
+        const int dx = static_cast<int>(s_raw_motion_x);
+        const int dy = static_cast<int>(s_raw_motion_y);
+        if (dx == 0 && dy == 0) {
+            return;
+        }
+        s_raw_motion_x -= dx;
+        s_raw_motion_y -= dy;
+        input_dispatch(window, x11_input_event(SF_INPUT_EVENT_RAW_MOTION, 0, s_raw_motion_time, dx, dy));
+    }
+
+    // raw motion goes to root window from every client, so it's only taken while our window has focus
+    static void x11_handle_generic_event(window_t& window, XEvent& event) {
+        XGenericEventCookie& cookie = event.xcookie;
+        if (cookie.extension != s_xi_opcode || !XGetEventData(s_display, &cookie)) {
+            return;
+        }
+
+        if (cookie.evtype == XI_RawMotion && s_window_focused) {
+            const XIRawEvent* raw = static_cast<const XIRawEvent*>(cookie.data);
+            const double* values = raw->raw_values;
+            if (XIMaskIsSet(raw->valuators.mask, 0)) {
+                s_raw_motion_x += *values++;
+            }
+            if (XIMaskIsSet(raw->valuators.mask, 1)) {
+                s_raw_motion_y += *values;
+            }
+            s_raw_motion_time = raw->time;
+            if (window.motion_policy == SF_INPUT_MOTION_ALL) {
+                x11_flush_raw_motion(window);
+            }
+        }
+
+        XFreeEventData(s_display, &cookie);
+    }
+
+    // waits for X connection to become readable, events already read into Xlib queue don't touch the socket
+    static void window_wait(int timeout_ms) {
+        if (XPending(s_display) > 0) {
+            return;
         }
+        pollfd fd = {};
+        fd.fd = ConnectionNumber(s_display);
+        fd.events = POLLIN;
+        poll(&fd, 1, timeout_ms);
     }
 
-    bool window_update(window_t &window) {
+    /**
+     * Only the number of events queued at the start is processed, events arriving meanwhile are left for the next frame,
+     * so a flood of motion can't keep the loop here. With SF_INPUT_MOTION_LATEST motion is held back
+     * and reported before any other event, so buttons and keys still see the cursor where it was when they happened.
+     */
+    bool window_update(window_t& window, int timeout_ms) {
+        if (window.backend == SF_WINDOW_BACKEND_HEADLESS) {
+            return window_headless_update(window);
+        }
+
+        if (timeout_ms != 0) {
+            window_wait(timeout_ms);
+        }
+
         XEvent event;
-        bool updated = XNextEvent(s_display, &event) == 0;
-        handle_event(window, event);
-        return updated;
+        XEvent motion;
+        XEvent configure;
+        bool has_motion = false;
+        bool has_configure = false;
+        const bool coalesce_motion = window.motion_policy == SF_INPUT_MOTION_LATEST;
+
+        int count = XEventsQueued(s_display, QueuedAfterFlush);
+        s_receive_ns = time_get_monotonic_ns();
+        for (; count > 0 ; count--) {
+            XNextEvent(s_display, &event);
+            if (event.type == GenericEvent) {
+                x11_handle_generic_event(window, event);
+                continue;
+            }
+            if (event.type == s_shm_completion) {
+                x11_handle_shm_completion(event);
+                continue;
+            }
+            if (event.type == MotionNotify && coalesce_motion) {
+                motion = event;
+                has_motion = true;
+                continue;
+            }
+            if (event.type == ConfigureNotify) {
+                configure = event;
+                has_configure = true;
+                continue;
+            }
+            x11_flush_raw_motion(window);
+            if (has_motion) {
+                handle_event(window, motion);
+                has_motion = false;
+            }
+            handle_event(window, event);
+        }
+
+        x11_flush_raw_motion(window);
+        if (has_motion) {
+            handle_event(window, motion);
+        }
+        if (has_configure) {
+            handle_event(window, configure);
+        }
+        input_publish();
+        return s_window_open;
+    }
+
+    /**
+     * Framebuffers are created on first use and recreated when window size changes.
+     * Back buffer, which is still read by server, is waited for, so with triple buffering CPU rarely stalls.
+     */
+    framebuffer_t window_get_framebuffer(window_t& window) {
+        if (window.backend == SF_WINDOW_BACKEND_HEADLESS) {
+            return window_headless_get_framebuffer(s_headless.back);
+        }
+
+        const int w = std::max(s_window_configure.width, 1);
+        const int h = std::max(s_window_configure.height, 1);
+        const u32 count = std::min(std::max(window.framebuffer_count, 1u), u32(SF_WINDOW_MAX_FRAMEBUFFERS));
+        if (s_framebuffer_count != count || s_framebuffers[0].image->width != w || s_framebuffers[0].image->height != h) {
+            x11_framebuffers_free();
+            x11_framebuffers_init(count, w, h);
+        }
+
+        x11_framebuffer_t& back = s_framebuffers[s_framebuffer_back];
+        while (back.busy) {
+            XEvent event;
+            XIfEvent(s_display, &event, x11_is_shm_completion, nullptr);
+            x11_handle_shm_completion(event);
+        }
+
+        framebuffer_t framebuffer;
+        framebuffer.pixels = reinterpret_cast<u32*>(back.image->data);
+        framebuffer.width = w;
+        framebuffer.height = h;
+        framebuffer.stride = back.image->bytes_per_line / static_cast<int>(sizeof(u32));
+        return framebuffer;
+    }
+
+    /**
+     * Core X11 has no vblank notification, so with vsync presents are paced by refresh rate of the screen.
+     * Pacing keeps its own schedule, a late frame moves it, instead of making next frames hurry.
+     */
+    void window_present(window_t& window) {
+        if (window.backend == SF_WINDOW_BACKEND_HEADLESS) {
+            window_headless_present();
+            return;
+        }
+        if (s_framebuffer_count == 0) {
+            return;
+        }
+
+        u64 now_ns = time_get_monotonic_ns();
+        if (window.vsync && window.refresh_rate > 0) {
+            const u64 target_ns = s_present_ns + 1000000000ull / window.refresh_rate;
+            if (now_ns < target_ns) {
+                const u64 wait_ns = target_ns - now_ns;
+                timespec wait = {};
+                wait.tv_sec = static_cast<decltype(wait.tv_sec)>(wait_ns / 1000000000ull);
+                wait.tv_nsec = static_cast<decltype(wait.tv_nsec)>(wait_ns % 1000000000ull);
+                nanosleep(&wait, nullptr);
+                now_ns = target_ns;
+            }
+        }
+
+        x11_framebuffer_put(window, s_framebuffers[s_framebuffer_back], true);
+        XFlush(s_display);
+        s_framebuffer_front = static_cast<int>(s_framebuffer_back);
+        s_framebuffer_back = (s_framebuffer_back + 1) % s_framebuffer_count;
+        s_present_ns = now_ns;
+        input_present(now_ns);
     }
 
     bool key_is_pressed(SF_KEYCODE keycode) {
+        return input_key_is_pressed(input_get_state(), keycode);
     }
 
     bool mouse_is_pressed(SF_MOUSE_CODE mouse_code) {
+        return input_mouse_is_pressed(input_get_state(), mouse_code);
     }
 
     bool gamepad_is_pressed(SF_GAMEPAD_CODE gamepad_code) {
+        return input_gamepad_is_pressed(input_get_state(), gamepad_code);
     }
 
     cursor_t cursor_get() {
+        return input_get_state().cursor;
     }
 
 }
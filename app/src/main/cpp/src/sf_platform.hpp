@@ -199,6 +199,56 @@ enum SF_GAMEPAD_AXIS
     SF_GAMEPAD_AXIS_LAST = SF_GAMEPAD_AXIS_RIGHT_TRIGGER
 };
 
+enum SF_INPUT_EVENT
+{
+    SF_INPUT_EVENT_NONE = 0,
+    SF_INPUT_EVENT_KEY_PRESS = 1,
+    SF_INPUT_EVENT_KEY_RELEASE = 2,
+    SF_INPUT_EVENT_MOUSE_PRESS = 3,
+    SF_INPUT_EVENT_MOUSE_RELEASE = 4,
+    SF_INPUT_EVENT_GAMEPAD_PRESS = 5,
+    SF_INPUT_EVENT_GAMEPAD_RELEASE = 6,
+    SF_INPUT_EVENT_CURSOR_MOVE = 7,
+    SF_INPUT_EVENT_WINDOW_RESIZE = 8,
+    SF_INPUT_EVENT_WINDOW_MOVE = 9,
+    // unaccelerated relative motion of pointing device, x and y are deltas in device units
+    SF_INPUT_EVENT_RAW_MOTION = 10,
+};
+
+// how cursor and raw motion samples are delivered within one window_update()
+enum SF_INPUT_MOTION
+{
+    // every sample is dispatched, e.g. for drawing strokes
+    SF_INPUT_MOTION_ALL = 0,
+    // latest cursor position and sum of raw deltas are dispatched once per update
+    SF_INPUT_MOTION_LATEST = 1,
+};
+
+// must be power of two
+#define SF_INPUT_EVENT_QUEUE_SIZE 1024
+
+enum SF_WINDOW_BACKEND
+{
+    // X11 or Win32 window, falls back to headless when SF_HEADLESS environment variable is set
+    SF_WINDOW_BACKEND_NATIVE = 0,
+    // no display, input comes from a script of events and frames go to memory
+    SF_WINDOW_BACKEND_HEADLESS = 1,
+};
+
+// SF_HEADLESS build flag makes headless backend the default one
+#if defined(SF_HEADLESS)
+#define SF_WINDOW_BACKEND_DEFAULT SF_WINDOW_BACKEND_HEADLESS
+#else
+#define SF_WINDOW_BACKEND_DEFAULT SF_WINDOW_BACKEND_NATIVE
+#endif
+
+#define SF_WINDOW_HEADLESS_FRAME_NS (1000000000ull / 60)
+#define SF_WINDOW_MAX_FRAMEBUFFERS 3
+
+// "SFIR" in little endian
+#define SF_INPUT_RECORD_MAGIC 0x52494653
+#define SF_INPUT_RECORD_VERSION 1
+
 namespace sf {
 
     typedef void (*event_window_resize_t)(int w, int h);
@@ -211,23 +261,34 @@ namespace sf {
     typedef void (*event_gamepad_release_t)(SF_GAMEPAD_CODE gamepad_code);
     typedef void (*event_cursor_move_t)(double x, double y);
     typedef void (*event_touch_move_t)(double x, double y);
+    typedef void (*event_mouse_raw_move_t)(double dx, double dy);
+
+    // 32-bit pixels in SF_RGB() layout, stride is in pixels
+    struct SF_API framebuffer_t final {
+        u32* pixels = nullptr;
+        int width = 0;
+        int height = 0;
+        int stride = 0;
+    };
 
     struct SF_API window_t final {
 
         struct SF_API desktop_events_t final {
-            event_window_resize_t event_window_resize;
-            event_window_move_t event_window_move;
-            event_key_press_t event_key_press;
-            event_key_release_t event_key_release;
-            event_mouse_press_t event_mouse_press;
-            event_mouse_release_t event_mouse_release;
-            event_gamepad_press_t event_gamepad_press;
-            event_gamepad_release_t event_gamepad_release;
-            event_cursor_move_t event_on_cursor_move;
+            event_window_resize_t event_window_resize = nullptr;
+            event_window_move_t event_window_move = nullptr;
+            event_key_press_t event_key_press = nullptr;
+            event_key_release_t event_key_release = nullptr;
+            event_mouse_press_t event_mouse_press = nullptr;
+            event_mouse_release_t event_mouse_release = nullptr;
+            event_gamepad_press_t event_gamepad_press = nullptr;
+            event_gamepad_release_t event_gamepad_release = nullptr;
+            event_cursor_move_t event_on_cursor_move = nullptr;
+            // high rate deltas without pointer acceleration, suitable for camera look and pan
+            event_mouse_raw_move_t event_on_mouse_raw_move = nullptr;
         };
 
         struct SF_API phone_events_t final {
-            event_touch_move_t event_on_touch_move;
+            event_touch_move_t event_on_touch_move = nullptr;
         };
 
         desktop_events_t desktop_events;
@@ -235,12 +296,28 @@ namespace sf {
 
         void* handle;
         u32 refresh_rate;
+        SF_INPUT_MOTION motion_policy = SF_INPUT_MOTION_LATEST;
+        SF_WINDOW_BACKEND backend = SF_WINDOW_BACKEND_NATIVE;
+        // CPU framebuffers of native window, 2 for double or 3 for triple buffering, read on first window_get_framebuffer()
+        u32 framebuffer_count = 2;
+        // window_present() waits for the next refresh interval
+        bool vsync = true;
 
     };
 
-    SF_API window_t window_init(const char* title, int x, int y, int w, int h, bool sync);
+    SF_API window_t window_init(const char* title, int x, int y, int w, int h, bool sync, SF_WINDOW_BACKEND backend = SF_WINDOW_BACKEND_DEFAULT);
     SF_API void window_free(const window_t& window);
-    SF_API bool window_update(window_t& window);
+    /**
+     * Dispatches all events, which are pending at the moment of call, and never blocks by default.
+     * Cursor motion and resize are coalesced, only the latest of them is reported.
+     * timeout_ms > 0 waits up to that time for the first event when there is none, -1 waits without limit.
+     * Returns false when window was closed.
+     */
+    SF_API bool window_update(window_t& window, int timeout_ms = 0);
+    // back buffer to render the next frame into, it's valid until window_present()
+    SF_API framebuffer_t window_get_framebuffer(window_t& window);
+    SF_API void window_present(window_t& window);
+
 
     SF_API bool key_is_pressed(SF_KEYCODE keycode);
     SF_API bool mouse_is_pressed(SF_MOUSE_CODE mouse_code);
@@ -252,4 +329,126 @@ namespace sf {
 
     SF_API cursor_t cursor_get();
 
-}
\ No newline at end of file
+    #define SF_INPUT_KEY_WORDS ((SF_KEYCODE_MENU + 64) / 64)
+    #define SF_INPUT_GAMEPAD_AXIS_COUNT (SF_GAMEPAD_AXIS_LAST + 1)
+
+    // bits are indexed by SF_KEYCODE, SF_MOUSE_CODE and SF_GAMEPAD_CODE
+    struct SF_API input_state_t final {
+        u64 keys[SF_INPUT_KEY_WORDS] = {};
+        u32 mouse_buttons = 0;
+        u32 gamepad_buttons = 0;
+        float gamepad_axes[SF_INPUT_GAMEPAD_AXIS_COUNT] = {};
+        cursor_t cursor = { 0, 0 };
+        // sum of all raw motion deltas, difference of two snapshots is the motion between them
+        int raw_motion_x = 0;
+        int raw_motion_y = 0;
+        // incremented by every input_publish()
+        u64 version = 0;
+    };
+
+    /**
+     * Platform event handler is the only writer, it changes its own copy of input state and publishes it once per window_update().
+     * Published state is double buffered behind a sequence counter, so any thread reads a consistent snapshot
+     * without locks or round trips to the window system, reader only retries if it was preempted for a whole publish.
+     */
+    SF_API void input_set_key(SF_KEYCODE keycode, bool pressed);
+    SF_API void input_set_mouse(SF_MOUSE_CODE mouse_code, bool pressed);
+    SF_API void input_set_gamepad(SF_GAMEPAD_CODE gamepad_code, bool pressed);
+    SF_API void input_set_gamepad_axis(SF_GAMEPAD_AXIS axis, float value);
+    SF_API void input_set_cursor(int x, int y);
+    SF_API void input_add_raw_motion(int dx, int dy);
+    SF_API void input_publish();
+    SF_API input_state_t input_get_state();
+
+    struct SF_API input_event_t final {
+        // monotonic time when event happened, derived from window system time, if there is one
+        u64 time_ns = 0;
+        // monotonic time when event was read from window system
+        u64 receive_ns = 0;
+        // window system time in ms, 0 when unknown
+        u32 server_time_ms = 0;
+        u16 type = SF_INPUT_EVENT_NONE;
+        // keycode, mouse or gamepad code
+        u16 code = 0;
+        // cursor position, window size or position
+        int x = 0;
+        int y = 0;
+    };
+
+    struct SF_API input_latency_t final {
+        // time from the oldest event consumed in a frame to present of this frame
+        u64 last_ns = 0;
+        u64 average_ns = 0;
+        u64 max_ns = 0;
+        u64 frame_count = 0;
+    };
+
+    /**
+     * Common path of every platform event: updates input state, queues event and calls window callbacks.
+     * Queue is a single producer, single consumer ring, events are dropped when it's full.
+     * Consumer pops events up to the end time of every fixed step and reports presents of frames from the same thread.
+     */
+    SF_API void input_dispatch(window_t& window, const input_event_t& event);
+    SF_API bool input_push_event(const input_event_t& event);
+    // pops the next event, which happened before until_ns, in the order of arrival
+    SF_API bool input_pop_event(input_event_t& event, u64 until_ns);
+    SF_API u32 input_get_dropped_event_count();
+    SF_API void input_present(u64 present_ns);
+    SF_API input_latency_t input_get_latency();
+
+    // many queries of the same frame should go to one snapshot from input_get_state()
+    inline bool input_key_is_pressed(const input_state_t& state, SF_KEYCODE keycode) {
+        return keycode > SF_KEYCODE_NONE && keycode <= SF_KEYCODE_MENU && (state.keys[keycode / 64] >> (keycode % 64) & 1) != 0;
+    }
+
+    inline bool input_mouse_is_pressed(const input_state_t& state, SF_MOUSE_CODE mouse_code) {
+        return mouse_code <= SF_MOUSE_CODE_BTN_LAST && (state.mouse_buttons >> mouse_code & 1) != 0;
+    }
+
+    inline bool input_gamepad_is_pressed(const input_state_t& state, SF_GAMEPAD_CODE gamepad_code) {
+        return gamepad_code <= SF_GAMEPAD_CODE_PAD_LAST && (state.gamepad_buttons >> gamepad_code & 1) != 0;
+    }
+
+    /**
+     * Headless window runs on a virtual clock, which advances by frame_ns every window_update(),
+     * so frame count and input timing are the same on every run and machine.
+     * Script events are dispatched once the clock reaches their time_ns, which is counted from window_init().
+     * Events must be sorted by time and stay alive until they are dispatched.
+     */
+    SF_API void window_headless_set_input(const input_event_t* events, u32 count);
+    // window_update() returns false after frame_limit updates, 0 runs until window is closed
+    SF_API void window_headless_set_frames(u64 frame_limit, u64 frame_ns = SF_WINDOW_HEADLESS_FRAME_NS);
+    SF_API u64 window_headless_get_time_ns();
+    SF_API u64 window_headless_get_frame_count();
+    // last presented frame
+    SF_API framebuffer_t window_headless_get_frame();
+
+    /**
+     * Recording captures every event passing input_dispatch(), including window resize and move,
+     * it's encoded in memory as varint deltas and written to file only by input_record_end().
+     * Times are stored relative to start_ns, it's taken from the clock of events:
+     * time_get_monotonic_ns() for native window, window_headless_get_time_ns() for headless one.
+     */
+    SF_API void input_record_begin(u64 start_ns);
+    // returns false when file can't be written
+    SF_API bool input_record_end(const char* filepath);
+
+    struct SF_API input_replay_t final {
+        input_event_t* events = nullptr;
+        u32 count = 0;
+        u32 index = 0;
+        // clock time of the first input_replay_update(), recorded times are shifted by it
+        u64 start_ns = 0;
+        bool started = false;
+    };
+
+    // returns false for missing file, other version or payload, which doesn't decode into exactly event count of header
+    SF_API bool input_replay_load(input_replay_t& replay, const char* filepath);
+    SF_API void input_replay_free(input_replay_t& replay);
+    /**
+     * Dispatches recorded events, which are due by now_ns, through input_dispatch() as if they came from the window system.
+     * For reproducible runs events may be given to headless window instead with window_headless_set_input().
+     */
+    SF_API void input_replay_update(input_replay_t& replay, window_t& window, u64 now_ns);
+
+}
@@ -0,0 +1,350 @@
+#include <sf_raster.hpp>
+
+namespace sf {
+
+    static_assert(SF_RASTER_TILE_SIZE % SF_RASTER_BLOCK_SIZE == 0, "raster tile must consist of whole blocks!");
+    static_assert(SF_RASTER_BLOCK_SIZE == 8, "raster block is rasterized as 8 rows of two simd4f_t!");
+
+    raster_t raster_init(u32 width, u32 height, u32 triangle_capacity) {
+        SF_ASSERT(width > 0 && height > 0, "raster_init(): size must be positive!");
+
+        raster_t raster;
+        raster.width = width;
+        raster.height = height;
+        raster.stride = (width + SF_RASTER_BLOCK_SIZE - 1) / SF_RASTER_BLOCK_SIZE * SF_RASTER_BLOCK_SIZE;
+        raster.hiz_stride = raster.stride / SF_RASTER_BLOCK_SIZE;
+        raster.tile_count_x = (width + SF_RASTER_TILE_SIZE - 1) / SF_RASTER_TILE_SIZE;
+        raster.tile_count_y = (height + SF_RASTER_TILE_SIZE - 1) / SF_RASTER_TILE_SIZE;
+
+        const u32 padded_height = (height + SF_RASTER_BLOCK_SIZE - 1) / SF_RASTER_BLOCK_SIZE * SF_RASTER_BLOCK_SIZE;
+        raster.depth = malloc_t<float>(usize(raster.stride) * padded_height);
+        raster.hiz = malloc_t<float>(usize(raster.hiz_stride) * (padded_height / SF_RASTER_BLOCK_SIZE));
+        raster.triangles = malloc_t<raster_triangle_t>(triangle_capacity);
+        raster.triangle_capacity = triangle_capacity;
+        raster.tile_offsets = malloc_t<u32>(raster.tile_count_x * raster.tile_count_y + 1);
+        raster_clear(raster);
+        return raster;
+    }
+
+    void raster_free(raster_t& raster) {
+        sf::free(raster.depth);
+        sf::free(raster.hiz);
+        sf::free(raster.triangles);
+        sf::free(raster.tile_offsets);
+        sf::free(raster.tile_triangles);
+        raster = {};
+    }
+
+    void raster_set_color(raster_t& raster, u32* color, u32 color_stride) {
+        raster.color = color;
+        raster.color_stride = color_stride;
+    }
+
+    void raster_clear(raster_t& raster, u32 color) {
+        const u32 padded_height = (raster.height + SF_RASTER_BLOCK_SIZE - 1) / SF_RASTER_BLOCK_SIZE * SF_RASTER_BLOCK_SIZE;
+        std::fill(raster.depth, raster.depth + usize(raster.stride) * padded_height, 1.0f);
+        std::fill(raster.hiz, raster.hiz + usize(raster.hiz_stride) * (padded_height / SF_RASTER_BLOCK_SIZE), 1.0f);
+        raster.triangle_count = 0;
+        raster.dropped_count = 0;
+
+        if (raster.color != nullptr) {
+            for (u32 y = 0 ; y < raster.height ; y++) {
+                u32* row = raster.color + usize(y) * raster.color_stride;
+                std::fill(row, row + raster.width, color);
+            }
+        }
+    }
+
+    static float4_t raster_transform(const float3_t& p, const float4x4_t& m) {
+        return {
+                p.x * m[0][0] + p.y * m[1][0] + p.z * m[2][0] + m[3][0],
+                p.x * m[0][1] + p.y * m[1][1] + p.z * m[2][1] + m[3][1],
+                p.x * m[0][2] + p.y * m[1][2] + p.z * m[2][2] + m[3][2],
+                p.x * m[0][3] + p.y * m[1][3] + p.z * m[2][3] + m[3][3]
+        };
+    }
+
+    // whole triangle is outside of one of left, right, bottom, top or far planes
+    static bool raster_outside(const float4_t* v) {
+        return (v[0].x < -v[0].w && v[1].x < -v[1].w && v[2].x < -v[2].w)
+            || (v[0].x > v[0].w && v[1].x > v[1].w && v[2].x > v[2].w)
+            || (v[0].y < -v[0].w && v[1].y < -v[1].w && v[2].y < -v[2].w)
+            || (v[0].y > v[0].w && v[1].y > v[1].w && v[2].y > v[2].w)
+            || (v[0].z > v[0].w && v[1].z > v[1].w && v[2].z > v[2].w);
+    }
+
+    // Sutherland-Hodgman against z >= 0, triangle becomes polygon with up to 4 vertices
+    static u32 raster_clip_near(const float4_t* in, float4_t* out) {
+        u32 count = 0;
+        for (u32 i = 0 ; i < 3 ; i++) {
+            const float4_t& a = in[i];
+            const float4_t& b = in[(i + 1) % 3];
+            if (a.z >= 0) {
+                out[count++] = a;
+            }
+            if ((a.z >= 0) != (b.z >= 0)) {
+                const float t = a.z / (a.z - b.z);
+                out[count++] = a + (b - a) * t;
+            }
+        }
+        return count;
+    }
+
+    static float3_t raster_viewport(const raster_t& raster, const float4_t& clip) {
+        const float inv_w = 1.0f / clip.w;
+        return {
+                (clip.x * inv_w * 0.5f + 0.5f) * float(raster.width),
+                (clip.y * inv_w * 0.5f + 0.5f) * float(raster.height),
+                clip.z * inv_w
+        };
+    }
+
+    static void raster_setup_edge(raster_triangle_t& t, u32 i, const float3_t& p0, const float3_t& p1) {
+        const float a = p0.y - p1.y;
+        const float b = p1.x - p0.x;
+        t.edge_a[i] = a;
+        t.edge_b[i] = b;
+        t.edge_c[i] = -(a * p0.x + b * p0.y);
+        // left edges have inside to the right, top edges have inside below, pixels exactly on them are covered
+        const bool top_left = a > 0 || (a == 0 && b > 0);
+        t.edge_bias[i] = top_left ? -std::numeric_limits<float>::min() : 0.0f;
+    }
+
+    static bool raster_setup(raster_t& raster, float3_t p0, float3_t p1, float3_t p2, u32 color) {
+        float area = (p1.x - p0.x) * (p2.y - p0.y) - (p1.y - p0.y) * (p2.x - p0.x);
+        if (!(std::abs(area) > 0) || !std::isfinite(area)) {
+            return false;
+        }
+        if (area < 0) {
+            std::swap(p1, p2);
+            area = -area;
+        }
+
+        const float min_x = std::max(std::min(std::min(p0.x, p1.x), p2.x), 0.0f);
+        const float min_y = std::max(std::min(std::min(p0.y, p1.y), p2.y), 0.0f);
+        const float max_x = std::min(std::max(std::max(p0.x, p1.x), p2.x), float(raster.width));
+        const float max_y = std::min(std::max(std::max(p0.y, p1.y), p2.y), float(raster.height));
+        if (min_x >= max_x || min_y >= max_y) {
+            return false;
+        }
+
+        if (raster.triangle_count >= raster.triangle_capacity) {
+            raster.dropped_count++;
+            return false;
+        }
+        raster_triangle_t& t = raster.triangles[raster.triangle_count++];
+        raster_setup_edge(t, 0, p0, p1);
+        raster_setup_edge(t, 1, p1, p2);
+        raster_setup_edge(t, 2, p2, p0);
+
+        const float inv_area = 1.0f / area;
+        const float dz1 = p1.z - p0.z;
+        const float dz2 = p2.z - p0.z;
+        t.depth_a = (dz1 * (p2.y - p0.y) - (p1.y - p0.y) * dz2) * inv_area;
+        t.depth_b = ((p1.x - p0.x) * dz2 - dz1 * (p2.x - p0.x)) * inv_area;
+        t.depth_c = p0.z - t.depth_a * p0.x - t.depth_b * p0.y;
+        t.depth_min = std::min(std::min(p0.z, p1.z), p2.z);
+
+        t.min_x = int(std::floor(min_x));
+        t.min_y = int(std::floor(min_y));
+        t.max_x = int(std::ceil(max_x));
+        t.max_y = int(std::ceil(max_y));
+        t.color = color;
+        return true;
+    }
+
+    u32 raster_submit(raster_t& raster, const float4x4_t& model_view_projection, const float3_t* positions, const u32* indices, u32 index_count, u32 color) {
+        u32 stored = 0;
+        for (u32 i = 0 ; i + 2 < index_count ; i += 3) {
+            const float4_t clip[3] = {
+                    raster_transform(positions[indices[i]], model_view_projection),
+                    raster_transform(positions[indices[i + 1]], model_view_projection),
+                    raster_transform(positions[indices[i + 2]], model_view_projection)
+            };
+            if (raster_outside(clip)) {
+                continue;
+            }
+
+            float4_t polygon[4];
+            const u32 count = raster_clip_near(clip, polygon);
+            if (count < 3) {
+                continue;
+            }
+
+            const float3_t p0 = raster_viewport(raster, polygon[0]);
+            float3_t p1 = raster_viewport(raster, polygon[1]);
+            for (u32 j = 2 ; j < count ; j++) {
+                const float3_t p2 = raster_viewport(raster, polygon[j]);
+                stored += raster_setup(raster, p0, p1, p2, color) ? 1 : 0;
+                p1 = p2;
+            }
+        }
+        return stored;
+    }
+
+    template<typename F>
+    static void raster_visit_tiles(const raster_t& raster, const raster_triangle_t& t, const F& function) {
+        const u32 tile_x0 = u32(t.min_x) / SF_RASTER_TILE_SIZE;
+        const u32 tile_y0 = u32(t.min_y) / SF_RASTER_TILE_SIZE;
+        const u32 tile_x1 = u32(t.max_x - 1) / SF_RASTER_TILE_SIZE;
+        const u32 tile_y1 = u32(t.max_y - 1) / SF_RASTER_TILE_SIZE;
+        for (u32 y = tile_y0 ; y <= tile_y1 ; y++) {
+            for (u32 x = tile_x0 ; x <= tile_x1 ; x++) {
+                function(y * raster.tile_count_x + x);
+            }
+        }
+    }
+
+    // counts triangles per tile, turns counts into offsets and fills the lists in submit order
+    void raster_bin(raster_t& raster) {
+        const u32 tile_count = raster.tile_count_x * raster.tile_count_y;
+        u32* offsets = raster.tile_offsets;
+        std::fill(offsets, offsets + tile_count + 1, 0u);
+
+        for (u32 i = 0 ; i < raster.triangle_count ; i++) {
+            raster_visit_tiles(raster, raster.triangles[i], [&](u32 tile) {
+                offsets[tile + 1]++;
+            });
+        }
+
+        for (u32 tile = 0 ; tile < tile_count ; tile++) {
+            offsets[tile + 1] += offsets[tile];
+        }
+
+        if (offsets[tile_count] > raster.tile_triangle_capacity) {
+            sf::free(raster.tile_triangles);
+            raster.tile_triangle_capacity = offsets[tile_count] + offsets[tile_count] / 2;
+            raster.tile_triangles = malloc_t<u32>(raster.tile_triangle_capacity);
+        }
+
+        // offsets[tile] is used as write cursor, afterwards it's shifted to the next tile start and restored below
+        for (u32 i = 0 ; i < raster.triangle_count ; i++) {
+            raster_visit_tiles(raster, raster.triangles[i], [&](u32 tile) {
+                raster.tile_triangles[offsets[tile]++] = i;
+            });
+        }
+
+        for (u32 tile = tile_count ; tile > 0 ; tile--) {
+            offsets[tile] = offsets[tile - 1];
+        }
+        offsets[0] = 0;
+    }
+
+    static simd4f_t raster_and(simd4f_t a, simd4f_t b) {
+        return simd4f_select(a, b, a);
+    }
+
+    static void raster_render_block(raster_t& raster, const raster_triangle_t& t, u32 x, u32 y) {
+        float& hiz = raster.hiz[usize(y / SF_RASTER_BLOCK_SIZE) * raster.hiz_stride + x / SF_RASTER_BLOCK_SIZE];
+        if (t.depth_min >= hiz) {
+            return;
+        }
+
+        // block is rejected when the corner with the largest value of some edge function is still outside of it
+        const float x0 = float(x) + 0.5f;
+        const float y0 = float(y) + 0.5f;
+        const float x1 = x0 + float(SF_RASTER_BLOCK_SIZE - 1);
+        const float y1 = y0 + float(SF_RASTER_BLOCK_SIZE - 1);
+        for (u32 i = 0 ; i < 3 ; i++) {
+            const float e = t.edge_a[i] * (t.edge_a[i] > 0 ? x1 : x0) + t.edge_b[i] * (t.edge_b[i] > 0 ? y1 : y0) + t.edge_c[i];
+            if (e <= t.edge_bias[i]) {
+                return;
+            }
+        }
+
+        const simd4f_t offsets = simd4f_set(0.5f, 1.5f, 2.5f, 3.5f);
+        const simd4f_t width = simd4f_splat(float(raster.width));
+        const simd4f_t a0 = simd4f_splat(t.edge_a[0]);
+        const simd4f_t a1 = simd4f_splat(t.edge_a[1]);
+        const simd4f_t a2 = simd4f_splat(t.edge_a[2]);
+        const simd4f_t bias0 = simd4f_splat(t.edge_bias[0]);
+        const simd4f_t bias1 = simd4f_splat(t.edge_bias[1]);
+        const simd4f_t bias2 = simd4f_splat(t.edge_bias[2]);
+        const simd4f_t depth_a = simd4f_splat(t.depth_a);
+        const simd4f_t xs[2] = {
+                simd4f_add(simd4f_splat(float(x)), offsets),
+                simd4f_add(simd4f_splat(float(x + 4)), offsets)
+        };
+
+        const u32 row_count = std::min(u32(SF_RASTER_BLOCK_SIZE), raster.height - y);
+        bool written = false;
+        for (u32 row = 0 ; row < row_count ; row++) {
+            const float py = y0 + float(row);
+            const simd4f_t c0 = simd4f_splat(t.edge_b[0] * py + t.edge_c[0]);
+            const simd4f_t c1 = simd4f_splat(t.edge_b[1] * py + t.edge_c[1]);
+            const simd4f_t c2 = simd4f_splat(t.edge_b[2] * py + t.edge_c[2]);
+            const simd4f_t depth_c = simd4f_splat(t.depth_b * py + t.depth_c);
+            float* depth_row = raster.depth + usize(y + row) * raster.stride + x;
+
+            for (u32 half = 0 ; half < 2 ; half++) {
+                const simd4f_t px = xs[half];
+                simd4f_t mask = simd4f_less(bias0, simd4f_add(simd4f_mul(a0, px), c0));
+                mask = raster_and(mask, simd4f_less(bias1, simd4f_add(simd4f_mul(a1, px), c1)));
+                mask = raster_and(mask, simd4f_less(bias2, simd4f_add(simd4f_mul(a2, px), c2)));
+                mask = raster_and(mask, simd4f_less(px, width));
+                if (simd4f_movemask(mask) == 0) {
+                    continue;
+                }
+
+                const simd4f_t z = simd4f_add(simd4f_mul(depth_a, px), depth_c);
+                const simd4f_t depth = simd4f_loadu(depth_row + half * 4);
+                mask = raster_and(mask, simd4f_less(z, depth));
+                const u32 bits = simd4f_movemask(mask);
+                if (bits == 0) {
+                    continue;
+                }
+
+                simd4f_storeu(depth_row + half * 4, simd4f_select(mask, z, depth));
+                written = true;
+                if (raster.color != nullptr) {
+                    u32* color_row = raster.color + usize(y + row) * raster.color_stride + x + half * 4;
+                    for (u32 lane = 0 ; lane < 4 ; lane++) {
+                        if (bits & (1u << lane)) {
+                            color_row[lane] = t.color;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (written) {
+            simd4f_t block_max = simd4f_zero();
+            for (u32 row = 0 ; row < SF_RASTER_BLOCK_SIZE ; row++) {
+                const float* depth_row = raster.depth + usize(y + row) * raster.stride + x;
+                block_max = simd4f_max(block_max, simd4f_max(simd4f_loadu(depth_row), simd4f_loadu(depth_row + 4)));
+            }
+            hiz = std::max(
+                    std::max(simd4f_lane<0>(block_max), simd4f_lane<1>(block_max)),
+                    std::max(simd4f_lane<2>(block_max), simd4f_lane<3>(block_max))
+            );
+        }
+    }
+
+    void raster_render_tile(raster_t& raster, u32 tile) {
+        const u32 tile_x = (tile % raster.tile_count_x) * SF_RASTER_TILE_SIZE;
+        const u32 tile_y = (tile / raster.tile_count_x) * SF_RASTER_TILE_SIZE;
+
+        for (u32 i = raster.tile_offsets[tile] ; i < raster.tile_offsets[tile + 1] ; i++) {
+            const raster_triangle_t& t = raster.triangles[raster.tile_triangles[i]];
+            const u32 x0 = std::max(u32(t.min_x), tile_x);
+            const u32 y0 = std::max(u32(t.min_y), tile_y);
+            const u32 x1 = std::min(u32(t.max_x), tile_x + SF_RASTER_TILE_SIZE);
+            const u32 y1 = std::min(u32(t.max_y), tile_y + SF_RASTER_TILE_SIZE);
+
+            for (u32 y = y0 / SF_RASTER_BLOCK_SIZE * SF_RASTER_BLOCK_SIZE ; y < y1 ; y += SF_RASTER_BLOCK_SIZE) {
+                for (u32 x = x0 / SF_RASTER_BLOCK_SIZE * SF_RASTER_BLOCK_SIZE ; x < x1 ; x += SF_RASTER_BLOCK_SIZE) {
+                    raster_render_block(raster, t, x, y);
+                }
+            }
+        }
+    }
+
+    void raster_render(raster_t& raster) {
+        raster_bin(raster);
+        const u32 tile_count = raster.tile_count_x * raster.tile_count_y;
+        for (u32 tile = 0 ; tile < tile_count ; tile++) {
+            raster_render_tile(raster, tile);
+        }
+    }
+
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <sf_geometry.hpp>
+
+#define SF_RASTER_TILE_SIZE 64
+// hierarchical depth keeps the farthest depth of every block
+#define SF_RASTER_BLOCK_SIZE 8
+
+namespace sf {
+
+    /**
+     * Tile based triangle rasterizer for machines without GPU.
+     * Triangles are clipped and set up on submit, binned into SF_RASTER_TILE_SIZE tiles and every tile is rasterized independently,
+     * so tiles can be split between threads without sharing any pixels. Depth is 0..1 with 1 at the far plane, less depth passes.
+     * Edge functions follow top-left rule, so triangles sharing an edge never touch the same pixel twice.
+     */
+
+    // e(x, y) = a * x + b * y + c is positive inside, pixel is covered when e > bias
+    struct SF_API raster_triangle_t final {
+        float edge_a[3];
+        float edge_b[3];
+        float edge_c[3];
+        // 0 for right and bottom edges, -FLT_MIN for top and left edges
+        float edge_bias[3];
+        // z(x, y) = depth_a * x + depth_b * y + depth_c
+        float depth_a;
+        float depth_b;
+        float depth_c;
+        float depth_min;
+        // pixel bounds clamped to viewport, max is exclusive
+        int min_x;
+        int min_y;
+        int max_x;
+        int max_y;
+        u32 color;
+    };
+
+    struct SF_API raster_t final {
+        u32 width = 0;
+        u32 height = 0;
+        // depth and hiz sizes are rounded up to whole blocks
+        u32 stride = 0;
+        u32 tile_count_x = 0;
+        u32 tile_count_y = 0;
+        float* depth = nullptr;
+        float* hiz = nullptr;
+        u32 hiz_stride = 0;
+        // optional color target, written only where depth test passes
+        u32* color = nullptr;
+        u32 color_stride = 0;
+        raster_triangle_t* triangles = nullptr;
+        u32 triangle_count = 0;
+        u32 triangle_capacity = 0;
+        // triangles, which didn't fit into triangle_capacity since the last raster_clear()
+        u32 dropped_count = 0;
+        // triangles of tile i are tile_triangles[tile_offsets[i] .. tile_offsets[i + 1]) in submit order
+        u32* tile_offsets = nullptr;
+        u32* tile_triangles = nullptr;
+        u32 tile_triangle_capacity = 0;
+    };
+
+    SF_API raster_t raster_init(u32 width, u32 height, u32 triangle_capacity);
+    SF_API void raster_free(raster_t& raster);
+    SF_API void raster_set_color(raster_t& raster, u32* color, u32 color_stride);
+    // resets depth to far plane, drops submitted triangles and fills color target, if it's set
+    SF_API void raster_clear(raster_t& raster, u32 color = 0);
+    /**
+     * Positions go through model_view_projection as row vectors, usually model * camera.view_projection.
+     * Triangles are clipped against near plane and rejected outside of other planes, both windings are drawn.
+     * Clipping can turn one triangle into two, those, which don't fit into triangle_capacity, are added to dropped_count.
+     * Returns the number of triangles stored after clipping.
+     */
+    SF_API u32 raster_submit(raster_t& raster, const float4x4_t& model_view_projection, const float3_t* positions, const u32* indices, u32 index_count, u32 color);
+    SF_API void raster_bin(raster_t& raster);
+    // tiles must be binned, different tiles can be rendered concurrently
+    SF_API void raster_render_tile(raster_t& raster, u32 tile);
+    SF_API void raster_render(raster_t& raster);
+
+    // workers take next tile from shared counter, so tiles with more triangles don't stall the others
+    template<typename A>
+    void raster_render_parallel(thread_pool_t<A>& thread_pool, raster_t& raster) {
+        raster_bin(raster);
+        const u32 tile_count = raster.tile_count_x * raster.tile_count_y;
+        std::atomic<u32> next_tile(0);
+        thread_pool_parallel_for(thread_pool, u32(thread_pool.thread_size + 1), [&](u32, u32, u32) {
+            for (u32 tile = next_tile.fetch_add(1, std::memory_order_relaxed) ; tile < tile_count ; tile = next_tile.fetch_add(1, std::memory_order_relaxed)) {
+                raster_render_tile(raster, tile);
+            }
+        });
+    }
+
+}
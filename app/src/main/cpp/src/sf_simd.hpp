@@ -0,0 +1,332 @@
+#pragma once
+
+#include <sf.hpp>
+#include <cmath>
+#include <cstring>
+
+// SF_NO_SIMD forces scalar fallback, useful to compare results with SIMD path
+#if !defined(SF_NO_SIMD)
+
+#if defined(__SSE4_1__) || defined(__AVX__)
+
+#define SF_SIMD_SSE
+#include <immintrin.h>
+
+#if defined(__AVX__)
+#define SF_SIMD_AVX
+#endif
+
+// division, sqrt and rounding intrinsics are A64 only, 32-bit ARM NEON has just estimates,
+// which aren't bit-compatible with scalar operations, so armeabi-v7a uses scalar fallback
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && defined(__aarch64__)
+
+#define SF_SIMD_NEON
+#include <arm_neon.h>
+
+#endif
+
+#endif // SF_NO_SIMD
+
+#if !defined(SF_SIMD_SSE) && !defined(SF_SIMD_NEON)
+#define SF_SIMD_SCALAR
+#endif
+
+#define SF_SIMD_ALIGNMENT 16
+
+namespace sf {
+
+    /**
+     * 4 lanes of float backed by SSE4.1 on x86-64, NEON on aarch64 or plain array otherwise.
+     * All the operations are lane-wise IEEE operations without fused multiply-add,
+     * so results are bit-compatible with the same sequence of scalar operations.
+     */
+
+#if defined(SF_SIMD_SSE)
+
+    typedef __m128 simd4f_t;
+
+    inline simd4f_t simd4f_zero() { return _mm_setzero_ps(); }
+    inline simd4f_t simd4f_splat(float f) { return _mm_set1_ps(f); }
+    inline simd4f_t simd4f_set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+    inline simd4f_t simd4f_load(const float* p) { return _mm_load_ps(p); }
+    inline simd4f_t simd4f_loadu(const float* p) { return _mm_loadu_ps(p); }
+    inline void simd4f_store(float* p, simd4f_t v) { _mm_store_ps(p, v); }
+    inline void simd4f_storeu(float* p, simd4f_t v) { _mm_storeu_ps(p, v); }
+
+    inline simd4f_t simd4f_add(simd4f_t a, simd4f_t b) { return _mm_add_ps(a, b); }
+    inline simd4f_t simd4f_sub(simd4f_t a, simd4f_t b) { return _mm_sub_ps(a, b); }
+    inline simd4f_t simd4f_mul(simd4f_t a, simd4f_t b) { return _mm_mul_ps(a, b); }
+    inline simd4f_t simd4f_div(simd4f_t a, simd4f_t b) { return _mm_div_ps(a, b); }
+    inline simd4f_t simd4f_sqrt(simd4f_t a) { return _mm_sqrt_ps(a); }
+    inline simd4f_t simd4f_min(simd4f_t a, simd4f_t b) { return _mm_min_ps(a, b); }
+    inline simd4f_t simd4f_max(simd4f_t a, simd4f_t b) { return _mm_max_ps(a, b); }
+    inline simd4f_t simd4f_neg(simd4f_t a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+    inline simd4f_t simd4f_abs(simd4f_t a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+    inline simd4f_t simd4f_floor(simd4f_t a) { return _mm_floor_ps(a); }
+    // ~12 bits of precision, max relative error 1.5 * 2^-12, one Newton step is enough for float
+#define SF_SIMD_RSQRT_STEPS 1
+    inline simd4f_t simd4f_rsqrt_estimate(simd4f_t a) { return _mm_rsqrt_ps(a); }
+    // lanes of mask are all ones or all zeros
+    inline simd4f_t simd4f_less(simd4f_t a, simd4f_t b) { return _mm_cmplt_ps(a, b); }
+    inline simd4f_t simd4f_select(simd4f_t mask, simd4f_t a, simd4f_t b) { return _mm_blendv_ps(b, a, mask); }
+    inline u32 simd4f_movemask(simd4f_t mask) { return u32(_mm_movemask_ps(mask)); }
+
+    template<int i>
+    inline float simd4f_lane(simd4f_t v) {
+        return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i)));
+    }
+
+    template<int i>
+    inline simd4f_t simd4f_splat_lane(simd4f_t v) {
+        return _mm_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i));
+    }
+
+    // { a[i0], a[i1], b[i2], b[i3] }
+    template<int i0, int i1, int i2, int i3>
+    inline simd4f_t simd4f_shuffle(simd4f_t a, simd4f_t b) {
+        return _mm_shuffle_ps(a, b, _MM_SHUFFLE(i3, i2, i1, i0));
+    }
+
+    inline void simd4f_transpose(simd4f_t& r0, simd4f_t& r1, simd4f_t& r2, simd4f_t& r3) {
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    }
+
+#elif defined(SF_SIMD_NEON)
+
+    typedef float32x4_t simd4f_t;
+
+    inline simd4f_t simd4f_zero() { return vdupq_n_f32(0.0f); }
+    inline simd4f_t simd4f_splat(float f) { return vdupq_n_f32(f); }
+    inline simd4f_t simd4f_set(float x, float y, float z, float w) {
+        alignas(SF_SIMD_ALIGNMENT) const float v[4] = { x, y, z, w };
+        return vld1q_f32(v);
+    }
+    inline simd4f_t simd4f_load(const float* p) { return vld1q_f32(p); }
+    inline simd4f_t simd4f_loadu(const float* p) { return vld1q_f32(p); }
+    inline void simd4f_store(float* p, simd4f_t v) { vst1q_f32(p, v); }
+    inline void simd4f_storeu(float* p, simd4f_t v) { vst1q_f32(p, v); }
+
+    inline simd4f_t simd4f_add(simd4f_t a, simd4f_t b) { return vaddq_f32(a, b); }
+    inline simd4f_t simd4f_sub(simd4f_t a, simd4f_t b) { return vsubq_f32(a, b); }
+    inline simd4f_t simd4f_mul(simd4f_t a, simd4f_t b) { return vmulq_f32(a, b); }
+    inline simd4f_t simd4f_div(simd4f_t a, simd4f_t b) { return vdivq_f32(a, b); }
+    inline simd4f_t simd4f_sqrt(simd4f_t a) { return vsqrtq_f32(a); }
+    inline simd4f_t simd4f_min(simd4f_t a, simd4f_t b) { return vminq_f32(a, b); }
+    inline simd4f_t simd4f_max(simd4f_t a, simd4f_t b) { return vmaxq_f32(a, b); }
+    inline simd4f_t simd4f_neg(simd4f_t a) { return vnegq_f32(a); }
+    inline simd4f_t simd4f_abs(simd4f_t a) { return vabsq_f32(a); }
+    inline simd4f_t simd4f_floor(simd4f_t a) { return vrndmq_f32(a); }
+    // ~8 bits of precision, max relative error ~2^-8, two Newton steps bring it to 1.5e-7, one would leave 2.3e-5
+#define SF_SIMD_RSQRT_STEPS 2
+    inline simd4f_t simd4f_rsqrt_estimate(simd4f_t a) { return vrsqrteq_f32(a); }
+    // lanes of mask are all ones or all zeros
+    inline simd4f_t simd4f_less(simd4f_t a, simd4f_t b) { return vreinterpretq_f32_u32(vcltq_f32(a, b)); }
+    inline simd4f_t simd4f_select(simd4f_t mask, simd4f_t a, simd4f_t b) { return vbslq_f32(vreinterpretq_u32_f32(mask), a, b); }
+
+    inline u32 simd4f_movemask(simd4f_t mask) {
+        const uint32x4_t bits = vshrq_n_u32(vreinterpretq_u32_f32(mask), 31);
+        return vgetq_lane_u32(bits, 0) | (vgetq_lane_u32(bits, 1) << 1) | (vgetq_lane_u32(bits, 2) << 2) | (vgetq_lane_u32(bits, 3) << 3);
+    }
+
+    template<int i>
+    inline float simd4f_lane(simd4f_t v) {
+        return vgetq_lane_f32(v, i);
+    }
+
+    template<int i>
+    inline simd4f_t simd4f_splat_lane(simd4f_t v) {
+        return vdupq_laneq_f32(v, i);
+    }
+
+    // { a[i0], a[i1], b[i2], b[i3] }
+    template<int i0, int i1, int i2, int i3>
+    inline simd4f_t simd4f_shuffle(simd4f_t a, simd4f_t b) {
+        return __builtin_shufflevector(a, b, i0, i1, i2 + 4, i3 + 4);
+    }
+
+    inline void simd4f_transpose(simd4f_t& r0, simd4f_t& r1, simd4f_t& r2, simd4f_t& r3) {
+        float32x4x2_t t01 = vtrnq_f32(r0, r1);
+        float32x4x2_t t23 = vtrnq_f32(r2, r3);
+        r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+        r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+        r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+        r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+    }
+
+#else
+
+    struct alignas(SF_SIMD_ALIGNMENT) simd4f_t final {
+        float v[4];
+    };
+
+    inline simd4f_t simd4f_zero() { return { 0.0f, 0.0f, 0.0f, 0.0f }; }
+    inline simd4f_t simd4f_splat(float f) { return { f, f, f, f }; }
+    inline simd4f_t simd4f_set(float x, float y, float z, float w) { return { x, y, z, w }; }
+    inline simd4f_t simd4f_load(const float* p) { return { p[0], p[1], p[2], p[3] }; }
+    inline simd4f_t simd4f_loadu(const float* p) { return { p[0], p[1], p[2], p[3] }; }
+    inline void simd4f_store(float* p, simd4f_t v) { p[0] = v.v[0]; p[1] = v.v[1]; p[2] = v.v[2]; p[3] = v.v[3]; }
+    inline void simd4f_storeu(float* p, simd4f_t v) { simd4f_store(p, v); }
+
+    inline simd4f_t simd4f_add(simd4f_t a, simd4f_t b) { return { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] }; }
+    inline simd4f_t simd4f_sub(simd4f_t a, simd4f_t b) { return { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] }; }
+    inline simd4f_t simd4f_mul(simd4f_t a, simd4f_t b) { return { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] }; }
+    inline simd4f_t simd4f_div(simd4f_t a, simd4f_t b) { return { a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3] }; }
+    inline simd4f_t simd4f_sqrt(simd4f_t a) { return { std::sqrt(a.v[0]), std::sqrt(a.v[1]), std::sqrt(a.v[2]), std::sqrt(a.v[3]) }; }
+    inline simd4f_t simd4f_min(simd4f_t a, simd4f_t b) { return { std::min(a.v[0], b.v[0]), std::min(a.v[1], b.v[1]), std::min(a.v[2], b.v[2]), std::min(a.v[3], b.v[3]) }; }
+    inline simd4f_t simd4f_max(simd4f_t a, simd4f_t b) { return { std::max(a.v[0], b.v[0]), std::max(a.v[1], b.v[1]), std::max(a.v[2], b.v[2]), std::max(a.v[3], b.v[3]) }; }
+    inline simd4f_t simd4f_neg(simd4f_t a) { return { -a.v[0], -a.v[1], -a.v[2], -a.v[3] }; }
+    inline simd4f_t simd4f_abs(simd4f_t a) { return { std::abs(a.v[0]), std::abs(a.v[1]), std::abs(a.v[2]), std::abs(a.v[3]) }; }
+    inline simd4f_t simd4f_floor(simd4f_t a) { return { std::floor(a.v[0]), std::floor(a.v[1]), std::floor(a.v[2]), std::floor(a.v[3]) }; }
+
+    // magic constant estimate, max relative error ~3.4e-2, three Newton steps are needed for float
+#define SF_SIMD_RSQRT_STEPS 3
+
+    inline float simd4f_rsqrt_estimate(float a) {
+        u32 i;
+        std::memcpy(&i, &a, sizeof(i));
+        i = 0x5f375a86 - (i >> 1);
+        std::memcpy(&a, &i, sizeof(a));
+        return a;
+    }
+
+    inline simd4f_t simd4f_rsqrt_estimate(simd4f_t a) {
+        return { simd4f_rsqrt_estimate(a.v[0]), simd4f_rsqrt_estimate(a.v[1]), simd4f_rsqrt_estimate(a.v[2]), simd4f_rsqrt_estimate(a.v[3]) };
+    }
+
+    // lanes of mask are all ones or all zeros, same as SSE and NEON comparisons
+    inline float simd4f_mask(bool b) {
+        u32 i = b ? 0xffffffff : 0;
+        float f;
+        std::memcpy(&f, &i, sizeof(f));
+        return f;
+    }
+
+    inline float simd4f_select(float mask, float a, float b) {
+        u32 i;
+        std::memcpy(&i, &mask, sizeof(i));
+        return i ? a : b;
+    }
+
+    inline simd4f_t simd4f_less(simd4f_t a, simd4f_t b) {
+        return { simd4f_mask(a.v[0] < b.v[0]), simd4f_mask(a.v[1] < b.v[1]), simd4f_mask(a.v[2] < b.v[2]), simd4f_mask(a.v[3] < b.v[3]) };
+    }
+
+    inline simd4f_t simd4f_select(simd4f_t mask, simd4f_t a, simd4f_t b) {
+        return {
+            simd4f_select(mask.v[0], a.v[0], b.v[0]),
+            simd4f_select(mask.v[1], a.v[1], b.v[1]),
+            simd4f_select(mask.v[2], a.v[2], b.v[2]),
+            simd4f_select(mask.v[3], a.v[3], b.v[3])
+        };
+    }
+
+    inline u32 simd4f_movemask(simd4f_t mask) {
+        u32 bits[4];
+        std::memcpy(bits, mask.v, sizeof(bits));
+        return (bits[0] >> 31) | ((bits[1] >> 31) << 1) | ((bits[2] >> 31) << 2) | ((bits[3] >> 31) << 3);
+    }
+
+    template<int i>
+    inline float simd4f_lane(simd4f_t v) {
+        return v.v[i];
+    }
+
+    template<int i>
+    inline simd4f_t simd4f_splat_lane(simd4f_t v) {
+        return simd4f_splat(v.v[i]);
+    }
+
+    // { a[i0], a[i1], b[i2], b[i3] }
+    template<int i0, int i1, int i2, int i3>
+    inline simd4f_t simd4f_shuffle(simd4f_t a, simd4f_t b) {
+        return { a.v[i0], a.v[i1], b.v[i2], b.v[i3] };
+    }
+
+    inline void simd4f_transpose(simd4f_t& r0, simd4f_t& r1, simd4f_t& r2, simd4f_t& r3) {
+        simd4f_t t0 = { r0.v[0], r1.v[0], r2.v[0], r3.v[0] };
+        simd4f_t t1 = { r0.v[1], r1.v[1], r2.v[1], r3.v[1] };
+        simd4f_t t2 = { r0.v[2], r1.v[2], r2.v[2], r3.v[2] };
+        simd4f_t t3 = { r0.v[3], r1.v[3], r2.v[3], r3.v[3] };
+        r0 = t0;
+        r1 = t1;
+        r2 = t2;
+        r3 = t3;
+    }
+
+#endif
+
+    // horizontal sum in the same order as scalar code: ((x + y) + z) + w
+    inline float simd4f_sum(simd4f_t v) {
+        return ((simd4f_lane<0>(v) + simd4f_lane<1>(v)) + simd4f_lane<2>(v)) + simd4f_lane<3>(v);
+    }
+
+    /**
+     * simdf_t is the widest float vector of the target, it's used by batched SoA kernels:
+     * 8 lanes with AVX, 4 lanes with SSE/NEON or scalar fallback.
+     * Loads and stores are unaligned, because SoA arrays are usually owned by the caller.
+     */
+
+#if defined(SF_SIMD_AVX)
+
+#define SF_SIMD_WIDTH 8
+
+    typedef __m256 simdf_t;
+
+    inline simdf_t simdf_splat(float f) { return _mm256_set1_ps(f); }
+    inline simdf_t simdf_load(const float* p) { return _mm256_loadu_ps(p); }
+    inline void simdf_store(float* p, simdf_t v) { _mm256_storeu_ps(p, v); }
+    inline simdf_t simdf_add(simdf_t a, simdf_t b) { return _mm256_add_ps(a, b); }
+    inline simdf_t simdf_sub(simdf_t a, simdf_t b) { return _mm256_sub_ps(a, b); }
+    inline simdf_t simdf_mul(simdf_t a, simdf_t b) { return _mm256_mul_ps(a, b); }
+    inline simdf_t simdf_div(simdf_t a, simdf_t b) { return _mm256_div_ps(a, b); }
+    inline simdf_t simdf_sqrt(simdf_t a) { return _mm256_sqrt_ps(a); }
+    inline simdf_t simdf_min(simdf_t a, simdf_t b) { return _mm256_min_ps(a, b); }
+    inline simdf_t simdf_max(simdf_t a, simdf_t b) { return _mm256_max_ps(a, b); }
+    inline simdf_t simdf_less(simdf_t a, simdf_t b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    inline u32 simdf_movemask(simdf_t mask) { return u32(_mm256_movemask_ps(mask)); }
+
+    // (p[i] - origin) is computed in double and only then rounded to float
+    inline simdf_t simdf_load_relative(const double* p, double origin) {
+        const __m256d o = _mm256_set1_pd(origin);
+        const __m128 lo = _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(p), o));
+        const __m128 hi = _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(p + 4), o));
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+    }
+
+#else
+
+#define SF_SIMD_WIDTH 4
+
+    typedef simd4f_t simdf_t;
+
+    inline simdf_t simdf_splat(float f) { return simd4f_splat(f); }
+    inline simdf_t simdf_load(const float* p) { return simd4f_loadu(p); }
+    inline void simdf_store(float* p, simdf_t v) { simd4f_storeu(p, v); }
+    inline simdf_t simdf_add(simdf_t a, simdf_t b) { return simd4f_add(a, b); }
+    inline simdf_t simdf_sub(simdf_t a, simdf_t b) { return simd4f_sub(a, b); }
+    inline simdf_t simdf_mul(simdf_t a, simdf_t b) { return simd4f_mul(a, b); }
+    inline simdf_t simdf_div(simdf_t a, simdf_t b) { return simd4f_div(a, b); }
+    inline simdf_t simdf_sqrt(simdf_t a) { return simd4f_sqrt(a); }
+    inline simdf_t simdf_min(simdf_t a, simdf_t b) { return simd4f_min(a, b); }
+    inline simdf_t simdf_max(simdf_t a, simdf_t b) { return simd4f_max(a, b); }
+    inline simdf_t simdf_less(simdf_t a, simdf_t b) { return simd4f_less(a, b); }
+    inline u32 simdf_movemask(simdf_t mask) { return simd4f_movemask(mask); }
+
+    // (p[i] - origin) is computed in double and only then rounded to float
+    inline simdf_t simdf_load_relative(const double* p, double origin) {
+#if defined(SF_SIMD_SSE)
+        const __m128d o = _mm_set1_pd(origin);
+        const __m128 lo = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(p), o));
+        const __m128 hi = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(p + 2), o));
+        return _mm_movelh_ps(lo, hi);
+#elif defined(SF_SIMD_NEON)
+        const float64x2_t o = vdupq_n_f64(origin);
+        return vcombine_f32(vcvt_f32_f64(vsubq_f64(vld1q_f64(p), o)), vcvt_f32_f64(vsubq_f64(vld1q_f64(p + 2), o)));
+#else
+        return simd4f_set(float(p[0] - origin), float(p[1] - origin), float(p[2] - origin), float(p[3] - origin));
+#endif
+    }
+
+#endif
+
+}
@@ -0,0 +1,206 @@
+#include <sf_spatial.hpp>
+
+namespace sf {
+
+    static int3_t spatial_grid_cell(const spatial_grid_t& grid, const float3_t& p) {
+        return {
+                static_cast<int>(std::floor(p.x * grid.inv_cell_size)),
+                static_cast<int>(std::floor(p.y * grid.inv_cell_size)),
+                static_cast<int>(std::floor(p.z * grid.inv_cell_size))
+        };
+    }
+
+    static u32 spatial_grid_bucket(const spatial_grid_t& grid, const int3_t& cell) {
+        const u32 hash = (u32(cell.x) * 73856093u) ^ (u32(cell.y) * 19349663u) ^ (u32(cell.z) * 83492791u);
+        return hash & grid.bucket_mask;
+    }
+
+    static bool spatial_grid_same_cell(const int3_t& a, const int3_t& b) {
+        return a.x == b.x && a.y == b.y && a.z == b.z;
+    }
+
+    static void spatial_grid_link(spatial_grid_t& grid, u32 proxy, u32 bucket) {
+        spatial_grid_proxy_t& p = grid.proxies[proxy];
+        p.bucket = bucket;
+        p.prev = SF_SPATIAL_GRID_INVALID;
+        p.next = grid.buckets[bucket];
+        if (p.next != SF_SPATIAL_GRID_INVALID) {
+            grid.proxies[p.next].prev = proxy;
+        }
+        grid.buckets[bucket] = proxy;
+    }
+
+    static void spatial_grid_unlink(spatial_grid_t& grid, u32 proxy) {
+        const spatial_grid_proxy_t& p = grid.proxies[proxy];
+        if (p.prev != SF_SPATIAL_GRID_INVALID) {
+            grid.proxies[p.prev].next = p.next;
+        } else {
+            grid.buckets[p.bucket] = p.next;
+        }
+        if (p.next != SF_SPATIAL_GRID_INVALID) {
+            grid.proxies[p.next].prev = p.prev;
+        }
+    }
+
+    static void spatial_grid_grow_extents(spatial_grid_t& grid, const aabb_t& bounds) {
+        const float3_t e = aabb_extents(bounds);
+        grid.max_half_extents = {
+                std::max(grid.max_half_extents.x, e.x),
+                std::max(grid.max_half_extents.y, e.y),
+                std::max(grid.max_half_extents.z, e.z)
+        };
+    }
+
+    spatial_grid_t spatial_grid_init(memory_arena_t& memory_arena, u32 capacity, u32 bucket_count, float cell_size, u32 thread_count) {
+        SF_ASSERT(cell_size > 0, "spatial_grid_init(): cell size must be positive!");
+
+        u32 buckets = 1;
+        while (buckets < bucket_count) {
+            buckets <<= 1;
+        }
+
+        spatial_grid_t grid;
+        grid.proxies = static_cast<spatial_grid_proxy_t*>(memory_arena_allocate(memory_arena, sizeof(spatial_grid_proxy_t) * capacity));
+        grid.buckets = static_cast<u32*>(memory_arena_allocate(memory_arena, sizeof(u32) * buckets));
+        SF_ASSERT(grid.proxies != nullptr && grid.buckets != nullptr, "spatial_grid_init(): memory arena is out of memory!");
+        if (thread_count > 0) {
+            // one chunk per pool thread and one for the calling thread, see thread_pool_chunk_count()
+            grid.chunk_capacity = thread_count + 1;
+            grid.chunk_found = static_cast<u32*>(memory_arena_allocate(memory_arena, sizeof(u32) * grid.chunk_capacity * 2));
+            SF_ASSERT(grid.chunk_found != nullptr, "spatial_grid_init(): memory arena is out of memory!");
+            grid.chunk_begin = grid.chunk_found + grid.chunk_capacity;
+        }
+        grid.proxy_capacity = capacity;
+        grid.bucket_mask = buckets - 1;
+        grid.cell_size = cell_size;
+        grid.inv_cell_size = 1.0f / cell_size;
+        spatial_grid_clear(grid);
+        return grid;
+    }
+
+    void spatial_grid_clear(spatial_grid_t& grid) {
+        for (u32 i = 0 ; i <= grid.bucket_mask ; i++) {
+            grid.buckets[i] = SF_SPATIAL_GRID_INVALID;
+        }
+        grid.proxy_end = 0;
+        grid.proxy_count = 0;
+        grid.free_head = SF_SPATIAL_GRID_INVALID;
+        grid.max_half_extents = { 0, 0, 0 };
+    }
+
+    u32 spatial_grid_insert(spatial_grid_t& grid, const aabb_t& bounds, u32 user) {
+        u32 proxy = grid.free_head;
+        if (proxy != SF_SPATIAL_GRID_INVALID) {
+            grid.free_head = grid.proxies[proxy].next;
+        } else {
+            SF_ASSERT(grid.proxy_end < grid.proxy_capacity, "spatial_grid_insert(): grid is full!");
+            proxy = grid.proxy_end++;
+        }
+
+        spatial_grid_proxy_t& p = grid.proxies[proxy];
+        p.bounds = bounds;
+        p.cell = spatial_grid_cell(grid, aabb_center(bounds));
+        p.user = user;
+        spatial_grid_link(grid, proxy, spatial_grid_bucket(grid, p.cell));
+        spatial_grid_grow_extents(grid, bounds);
+        grid.proxy_count++;
+        return proxy;
+    }
+
+    void spatial_grid_remove(spatial_grid_t& grid, u32 proxy) {
+        SF_ASSERT(grid.proxies[proxy].bucket != SF_SPATIAL_GRID_INVALID, "spatial_grid_remove(): proxy is already removed!");
+        spatial_grid_unlink(grid, proxy);
+        spatial_grid_proxy_t& p = grid.proxies[proxy];
+        p.bucket = SF_SPATIAL_GRID_INVALID;
+        p.next = grid.free_head;
+        grid.free_head = proxy;
+        grid.proxy_count--;
+    }
+
+    void spatial_grid_move(spatial_grid_t& grid, u32 proxy, const aabb_t& bounds) {
+        spatial_grid_proxy_t& p = grid.proxies[proxy];
+        SF_ASSERT(p.bucket != SF_SPATIAL_GRID_INVALID, "spatial_grid_move(): proxy is removed!");
+        p.bounds = bounds;
+        spatial_grid_grow_extents(grid, bounds);
+
+        const int3_t cell = spatial_grid_cell(grid, aabb_center(bounds));
+        if (spatial_grid_same_cell(cell, p.cell)) {
+            return;
+        }
+
+        p.cell = cell;
+        const u32 bucket = spatial_grid_bucket(grid, cell);
+        if (bucket != p.bucket) {
+            spatial_grid_unlink(grid, proxy);
+            spatial_grid_link(grid, proxy, bucket);
+        }
+    }
+
+    /**
+     * Calls function for every live proxy, which center may lie in a cell touched by bounds widened with max half extents.
+     * Bucket lists are shared by colliding cells, so proxy is accepted only in the cell it belongs to and is visited once.
+     * When bounds cover more cells than there are proxies, all proxies are scanned instead.
+     */
+    template<typename F>
+    static void spatial_grid_visit(const spatial_grid_t& grid, const aabb_t& bounds, const F& function) {
+        const int3_t min = spatial_grid_cell(grid, bounds.min - grid.max_half_extents);
+        const int3_t max = spatial_grid_cell(grid, bounds.max + grid.max_half_extents);
+        const u64 cell_count = u64(max.x - min.x + 1) * u64(max.y - min.y + 1) * u64(max.z - min.z + 1);
+
+        if (cell_count > grid.proxy_end) {
+            for (u32 i = 0 ; i < grid.proxy_end ; i++) {
+                if (grid.proxies[i].bucket != SF_SPATIAL_GRID_INVALID) {
+                    function(i);
+                }
+            }
+            return;
+        }
+
+        for (int z = min.z ; z <= max.z ; z++) {
+            for (int y = min.y ; y <= max.y ; y++) {
+                for (int x = min.x ; x <= max.x ; x++) {
+                    const int3_t cell = { x, y, z };
+                    for (u32 i = grid.buckets[spatial_grid_bucket(grid, cell)] ; i != SF_SPATIAL_GRID_INVALID ; i = grid.proxies[i].next) {
+                        if (spatial_grid_same_cell(grid.proxies[i].cell, cell)) {
+                            function(i);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    u32 spatial_grid_query(const spatial_grid_t& grid, const aabb_t& bounds, u32* proxies, u32 capacity) {
+        u32 found = 0;
+        spatial_grid_visit(grid, bounds, [&](u32 i) {
+            if (aabb_overlaps(bounds, grid.proxies[i].bounds)) {
+                if (found < capacity) {
+                    proxies[found] = i;
+                }
+                found++;
+            }
+        });
+        return found;
+    }
+
+    u32 spatial_grid_query_pairs(const spatial_grid_t& grid, u32 begin, u32 end, spatial_grid_pair_t* pairs, u32 capacity) {
+        u32 found = 0;
+        for (u32 a = begin ; a < end ; a++) {
+            const spatial_grid_proxy_t& p = grid.proxies[a];
+            if (p.bucket == SF_SPATIAL_GRID_INVALID) {
+                continue;
+            }
+
+            spatial_grid_visit(grid, p.bounds, [&](u32 b) {
+                if (b > a && aabb_overlaps(p.bounds, grid.proxies[b].bounds)) {
+                    if (found < capacity) {
+                        pairs[found] = { a, b };
+                    }
+                    found++;
+                }
+            });
+        }
+        return found;
+    }
+
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <sf_geometry.hpp>
+
+#define SF_SPATIAL_GRID_INVALID 0xffffffff
+
+namespace sf {
+
+    /**
+     * Hashed uniform grid for moving objects, every proxy is linked into the bucket of the cell with its center.
+     * Queries are widened by the largest half size of inserted bounds, so cells don't have to fit objects.
+     * Proxies and buckets are allocated once from arena, moving and reinserting never touches the heap.
+     */
+
+    struct SF_API spatial_grid_proxy_t final {
+        aabb_t bounds;
+        int3_t cell = { 0, 0, 0 };
+        // SF_SPATIAL_GRID_INVALID for free proxy
+        u32 bucket = SF_SPATIAL_GRID_INVALID;
+        // next proxy in bucket list or next free proxy
+        u32 next = SF_SPATIAL_GRID_INVALID;
+        u32 prev = SF_SPATIAL_GRID_INVALID;
+        u32 user = 0;
+    };
+
+    struct SF_API spatial_grid_pair_t final {
+        u32 a;
+        u32 b;
+    };
+
+    struct SF_API spatial_grid_t final {
+        spatial_grid_proxy_t* proxies = nullptr;
+        u32 proxy_capacity = 0;
+        // proxies above it were never used
+        u32 proxy_end = 0;
+        u32 proxy_count = 0;
+        u32 free_head = SF_SPATIAL_GRID_INVALID;
+        u32* buckets = nullptr;
+        u32 bucket_mask = 0;
+        float cell_size = 1;
+        float inv_cell_size = 1;
+        // only grows, until spatial_grid_clear()
+        float3_t max_half_extents = { 0, 0, 0 };
+        // found number and first proxy of every chunk of spatial_grid_query_pairs_parallel()
+        u32* chunk_found = nullptr;
+        u32* chunk_begin = nullptr;
+        u32 chunk_capacity = 0;
+    };
+
+    /**
+     * Bucket count is rounded up to power of two, cell size should be close to typical object size.
+     * thread_count is the largest thread_size of pools used with spatial_grid_query_pairs_parallel().
+     */
+    SF_API spatial_grid_t spatial_grid_init(memory_arena_t& memory_arena, u32 capacity, u32 bucket_count, float cell_size, u32 thread_count = 0);
+    SF_API void spatial_grid_clear(spatial_grid_t& grid);
+    SF_API u32 spatial_grid_insert(spatial_grid_t& grid, const aabb_t& bounds, u32 user);
+    SF_API void spatial_grid_remove(spatial_grid_t& grid, u32 proxy);
+    // relinks proxy only when its center crosses into another cell
+    SF_API void spatial_grid_move(spatial_grid_t& grid, u32 proxy, const aabb_t& bounds);
+
+    // query functions write up to capacity proxy ids and return the number of all found proxies
+    SF_API u32 spatial_grid_query(const spatial_grid_t& grid, const aabb_t& bounds, u32* proxies, u32 capacity);
+    // overlapping pairs with first proxy in [begin, end), every pair is reported once with a < b
+    SF_API u32 spatial_grid_query_pairs(const spatial_grid_t& grid, u32 begin, u32 end, spatial_grid_pair_t* pairs, u32 capacity);
+
+    // every query gets capacity slots in proxies starting from query_index * capacity, counts keep found numbers
+    template<typename A>
+    void spatial_grid_query_parallel(
+            thread_pool_t<A>& thread_pool,
+            const spatial_grid_t& grid,
+            const aabb_t* queries,
+            u32 query_count,
+            u32* proxies,
+            u32 capacity,
+            u32* counts
+    ) {
+        thread_pool_parallel_for(thread_pool, query_count, [&](u32, u32 begin, u32 end) {
+            for (u32 i = begin ; i < end ; i++) {
+                counts[i] = spatial_grid_query(grid, queries[i], proxies + usize(i) * capacity, capacity);
+            }
+        });
+    }
+
+    /**
+     * Every chunk writes into its own equal part of pairs, parts are compacted afterwards,
+     * so stored pairs and returned number of all found pairs are the same as of spatial_grid_query_pairs(grid, 0, proxy_end, ...).
+     * When a chunk overflows its part, the rest of the proxies are queried again on the calling thread.
+     * Chunk counts are kept in the grid, so only one such query can run on a grid at a time,
+     * pools with more threads than spatial_grid_init() was given query on the calling thread.
+     */
+    template<typename A>
+    u32 spatial_grid_query_pairs_parallel(thread_pool_t<A>& thread_pool, const spatial_grid_t& grid, spatial_grid_pair_t* pairs, u32 capacity) {
+        const u32 chunk_count = thread_pool_chunk_count(thread_pool, grid.proxy_end);
+        if (chunk_count > grid.chunk_capacity) {
+            return spatial_grid_query_pairs(grid, 0, grid.proxy_end, pairs, capacity);
+        }
+
+        const u32 chunk_capacity = capacity / chunk_count;
+        u32* chunk_found = grid.chunk_found;
+        u32* chunk_begin = grid.chunk_begin;
+        for (u32 chunk = 0 ; chunk < chunk_count ; chunk++) {
+            chunk_found[chunk] = 0;
+            chunk_begin[chunk] = grid.proxy_end;
+        }
+
+        thread_pool_parallel_for(thread_pool, grid.proxy_end, [&](u32 chunk, u32 begin, u32 end) {
+            chunk_found[chunk] = spatial_grid_query_pairs(grid, begin, end, pairs + usize(chunk) * chunk_capacity, chunk_capacity);
+            chunk_begin[chunk] = begin;
+        });
+
+        u32 found = 0;
+        for (u32 chunk = 0 ; chunk < chunk_count ; chunk++) {
+            if (chunk_found[chunk] > chunk_capacity) {
+                // later parts are overwritten from here, so they can't be compacted
+                found += spatial_grid_query_pairs(grid, chunk_begin[chunk], grid.proxy_end, pairs + found, capacity - found);
+                break;
+            }
+            std::memmove(pairs + found, pairs + usize(chunk) * chunk_capacity, sizeof(spatial_grid_pair_t) * chunk_found[chunk]);
+            found += chunk_found[chunk];
+        }
+        return found;
+    }
+
+}
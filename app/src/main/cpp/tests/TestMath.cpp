@@ -1,9 +1,1048 @@
 #include <sf_math.hpp>
+#include <sf_anim.hpp>
+#include <sf_bvh.hpp>
+#include <sf_spatial.hpp>
+#include <sf_camera.hpp>
+#include <sf_occlusion.hpp>
+
+using namespace sf;
+
+static bool equal_bits(const void* a, const void* b, usize size) {
+    return std::memcmp(a, b, size) == 0;
+}
+
+struct test_allocator_t final {
+    void* allocate(usize size, usize alignment = SF_ALIGNMENT) {
+        return sf::malloc(size, alignment);
+    }
+
+    void deallocate(void* addr) {
+        sf::free(addr);
+    }
+};
+
+static float4x4_t random_mat4(std::mt19937& random) {
+    std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+    float4x4_t m;
+    for (int r = 0 ; r < 4 ; r++) {
+        for (int c = 0 ; c < 4 ; c++) {
+            m[r][c] = distribution(random);
+        }
+    }
+    return m;
+}
+
+// SIMD specializations of float4_t, quat_t and float4x4_t must match scalar templates bit by bit
+static bool TestMathSimd() {
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+
+    for (int i = 0 ; i < 1000 ; i++) {
+        float4x4_t m1 = random_mat4(random);
+        float4x4_t m2 = random_mat4(random);
+
+        float4x4_t simd_mul = m1 * m2;
+        float4x4_t scalar_mul = mat4_mul<float>(m1, m2);
+        if (!equal_bits(&simd_mul, &scalar_mul, sizeof(float4x4_t))) {
+            return false;
+        }
+
+        float4x4_t simd_transpose = transpose(m1);
+        float4x4_t scalar_transpose = transpose<float>(m1);
+        if (!equal_bits(&simd_transpose, &scalar_transpose, sizeof(float4x4_t))) {
+            return false;
+        }
+
+        float simd_det = det(m1);
+        float scalar_det = det<float>(m1);
+        if (!equal_bits(&simd_det, &scalar_det, sizeof(float))) {
+            return false;
+        }
+
+        float4_t v1 = m1[0];
+        float4_t v2 = m2[0];
+        float scalar_dot = v1.x * v2.x + v1.y * v2.y + v1.z * v2.z + v1.w * v2.w;
+        float simd_dot = dot(v1, v2);
+        if (!equal_bits(&simd_dot, &scalar_dot, sizeof(float))) {
+            return false;
+        }
+
+        float l = std::sqrt(scalar_dot = v1.x * v1.x + v1.y * v1.y + v1.z * v1.z + v1.w * v1.w);
+        float scalar_normalize[4] = { v1.x / l, v1.y / l, v1.z / l, v1.w / l };
+        float4_t simd_normalize = normalize(v1);
+        if (!equal_bits(&simd_normalize, scalar_normalize, sizeof(scalar_normalize))) {
+            return false;
+        }
+
+        quat_t q1 = { v1.x, v1.y, v1.z, v1.w };
+        quat_t q2 = { v2.x, v2.y, v2.z, v2.w };
+        float scalar_quat[4] = {
+                q1.w * q2.x + q1.x * q2.w + q1.y * q2.z - q1.z * q2.y,
+                q1.w * q2.y - q1.x * q2.z + q1.y * q2.w + q1.z * q2.x,
+                q1.w * q2.z + q1.x * q2.y - q1.y * q2.x + q1.z * q2.w,
+                q1.w * q2.w - q1.x * q2.x - q1.y * q2.y - q1.z * q2.z,
+        };
+        quat_t simd_quat = q1 * q2;
+        if (!equal_bits(&simd_quat, scalar_quat, sizeof(scalar_quat))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// SoA batch kernels must match per object scalar functions, count is not a multiple of SIMD width to cover the tail
+static bool TestMathSoa() {
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+
+    constexpr usize count = 37;
+    float data[10][count];
+    for (auto& array : data) {
+        for (float& value : array) {
+            value = distribution(random);
+        }
+    }
+    float3_soa_t translations = { data[0], data[1], data[2] };
+    quat_soa_t rotations = { data[3], data[4], data[5], data[6] };
+    float3_soa_t scales = { data[7], data[8], data[9] };
+
+    quat_t quats[count];
+    for (usize i = 0 ; i < count ; i++) {
+        quats[i] = normalize(quat_t(rotations.x[i], rotations.y[i], rotations.z[i], rotations.w[i]));
+    }
+    normalize_soa(rotations, count);
+    float4x4_t matrices[count];
+    mat4_trs_soa(translations, rotations, scales, matrices, count);
+
+    float out[3][count];
+    float3_soa_t points = { out[0], out[1], out[2] };
+    transform_points_soa(matrices[0], translations, points, count);
+
+    for (usize i = 0 ; i < count ; i++) {
+        const quat_t& q = quats[i];
+        float simd_quat[4] = { rotations.x[i], rotations.y[i], rotations.z[i], rotations.w[i] };
+        if (!equal_bits(simd_quat, &q, sizeof(simd_quat))) {
+            return false;
+        }
+        float3_t t = { translations.x[i], translations.y[i], translations.z[i] };
+        float3_t s = { scales.x[i], scales.y[i], scales.z[i] };
+
+        float4x4_t scalar_trs = mat4_trs(t, q, s);
+        if (!equal_bits(&matrices[i], &scalar_trs, sizeof(float4x4_t))) {
+            return false;
+        }
+
+        const float4x4_t& m = matrices[0];
+        float scalar_point[3] = {
+                t.x * m[0][0] + t.y * m[1][0] + t.z * m[2][0] + m[3][0],
+                t.x * m[0][1] + t.y * m[1][1] + t.z * m[2][1] + m[3][1],
+                t.x * m[0][2] + t.y * m[1][2] + t.z * m[2][2] + m[3][2],
+        };
+        float simd_point[3] = { points.x[i], points.y[i], points.z[i] };
+        if (!equal_bits(simd_point, scalar_point, sizeof(scalar_point))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool near_identity(const float4x4_t& m, float epsilon) {
+    for (int r = 0 ; r < 4 ; r++) {
+        for (int c = 0 ; c < 4 ; c++) {
+            if (std::abs(m[r][c] - (r == c ? 1.0f : 0.0f)) > epsilon) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// general inverse must match scalar template, affine and rigid paths must agree with general inverse
+static bool TestMathInverse() {
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+    for (int i = 0 ; i < 1000 ; i++) {
+        float4x4_t m = random_mat4(random);
+        float4x4_t simd_inverse = inverse(m);
+        float4x4_t scalar_inverse = inverse<float>(m);
+        if (!equal_bits(&simd_inverse, &scalar_inverse, sizeof(float4x4_t))) {
+            return false;
+        }
+
+        float3_t t = { distribution(random) * 10, distribution(random) * 10, distribution(random) * 10 };
+        quat_t q = normalize(quat_t(distribution(random), distribution(random), distribution(random), distribution(random)));
+        float3_t s = { 0.5f + distribution(random) * 0.25f, 1.5f + distribution(random), 2.0f + distribution(random) };
+
+        float4x4_t rigid = mat4_rigid(t, q);
+        float4x4_t simd_rigid = inverse_rigid(rigid);
+        float4x4_t scalar_rigid = inverse_rigid<float>(rigid);
+        if (!equal_bits(&simd_rigid, &scalar_rigid, sizeof(float4x4_t)) || !near_identity(rigid * simd_rigid, 1e-5f)) {
+            return false;
+        }
+
+        float4x4_t affine = mat4_trs(t, q, s);
+        if (!near_identity(affine * inverse_affine(affine), 1e-5f) || !near_identity(affine * inverse(affine), 1e-4f)) {
+            return false;
+        }
+    }
+
+    // zero translation is negated to -0 on both paths
+    const float4x4_t identity = mat4_identity();
+    const float4x4_t simd_identity = inverse_rigid(identity);
+    const float4x4_t scalar_identity = inverse_rigid<float>(identity);
+    if (!equal_bits(&simd_identity, &scalar_identity, sizeof(float4x4_t))) {
+        return false;
+    }
+
+    // view transforms camera position to origin and front to -z
+    float3_t position = { 1, 2, 3 };
+    float3_t front = normalize(float3_t { 1, -1, 0.5f });
+    float4x4_t view = mat4_view(position, front, { 0, 1, 0 });
+    float4x4_t points = {
+            { position.x, position.y, position.z, 1 },
+            { front.x, front.y, front.z, 0 },
+            { 0, 0, 0, 0 },
+            { 0, 0, 0, 0 }
+    };
+    points = points * view;
+    return std::abs(points[0].x) + std::abs(points[0].y) + std::abs(points[0].z) < 1e-5f && std::abs(points[1].z + 1) < 1e-5f;
+}
+
+// fast accuracy policy must stay within documented max errors
+static bool TestMathAccuracy() {
+    for (float x = -8192.0f ; x <= 8192.0f ; x += 0.37f) {
+        float s, c;
+        sincos<accuracy_fast_t>(x, s, c);
+        if (std::abs(s - std::sin(double(x))) > 8e-8 || std::abs(c - std::cos(double(x))) > 8e-8) {
+            return false;
+        }
+    }
+
+    for (float x = -1.0f ; x <= 1.0f ; x += 1e-4f) {
+        if (std::abs(acos<accuracy_fast_t>(x) - std::acos(double(x))) > 4.5e-7) {
+            return false;
+        }
+    }
+
+    // largest bound of all backends: SSE 2.5e-7, NEON 1.5e-7, scalar 1.6e-7
+    for (float x = 1e-30f ; x < 1e30f ; x *= 1.01f) {
+        if (std::abs(rsqrt<accuracy_fast_t>(x) * std::sqrt(double(x)) - 1.0) > 2.5e-7) {
+            return false;
+        }
+    }
+
+    quat_t q = quat_axis_angle<accuracy_fast_t>(normalize(float3_t { 1, 2, 3 }), radians_t(1.0f));
+    quat_t precise = quat_t(normalize(float3_t { 1, 2, 3 }), radians_t(1.0f));
+    quat_t fast_slerp = slerp<accuracy_fast_t>(q, quat_t(), 0.5f);
+    quat_t precise_slerp = slerp(precise, quat_t(), 0.5f);
+    return std::abs(fast_slerp.x - precise_slerp.x) < 1e-5f && std::abs(fast_slerp.w - precise_slerp.w) < 1e-5f;
+}
+
+// angle of rotation between q1 and q2, atan2 keeps precision for nearly parallel quaternions
+static float quat_angle(const quat_t& q1, const quat_t& q2) {
+    quat_t d = -q1 * q2;
+    return 2.0f * std::atan2(length(d.xyz()), std::abs(d.w));
+}
+
+// batch interpolation must agree with scalar slerp, sampler must follow keys across forward playback and rewind
+static bool TestMathAnim() {
+    std::mt19937 random(11);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+    constexpr usize count = 23;
+    float data[13][count];
+    quat_soa_t q1 = { data[0], data[1], data[2], data[3] };
+    quat_soa_t q2 = { data[4], data[5], data[6], data[7] };
+    quat_soa_t out = { data[8], data[9], data[10], data[11] };
+    float* t = data[12];
+    for (usize i = 0 ; i < count ; i++) {
+        quat_t a = normalize(quat_t(distribution(random), distribution(random), distribution(random), distribution(random)));
+        quat_t b = normalize(quat_t(distribution(random), distribution(random), distribution(random), distribution(random)));
+        q1.x[i] = a.x; q1.y[i] = a.y; q1.z[i] = a.z; q1.w[i] = a.w;
+        q2.x[i] = b.x; q2.y[i] = b.y; q2.z[i] = b.z; q2.w[i] = b.w;
+        t[i] = distribution(random) * 0.5f + 0.5f;
+    }
+    // nearly parallel and opposite hemisphere lanes
+    q2.x[0] = q1.x[0]; q2.y[0] = q1.y[0]; q2.z[0] = q1.z[0]; q2.w[0] = q1.w[0];
+    q2.x[1] = -q1.x[1]; q2.y[1] = -q1.y[1]; q2.z[1] = -q1.z[1]; q2.w[1] = -q1.w[1];
+
+    slerp_soa<accuracy_fast_t>(q1, q2, t, out, count);
+    for (usize i = 0 ; i < count ; i++) {
+        quat_t a = { q1.x[i], q1.y[i], q1.z[i], q1.w[i] };
+        quat_t b = { q2.x[i], q2.y[i], q2.z[i], q2.w[i] };
+        quat_t r = { out.x[i], out.y[i], out.z[i], out.w[i] };
+        quat_t expected = slerp(a, b, t[i]);
+        if (quat_angle(r, expected) > 1e-3f || std::abs(length(r) - 1.0f) > 1e-5f) {
+            return false;
+        }
+        // slerp moves by constant angular velocity
+        if (std::abs(quat_angle(a, expected) - t[i] * quat_angle(a, b)) > 1e-3f) {
+            return false;
+        }
+    }
+
+    nlerp_soa<accuracy_fast_t>(q1, q2, t, out, count);
+    for (usize i = 0 ; i < count ; i++) {
+        quat_t r = { out.x[i], out.y[i], out.z[i], out.w[i] };
+        quat_t expected = slerp(quat_t { q1.x[i], q1.y[i], q1.z[i], q1.w[i] }, quat_t { q2.x[i], q2.y[i], q2.z[i], q2.w[i] }, t[i]);
+        if (quat_angle(r, expected) > 2e-3f) {
+            return false;
+        }
+    }
+
+    // 2 joints: rotation about y by 0, 90, 180 degrees at 0, 1, 2 seconds, and a translation ramp
+    float times[3] = { 0, 1, 2 };
+    quat_t rotation_keys[3] = {
+            quat_axis_angle(float3_t { 0, 1, 0 }, radians_t(0)),
+            quat_axis_angle(float3_t { 0, 1, 0 }, radians_t(0.5f * 1_PI)),
+            quat_axis_angle(float3_t { 0, 1, 0 }, radians_t(1_PI)),
+    };
+    quat_t tangents[3];
+    float3_t translation_keys[3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 2, 0, 0 } };
+    anim_track_float3_t translations[2] = { { times, translation_keys, 3 }, {} };
+    anim_track_quat_t rotations[2] = { { times, rotation_keys, tangents, 3 }, { times, rotation_keys, tangents, 3 } };
+    anim_track_compute_tangents(rotations[0], tangents);
+    anim_clip_t clip = { translations, rotations, translations, 2, 2.0f };
+
+    float sample[10][2];
+    float3_soa_t sample_translations = { sample[0], sample[1], sample[2] };
+    quat_soa_t sample_rotations = { sample[3], sample[4], sample[5], sample[6] };
+    float3_soa_t sample_scales = { sample[7], sample[8], sample[9] };
+
+    bool passed = true;
+    for (SF_ANIM_INTERPOLATION interpolation : { SF_ANIM_INTERPOLATION_NLERP, SF_ANIM_INTERPOLATION_SLERP, SF_ANIM_INTERPOLATION_SQUAD }) {
+        anim_sampler_t sampler = anim_sampler_init(clip, interpolation);
+        for (float time : { 0.25f, 1.0f, 1.5f, 1.75f, 2.5f, 0.5f }) {
+            anim_sample(sampler, time, sample_translations, sample_rotations, sample_scales);
+            quat_t r = { sample_rotations.x[0], sample_rotations.y[0], sample_rotations.z[0], sample_rotations.w[0] };
+            float expected = 0.5f * 1_PI * std::min(time, 2.0f);
+            // squad eases in and out of clamped end keys, so only keys are exact
+            bool exact = interpolation != SF_ANIM_INTERPOLATION_SQUAD || time == 1.0f || time >= 2.0f;
+            passed &= std::abs(quat_angle(r, quat_t()) - expected) < (exact ? 2e-3f : 0.15f);
+            passed &= std::abs(sample_translations.x[0] - std::min(time, 2.0f)) < 1e-6f;
+            passed &= sample_translations.x[1] == 0 && sample_scales.y[1] == 1;
+        }
+        anim_sampler_free(sampler);
+    }
+
+    // looping clip wraps time past duration back to the start
+    clip.looping = true;
+    anim_sampler_t sampler = anim_sampler_init(clip);
+    anim_sample(sampler, 4.5f, sample_translations, sample_rotations, sample_scales);
+    passed &= std::abs(sample_translations.x[0] - 0.5f) < 1e-6f;
+    anim_sampler_free(sampler);
+    return passed;
+}
+
+static constexpr float4x4_t constexpr_view = mat4_view({ 1, 2, 3 }, normalize(float3_t { 1, -1, 0.5f }), { 0, 1, 0 });
+static constexpr float4x4_t constexpr_projection = mat4_perspective(16.0f / 9.0f, degree_t(60), 0.1f, 100.0f);
+static constexpr float4x4_t constexpr_view_projection = constexpr_view * constexpr_projection;
+static constexpr float4x4_t constexpr_model = mat4_trs({ 1, 2, 3 }, quat_t(float3_t { 0, 1, 0 }, radians_t(1.0f)), { 2, 2, 2 });
+
+static_assert(mat4_identity()[3][3] == 1 && mat4_identity()[3][0] == 0, "identity must be constant");
+static_assert(transpose(constexpr_model)[0][3] == 1 && transpose(constexpr_model)[3][0] == 0, "transpose must be constant");
+static_assert(float4_t(float3_t { 1, 2, 3 }).w == 0 && dot(float4_t { 1, 2, 3, 4 }, float4_t { 1, 1, 1, 1 }) == 10, "float4 must be constant");
+
+static bool near_equal(const float4x4_t& m1, const float4x4_t& m2, float epsilon) {
+    for (int r = 0 ; r < 4 ; r++) {
+        for (int c = 0 ; c < 4 ; c++) {
+            if (std::abs(m1[r][c] - m2[r][c]) > epsilon) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// matrices built at compile time must agree with the runtime SIMD path
+static bool TestMathConstexpr() {
+    float3_t position = { 1, 2, 3 };
+    float3_t front = normalize(float3_t { 1, -1, 0.5f });
+    float4x4_t view = mat4_view(position, front, { 0, 1, 0 });
+    float4x4_t projection = mat4_perspective(16.0f / 9.0f, degree_t(60), 0.1f, 100.0f);
+    float4x4_t model = mat4_trs({ 1, 2, 3 }, quat_t(float3_t { 0, 1, 0 }, radians_t(1.0f)), { 2, 2, 2 });
+
+    return near_equal(view, constexpr_view, 1e-6f)
+        && near_equal(projection, constexpr_projection, 1e-5f)
+        && near_equal(view * projection, constexpr_view_projection, 1e-5f)
+        && near_equal(model, constexpr_model, 1e-6f);
+}
+
+// batched culling must agree with scalar tests, also after plane cache is warmed up by a previous frame
+static bool TestMathCulling() {
+    const float4x4_t view = mat4_view({ 0, 0, 0 }, { 0, 0, -1 }, { 0, 1, 0 });
+    const frustum_t frustum = frustum_init(view * mat4_perspective(1.0f, degree_t(90), 0.1f, 100.0f));
+    if (!frustum_test_sphere(frustum, { { 0, 0, -10 }, 1 }) || frustum_test_sphere(frustum, { { 0, 0, 10 }, 1 })
+        || frustum_test_aabb(frustum, { { 20, -1, -11 }, { 22, 1, -9 } }) || !frustum_test_aabb(frustum, { { 9, -1, -11 }, { 12, 1, -9 } })) {
+        return false;
+    }
+
+    std::mt19937 random(4);
+    std::uniform_real_distribution<float> distribution(-120.0f, 120.0f);
+    const usize count = 1003;
+    std::vector<float> data(count * 6);
+    const sphere_soa_t spheres = { data.data(), data.data() + count, data.data() + count * 2, data.data() + count * 3 };
+    const aabb_soa_t aabbs = { { spheres.x, spheres.y, spheres.z }, { spheres.radius, data.data() + count * 4, data.data() + count * 5 } };
+    std::vector<u8> sphere_cache(count, 0);
+    std::vector<u8> aabb_cache(count, 0);
+    std::vector<u32> visible(count);
+
+    for (int frame = 0 ; frame < 2 ; frame++) {
+        for (usize i = 0 ; i < count * 6 ; i++) {
+            data[i] = i < count * 3 ? distribution(random) : 1.0f + std::abs(distribution(random)) * 0.05f;
+        }
+
+        u32 visible_count = frustum_cull_spheres(frustum, spheres, count, sphere_cache.data(), visible.data());
+        u32 expected = 0;
+        for (usize i = 0 ; i < count ; i++) {
+            if (frustum_test_sphere(frustum, { { spheres.x[i], spheres.y[i], spheres.z[i] }, spheres.radius[i] })) {
+                if (expected >= visible_count || visible[expected++] != i) {
+                    return false;
+                }
+            }
+        }
+        if (expected != visible_count) {
+            return false;
+        }
+
+        visible_count = frustum_cull_aabbs(frustum, aabbs, count, aabb_cache.data(), visible.data());
+        expected = 0;
+        for (usize i = 0 ; i < count ; i++) {
+            const float3_t c = { aabbs.center.x[i], aabbs.center.y[i], aabbs.center.z[i] };
+            const float3_t e = { aabbs.extents.x[i], aabbs.extents.y[i], aabbs.extents.z[i] };
+            if (frustum_test_aabb(frustum, { c - e, c + e })) {
+                if (expected >= visible_count || visible[expected++] != i) {
+                    return false;
+                }
+            }
+        }
+        if (expected != visible_count || visible_count == 0 || visible_count == count) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// basis must follow yaw and pitch and stay the same when orientation is rebuilt again without changes
+static bool TestMathCameraOrientation() {
+    camera_t camera;
+    camera.yaw = 0.5f;
+    camera.pitch = 0.2f;
+    const float3_t expected_front = { std::sin(0.5f) * std::cos(0.2f), -std::sin(0.2f), -std::cos(0.5f) * std::cos(0.2f) };
+
+    for (int frame = 0 ; frame < 3 ; frame++) {
+        camera.dirty |= SF_CAMERA_DIRTY_ORIENTATION;
+        camera_update(camera);
+        if (length(camera.front - expected_front) > 1e-5f || std::abs(dot(camera.front, camera.up)) > 1e-5f || camera.up.y <= 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static aabb_t random_aabb(std::mt19937& random) {
+    std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+    std::uniform_real_distribution<float> size(0.1f, 3.0f);
+    const float3_t min = { position(random), position(random), position(random) };
+    return { min, min + float3_t { size(random), size(random), size(random) } };
+}
+
+static bool equal_sets(std::vector<u32> a, std::vector<u32> b) {
+    std::sort(a.begin(), a.end());
+    std::sort(b.begin(), b.end());
+    return a == b;
+}
+
+// every query must find the same primitives as a linear scan, before and after refit
+static bool TestMathBvh() {
+    std::mt19937 random(5);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    const u32 count = 777;
+    std::vector<aabb_t> bounds(count);
+    for (aabb_t& aabb : bounds) {
+        aabb = random_aabb(random);
+    }
+
+    bvh_t bvh = bvh_init(bounds.data(), count);
+    std::vector<u32> found(count);
+    const frustum_t frustum = frustum_init(mat4_view({ 0, 0, 60 }, { 0, 0, -1 }, { 0, 1, 0 }) * mat4_perspective(1.0f, degree_t(40), 0.1f, 100.0f));
+
+    for (int pass = 0 ; pass < 2 ; pass++) {
+        for (int i = 0 ; i < 200 ; i++) {
+            ray_t rays[4];
+            bvh_hit_t packet_hits[4];
+            for (ray_t& ray : rays) {
+                ray = { { distribution(random) * 60, distribution(random) * 60, 70 }, { distribution(random) * 0.3f, distribution(random) * 0.3f, -1 } };
+            }
+            bvh_raycast_packet(bvh, rays, packet_hits);
+
+            for (int j = 0 ; j < 4 ; j++) {
+                bvh_hit_t expected;
+                const float3_t inv_direction = ray_inverse_direction(rays[j]);
+                for (u32 k = 0 ; k < count ; k++) {
+                    float t;
+                    if (ray_intersect_aabb(rays[j].origin, inv_direction, bounds[k], std::numeric_limits<float>::max(), t)
+                        && (expected.index == SF_BVH_INVALID || t < expected.t)) {
+                        expected = { k, t };
+                    }
+                }
+                const bvh_hit_t hit = bvh_raycast(bvh, rays[j]);
+                if ((hit.index == SF_BVH_INVALID) != (expected.index == SF_BVH_INVALID) || hit.t != expected.t) {
+                    return false;
+                }
+                if ((hit.index == SF_BVH_INVALID) != (packet_hits[j].index == SF_BVH_INVALID) || hit.t != packet_hits[j].t) {
+                    return false;
+                }
+            }
+
+            const sphere_t sphere = { { distribution(random) * 50, distribution(random) * 50, distribution(random) * 50 }, 8 };
+            std::vector<u32> expected;
+            for (u32 k = 0 ; k < count ; k++) {
+                if (sphere_overlaps_aabb(sphere, bounds[k])) {
+                    expected.push_back(k);
+                }
+            }
+            const u32 found_count = bvh_query_sphere(bvh, sphere, found.data(), count);
+            if (!equal_sets({ found.begin(), found.begin() + found_count }, expected)) {
+                return false;
+            }
+        }
+
+        std::vector<u32> expected;
+        for (u32 k = 0 ; k < count ; k++) {
+            if (frustum_test_aabb(frustum, bounds[k])) {
+                expected.push_back(k);
+            }
+        }
+        const u32 found_count = bvh_query_frustum(bvh, frustum, found.data(), count);
+        if (expected.empty() || expected.size() == count || !equal_sets({ found.begin(), found.begin() + found_count }, expected)) {
+            return false;
+        }
+
+        for (aabb_t& aabb : bounds) {
+            const float3_t offset = { distribution(random) * 5, distribution(random) * 5, distribution(random) * 5 };
+            aabb = { aabb.min + offset, aabb.max + offset };
+        }
+        bvh_refit(bvh, bounds.data());
+    }
+
+    bvh_free(bvh);
+    return true;
+}
+
+// grid queries must match a linear scan over live proxies after inserts, moves and removals
+static bool TestMathSpatialGrid() {
+    std::mt19937 random(6);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    const u32 count = 600;
+    std::vector<u8> memory(64 * 1024);
+    memory_arena_t arena = memory_arena_init(memory.data(), memory.size());
+    spatial_grid_t grid = spatial_grid_init(arena, count, 256, 4.0f);
+
+    std::vector<u32> proxies(count);
+    std::vector<bool> alive(count, true);
+    for (u32 i = 0 ; i < count ; i++) {
+        proxies[i] = spatial_grid_insert(grid, random_aabb(random), i);
+    }
+
+    std::vector<u32> found(count);
+    std::vector<spatial_grid_pair_t> pairs(count * count / 2);
+
+    for (int frame = 0 ; frame < 3 ; frame++) {
+        for (u32 i = 0 ; i < count ; i++) {
+            if (!alive[i]) {
+                continue;
+            }
+            if (i % 17 == u32(frame)) {
+                spatial_grid_remove(grid, proxies[i]);
+                alive[i] = false;
+                continue;
+            }
+            const aabb_t& bounds = grid.proxies[proxies[i]].bounds;
+            const float3_t offset = { distribution(random) * 3, distribution(random) * 3, distribution(random) * 3 };
+            spatial_grid_move(grid, proxies[i], { bounds.min + offset, bounds.max + offset });
+        }
+
+        for (int q = 0 ; q < 50 ; q++) {
+            const aabb_t query = random_aabb(random);
+            std::vector<u32> expected;
+            for (u32 i = 0 ; i < count ; i++) {
+                if (alive[i] && aabb_overlaps(query, grid.proxies[proxies[i]].bounds)) {
+                    expected.push_back(proxies[i]);
+                }
+            }
+            const u32 found_count = spatial_grid_query(grid, query, found.data(), count);
+            if (!equal_sets({ found.begin(), found.begin() + found_count }, expected)) {
+                return false;
+            }
+        }
+
+        u32 expected_pairs = 0;
+        for (u32 a = 0 ; a < grid.proxy_end ; a++) {
+            for (u32 b = a + 1 ; b < grid.proxy_end ; b++) {
+                const spatial_grid_proxy_t& pa = grid.proxies[a];
+                const spatial_grid_proxy_t& pb = grid.proxies[b];
+                if (pa.bucket != SF_SPATIAL_GRID_INVALID && pb.bucket != SF_SPATIAL_GRID_INVALID && aabb_overlaps(pa.bounds, pb.bounds)) {
+                    expected_pairs++;
+                }
+            }
+        }
+        const u32 pair_count = spatial_grid_query_pairs(grid, 0, grid.proxy_end, pairs.data(), u32(pairs.size()));
+        if (pair_count != expected_pairs || pair_count == 0) {
+            return false;
+        }
+        for (u32 i = 0 ; i < pair_count ; i++) {
+            if (pairs[i].a >= pairs[i].b || !aabb_overlaps(grid.proxies[pairs[i].a].bounds, grid.proxies[pairs[i].b].bounds)) {
+                return false;
+            }
+        }
+    }
 
-static bool TestMath() {
     return true;
 }
 
+// parallel queries must store and count the same proxies and pairs as single threaded ones, also when pairs don't fit
+static bool TestMathSpatialGridParallel() {
+    std::mt19937 random(11);
+    const u32 count = 500;
+    std::vector<u8> memory(64 * 1024);
+    memory_arena_t arena = memory_arena_init(memory.data(), memory.size());
+    spatial_grid_t grid = spatial_grid_init(arena, count, 256, 4.0f, 3);
+    for (u32 i = 0 ; i < count ; i++) {
+        // boxes are moved closer together, so there are enough pairs to split between chunks
+        const aabb_t bounds = random_aabb(random);
+        const float3_t offset = bounds.min * -0.7f;
+        spatial_grid_insert(grid, { bounds.min + offset, bounds.max + offset }, i);
+    }
+
+    thread_pool_t<test_allocator_t> thread_pool = thread_pool_init<test_allocator_t>(3, 16, "TestMath", SF_THREAD_PRIORITY_NORMAL);
+    thread_pool_run(thread_pool);
+    bool passed = true;
+
+    const u32 query_count = 64;
+    const u32 capacity = 32;
+    std::vector<aabb_t> queries(query_count);
+    for (aabb_t& query : queries) {
+        query = random_aabb(random);
+    }
+    std::vector<u32> proxies(query_count * capacity);
+    std::vector<u32> counts(query_count);
+    spatial_grid_query_parallel(thread_pool, grid, queries.data(), query_count, proxies.data(), capacity, counts.data());
+    std::vector<u32> expected(capacity);
+    for (u32 i = 0 ; i < query_count && passed ; i++) {
+        const u32 found = spatial_grid_query(grid, queries[i], expected.data(), capacity);
+        passed = counts[i] == found && std::memcmp(&proxies[i * capacity], expected.data(), sizeof(u32) * std::min(found, capacity)) == 0;
+    }
+
+    std::vector<spatial_grid_pair_t> expected_pairs(count * count / 2);
+    const u32 expected_count = spatial_grid_query_pairs(grid, 0, grid.proxy_end, expected_pairs.data(), u32(expected_pairs.size()));
+    passed &= expected_count > 16;
+    // enough room for all pairs, room for only a part of them in a single chunk, no room at all
+    const u32 pair_capacities[3] = { u32(expected_pairs.size()), expected_count / 2, 0 };
+    for (u32 pair_capacity : pair_capacities) {
+        std::vector<spatial_grid_pair_t> pairs(std::max(pair_capacity, 1u));
+        const u32 found = spatial_grid_query_pairs_parallel(thread_pool, grid, pairs.data(), pair_capacity);
+        passed &= found == expected_count && std::memcmp(pairs.data(), expected_pairs.data(), sizeof(spatial_grid_pair_t) * std::min(found, pair_capacity)) == 0;
+    }
+
+    thread_pool_free(thread_pool);
+    return passed;
+}
+
+// parallel_for must not wait for the queue, when pool isn't running and its queue is full, chunks are run by the caller
+static bool TestMathThreadPoolFull() {
+    thread_pool_t<test_allocator_t> thread_pool = thread_pool_init<test_allocator_t>(3, 2, "TestMath", SF_THREAD_PRIORITY_NORMAL);
+    bool passed = true;
+    for (u32 pass = 0 ; pass < 2 ; pass++) {
+        std::vector<u32> values(100, 0);
+        thread_pool_parallel_for(thread_pool, u32(values.size()), [&](u32, u32 begin, u32 end) {
+            for (u32 i = begin ; i < end ; i++) {
+                values[i] = i;
+            }
+        });
+        for (u32 i = 0 ; i < values.size() ; i++) {
+            passed &= values[i] == i;
+        }
+    }
+    thread_pool_free(thread_pool);
+    return passed;
+}
+
+static bool near_equal(const frustum_t& f1, const frustum_t& f2, float epsilon) {
+    for (int i = 0 ; i < SF_FRUSTUM_PLANE_COUNT ; i++) {
+        const plane_t& p1 = f1.planes[i];
+        const plane_t& p2 = f2.planes[i];
+        if (length(p1.normal - p2.normal) > epsilon || std::abs(p1.distance - p2.distance) > epsilon * std::max(1.0f, std::abs(p2.distance))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// batched cameras must agree with matrices of single camera, cascades must cover their slices
+static bool TestMathCameraSet() {
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    const u32 count = 11;
+    camera_set_t camera_set = camera_set_init(count);
+    camera_t cameras[count];
+
+    for (camera_t& camera : cameras) {
+        camera.position = { distribution(random) * 20, distribution(random) * 20, distribution(random) * 20 };
+        camera.front = normalize(float3_t { distribution(random), distribution(random) * 0.5f, distribution(random) });
+        camera.fov = 45.0f + distribution(random) * 20.0f;
+        camera.aspect_ratio = 1.5f + distribution(random) * 0.3f;
+        camera.z_near = 0.1f + distribution(random) * 0.05f;
+        camera.z_far = 200.0f + distribution(random) * 50.0f;
+        camera_set_add(camera_set, camera);
+    }
+    camera_set_update(camera_set);
+
+    for (u32 i = 0 ; i < count ; i++) {
+        const camera_t& camera = cameras[i];
+        const float4x4_t view = mat4_view(camera.position, camera.front, camera.up);
+        const float4x4_t perspective = mat4_perspective(camera.aspect_ratio, degree_t(camera.fov), camera.z_near, camera.z_far);
+        if (!near_equal(view, camera_set.views[i], 1e-4f) || !near_equal(perspective, camera_set.perspectives[i], 1e-4f)
+            || !near_equal(view * perspective, camera_set.view_projections[i], 1e-3f)
+            || !near_equal(frustum_init(view * perspective), camera_set.frustums[i], 1e-4f)) {
+            return false;
+        }
+    }
+    camera_set_free(camera_set);
+
+    camera_t& camera = cameras[0];
+    float splits[5];
+    float4x4_t cascades[4];
+    camera_cascade_splits(camera.z_near, camera.z_far, 4, 0.75f, splits);
+    const float3_t light = normalize(float3_t { 0.3f, -1.0f, 0.2f });
+    const float caster_distance = 100.0f;
+    camera_cascade_matrices(camera, light, splits, 4, 2048, caster_distance, cascades);
+    const float tan_y = std::tan(0.5f * float(radians_t(degree_t(camera.fov))));
+    const float3_t right = normalize(cross(camera.front, camera.up));
+    const float3_t up = cross(right, camera.front);
+
+    for (u32 i = 0 ; i < 4 ; i++) {
+        if (!(splits[i] < splits[i + 1])) {
+            return false;
+        }
+        // corners of the slice must land inside of light clip volume
+        for (int corner = 0 ; corner < 8 ; corner++) {
+            const float depth = splits[i + (corner & 1)];
+            const float sx = corner & 2 ? 1.0f : -1.0f;
+            const float sy = corner & 4 ? 1.0f : -1.0f;
+            const float3_t p = camera.position + camera.front * depth + right * (sx * depth * tan_y * camera.aspect_ratio) + up * (sy * depth * tan_y);
+            const float4_t clip = (float4x4_t { { p.x, p.y, p.z, 1 }, { 0, 0, 0, 0 }, { 0, 0, 0, 0 }, { 0, 0, 0, 0 } } * cascades[i])[0];
+            if (std::abs(clip.x) > 1.001f || std::abs(clip.y) > 1.001f || clip.z < -0.001f || clip.z > 1.001f) {
+                return false;
+            }
+            // caster between the light and the slice must not be clipped by near plane
+            const float3_t caster = p - light * (0.9f * caster_distance);
+            const float4_t caster_clip = (float4x4_t { { caster.x, caster.y, caster.z, 1 }, { 0, 0, 0, 0 }, { 0, 0, 0, 0 }, { 0, 0, 0, 0 } } * cascades[i])[0];
+            if (caster_clip.z < -0.001f || caster_clip.z >= clip.z) {
+                return false;
+            }
+        }
+    }
+
+    return splits[0] == camera.z_near && splits[4] == camera.z_far;
+}
+
+// motion must follow the same curve at 30 Hz and 144 Hz and settle on targets
+static bool TestMathCameraMotion() {
+    camera_t cameras[2];
+    const float rates[2] = { 30.0f, 144.0f };
+    for (int i = 0 ; i < 2 ; i++) {
+        camera_t& camera = cameras[i];
+        camera.fov = 45.0f;
+        camera_motion_reset(camera);
+        camera.target_position = { 10, 0, -1 };
+        camera.target_fov = 30.0f;
+        for (float time = 0 ; time < 0.2f ; time += 1.0f / rates[i]) {
+            camera_update_motion(camera, 1.0f / rates[i]);
+        }
+    }
+
+    if (std::abs(cameras[0].position.x - cameras[1].position.x) > 0.3f || cameras[0].position.x <= 5.0f || cameras[0].position.x >= 10.0f) {
+        return false;
+    }
+
+    for (int frame = 0 ; frame < 300 ; frame++) {
+        camera_update_motion(cameras[0], 1.0f / 30.0f);
+    }
+    return std::abs(cameras[0].position.x - 10.0f) < 1e-3f && std::abs(cameras[0].fov - 30.0f) < 1e-3f;
+}
+
+// damp must cover the same distance in one step and in many smaller steps, vectors are damped per component
+static bool TestMathDampFrameRateIndependent() {
+    float x = 0;
+    for (int i = 0 ; i < 10 ; i++) {
+        x = damp(x, 1.0f, 5.0f, 0.01f);
+    }
+    const float3_t v = damp(float3_t { 0, 0, 0 }, float3_t { 1, 2, 4 }, 5.0f, 0.1f);
+    return std::abs(x - damp(0.0f, 1.0f, 5.0f, 0.1f)) < 1e-6f && std::abs(v.z - 4.0f * x) < 1e-5f;
+}
+
+// values outside of [min, max] are moved to the nearest bound, values inside are kept
+static bool TestMathClampRange() {
+    return clamp(1.0f, 45.0f, 60.0f) == 45.0f && clamp(1.0f, 45.0f, -1.0f) == 1.0f && clamp(1.0f, 45.0f, 30.0f) == 30.0f;
+}
+
+static bool TestMathRebase() {
+    const double3_t origin = { 1e7, -3e6, 5e8 };
+    const usize count = 23;
+    std::vector<double> x(count), y(count), z(count);
+    std::vector<float> rx(count), ry(count), rz(count);
+    for (usize i = 0 ; i < count ; i++) {
+        x[i] = origin.x + 0.001 * double(i);
+        y[i] = origin.y - 0.25 * double(i);
+        z[i] = origin.z + 1000.125 * double(i);
+    }
+
+    rebase_soa({ x.data(), y.data(), z.data() }, origin, { rx.data(), ry.data(), rz.data() }, count);
+    for (usize i = 0 ; i < count ; i++) {
+        const float3_t p = rebase({ x[i], y[i], z[i] }, origin);
+        if (rx[i] != p.x || ry[i] != p.y || rz[i] != p.z || std::abs(p.x - 0.001f * float(i)) > 1e-6f) {
+            return false;
+        }
+    }
+
+    camera_t camera;
+    camera.origin = origin;
+    camera.position = { 600, 0, 0 };
+    camera.target_position = { 700, 0, 0 };
+    if (camera_rebase(camera, 1000.0) || !camera_rebase(camera, 500.0)) {
+        return false;
+    }
+    const double3_t world = camera_get_world_position(camera);
+    return world.x == origin.x + 600.0 && camera.position.x == 0 && camera.target_position.x == 100.0f
+        && (camera.dirty & SF_CAMERA_DIRTY_VIEW) != 0;
+}
+
+// quad split by a diagonal through pixel centers must cover every pixel once, nearer triangle must win regardless of order
+static bool TestMathRaster() {
+    const u32 width = 100;
+    const u32 height = 100;
+    std::vector<u32> color(width * height);
+    raster_t raster = raster_init(width, height, 16);
+    raster_set_color(raster, color.data(), width);
+
+    const float4x4_t identity = mat4_identity();
+    const float3_t quad[4] = { { -1, -1, 0.5f }, { 1, -1, 0.5f }, { 1, 1, 0.5f }, { -1, 1, 0.5f } };
+    const u32 triangles[2][3] = { { 0, 1, 2 }, { 2, 3, 0 } };
+    u32 coverage[width * height] = {};
+    for (u32 i = 0 ; i < 2 ; i++) {
+        raster_clear(raster, 0);
+        raster_submit(raster, identity, quad, triangles[i], 3, 1);
+        raster_render(raster);
+        for (u32 p = 0 ; p < width * height ; p++) {
+            coverage[p] += color[p];
+        }
+    }
+    for (u32 p = 0 ; p < width * height ; p++) {
+        if (coverage[p] != 1) {
+            raster_free(raster);
+            return false;
+        }
+    }
+
+    // near triangle is submitted between the quad and the far triangle
+    const float3_t near_triangle[3] = { { -0.5f, -0.5f, 0.25f }, { 0.5f, -0.5f, 0.25f }, { 0, 0.5f, 0.25f } };
+    const float3_t far_triangle[3] = { { -0.5f, -0.5f, 0.75f }, { 0.5f, -0.5f, 0.75f }, { 0, 0.5f, 0.75f } };
+    const u32 indices[6] = { 0, 1, 2, 2, 3, 0 };
+    raster_clear(raster, 0);
+    raster_submit(raster, identity, quad, indices, 6, 1);
+    raster_submit(raster, identity, near_triangle, indices, 3, 2);
+    raster_submit(raster, identity, far_triangle, indices, 3, 3);
+    raster_render(raster);
+
+    const u32 center = (height / 2) * width + width / 2;
+    const bool passed = color[0] == 1 && color[center] == 2 && raster.depth[(height / 2) * raster.stride + width / 2] == 0.25f
+        && raster.depth[(height - 1) * raster.stride + width - 1] == 0.5f;
+    raster_free(raster);
+    return passed;
+}
+
+// triangle crossing near plane is clipped into two, the one over capacity must be dropped and counted
+static bool TestMathRasterCapacity() {
+    raster_t raster = raster_init(64, 64, 1);
+    const float3_t triangle[3] = { { -1, -1, -0.5f }, { 1, -1, 0.5f }, { 0, 1, 0.5f } };
+    const u32 indices[3] = { 0, 1, 2 };
+    const u32 stored = raster_submit(raster, mat4_identity(), triangle, indices, 3, 1);
+    bool passed = stored == 1 && raster.triangle_count == 1 && raster.dropped_count == 1;
+    raster_clear(raster);
+    passed &= raster.triangle_count == 0 && raster.dropped_count == 0;
+    raster_free(raster);
+    return passed;
+}
+
+// tiles rendered by pool threads must give the same depth and color as single threaded render
+static bool TestMathRasterParallel() {
+    std::mt19937 random(12);
+    std::uniform_real_distribution<float> distribution(-1.2f, 1.2f);
+    std::uniform_real_distribution<float> depth(0.05f, 0.95f);
+    const u32 width = 300;
+    const u32 height = 200;
+    const u32 count = 300;
+    std::vector<float3_t> positions(count * 3);
+    std::vector<u32> indices(count * 3);
+    for (u32 i = 0 ; i < count * 3 ; i++) {
+        positions[i] = { distribution(random), distribution(random), depth(random) };
+        indices[i] = i;
+    }
+
+    std::vector<u32> colors[2] = { std::vector<u32>(width * height), std::vector<u32>(width * height) };
+    std::vector<float> depths[2];
+    thread_pool_t<test_allocator_t> thread_pool = thread_pool_init<test_allocator_t>(3, 16, "TestMath", SF_THREAD_PRIORITY_NORMAL);
+    thread_pool_run(thread_pool);
+    raster_t raster = raster_init(width, height, count);
+    for (u32 pass = 0 ; pass < 2 ; pass++) {
+        raster_set_color(raster, colors[pass].data(), width);
+        raster_clear(raster, 0);
+        for (u32 i = 0 ; i < count ; i++) {
+            raster_submit(raster, mat4_identity(), positions.data(), &indices[i * 3], 3, i + 1);
+        }
+        if (pass == 0) {
+            raster_render(raster);
+        } else {
+            raster_render_parallel(thread_pool, raster);
+        }
+        depths[pass].assign(raster.depth, raster.depth + usize(raster.stride) * height);
+    }
+    raster_free(raster);
+    thread_pool_free(thread_pool);
+
+    return colors[0] == colors[1] && depths[0] == depths[1] && std::count(colors[0].begin(), colors[0].end(), 0u) < width * height / 4;
+}
+
+// wall in front of the camera must hide boxes behind it, but not boxes in front of it, beside it or crossing near plane
+static bool TestMathOcclusion() {
+    const float4x4_t view_projection = mat4_view({ 0, 0, 0 }, { 0, 0, -1 }, { 0, 1, 0 }) * mat4_perspective(2.0f, degree_t(60.0f), 0.1f, 100.0f);
+    const float3_t wall[4] = { { -4, -4, -5 }, { 4, -4, -5 }, { 4, 4, -5 }, { -4, 4, -5 } };
+    const u32 indices[6] = { 0, 1, 2, 2, 3, 0 };
+
+    occlusion_t occlusion = occlusion_init(16);
+    occlusion_begin(occlusion, view_projection);
+    occlusion_add_occluder(occlusion, mat4_identity(), wall, indices, 6);
+    occlusion_render(occlusion);
+
+    const aabb_t aabbs[5] = {
+            { { -1, -1, -11 }, { 1, 1, -9 } },
+            { { -1, -1, -3 }, { 1, 1, -2 } },
+            { { 8, -1, -11 }, { 10, 1, -9 } },
+            { { -1, -1, -1 }, { 1, 1, 1 } },
+            { { -3.9f, -3.9f, -20 }, { 3.9f, 3.9f, -5.5f } }
+    };
+    u32 visible[5];
+    const u32 visible_count = occlusion_cull_aabbs(occlusion, aabbs, 5, visible);
+    occlusion_free(occlusion);
+    return visible_count == 3 && visible[0] == 1 && visible[1] == 2 && visible[2] == 3;
+}
+
+// occluder edge covers the center of a pixel, box reaching into the rest of that pixel must stay visible
+static bool TestMathOcclusionSilhouette() {
+    // with identity view projection screen x = (x * 0.5 + 0.5) * width, depth = z
+    const float pixel = 2.0f / float(SF_OCCLUSION_WIDTH);
+    const float wall_x = 100.7f * pixel - 1.0f;
+    const float3_t wall[4] = { { -1, -1, 0.5f }, { wall_x, -1, 0.5f }, { wall_x, 1, 0.5f }, { -1, 1, 0.5f } };
+    const u32 indices[6] = { 0, 1, 2, 2, 3, 0 };
+
+    occlusion_t occlusion = occlusion_init(16);
+    occlusion_begin(occlusion, mat4_identity());
+    occlusion_add_occluder(occlusion, mat4_identity(), wall, indices, 6);
+    occlusion_render(occlusion);
+
+    const aabb_t inside = { { 50.0f * pixel - 1.0f, -0.5f, 0.6f }, { 90.0f * pixel - 1.0f, 0.5f, 0.7f } };
+    const aabb_t edge = { { 50.0f * pixel - 1.0f, -0.5f, 0.6f }, { 100.9f * pixel - 1.0f, 0.5f, 0.7f } };
+    const bool passed = !occlusion_test_aabb(occlusion, inside) && occlusion_test_aabb(occlusion, edge);
+    occlusion_free(occlusion);
+    return passed;
+}
+
+// parallel render and box tests must agree with single threaded ones
+static bool TestMathOcclusionParallel() {
+    std::mt19937 random(13);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    const float4x4_t view_projection = mat4_view({ 0, 0, 0 }, { 0, 0, -1 }, { 0, 1, 0 }) * mat4_perspective(2.0f, degree_t(60.0f), 0.1f, 100.0f);
+    const u32 indices[6] = { 0, 1, 2, 2, 3, 0 };
+    const u32 wall_count = 8;
+    const u32 box_count = 500;
+
+    thread_pool_t<test_allocator_t> thread_pool = thread_pool_init<test_allocator_t>(3, 16, "TestMath", SF_THREAD_PRIORITY_NORMAL);
+    thread_pool_run(thread_pool);
+    occlusion_t occlusions[2] = { occlusion_init(wall_count * 2), occlusion_init(wall_count * 2) };
+    for (occlusion_t& occlusion : occlusions) {
+        occlusion_begin(occlusion, view_projection);
+    }
+    for (u32 i = 0 ; i < wall_count ; i++) {
+        const float x = distribution(random) * 6;
+        const float y = distribution(random) * 3;
+        const float z = -6 - (distribution(random) + 1) * 4;
+        const float3_t wall[4] = { { x - 2, y - 2, z }, { x + 2, y - 2, z }, { x + 2, y + 2, z }, { x - 2, y + 2, z } };
+        for (occlusion_t& occlusion : occlusions) {
+            occlusion_add_occluder(occlusion, mat4_identity(), wall, indices, 6);
+        }
+    }
+    occlusion_render(occlusions[0]);
+    occlusion_render_parallel(thread_pool, occlusions[1]);
+
+    const raster_t& raster = occlusions[0].raster;
+    const usize depth_size = usize(raster.stride) * raster.height;
+    bool passed = std::memcmp(raster.depth, occlusions[1].raster.depth, sizeof(float) * depth_size) == 0;
+
+    std::vector<aabb_t> aabbs(box_count);
+    for (aabb_t& aabb : aabbs) {
+        const float3_t center = { distribution(random) * 10, distribution(random) * 5, -1 - (distribution(random) + 1) * 15 };
+        aabb = { center - float3_t { 0.5f, 0.5f, 0.5f }, center + float3_t { 0.5f, 0.5f, 0.5f } };
+    }
+    std::vector<u8> visible(box_count);
+    occlusion_test_aabbs_parallel(thread_pool, occlusions[1], aabbs.data(), box_count, visible.data());
+    u32 hidden = 0;
+    for (u32 i = 0 ; i < box_count ; i++) {
+        const bool expected = occlusion_test_aabb(occlusions[0], aabbs[i]);
+        passed &= visible[i] == (expected ? 1 : 0);
+        hidden += expected ? 0 : 1;
+    }
+
+    for (occlusion_t& occlusion : occlusions) {
+        occlusion_free(occlusion);
+    }
+    thread_pool_free(thread_pool);
+    // both outcomes have to be present, otherwise the comparison proves nothing
+    return passed && hidden > 0 && hidden < box_count;
+}
+
+static bool TestMath() {
+    bool passed = true;
+    passed &= TestMathSimd();
+    passed &= TestMathSoa();
+    passed &= TestMathInverse();
+    passed &= TestMathAccuracy();
+    passed &= TestMathAnim();
+    passed &= TestMathConstexpr();
+    passed &= TestMathCulling();
+    passed &= TestMathCameraOrientation();
+    passed &= TestMathBvh();
+    passed &= TestMathSpatialGrid();
+    passed &= TestMathSpatialGridParallel();
+    passed &= TestMathThreadPoolFull();
+    passed &= TestMathCameraSet();
+    passed &= TestMathCameraMotion();
+    passed &= TestMathDampFrameRateIndependent();
+    passed &= TestMathClampRange();
+    passed &= TestMathRebase();
+    passed &= TestMathRaster();
+    passed &= TestMathRasterCapacity();
+    passed &= TestMathRasterParallel();
+    passed &= TestMathOcclusion();
+    passed &= TestMathOcclusionSilhouette();
+    passed &= TestMathOcclusionParallel();
+    return passed;
+}
+
 #if defined(T3D_ANDROID)
 
 #include <Jni.hpp>
@@ -18,9 +1057,13 @@ Java_com_cheerwizard_touch3d_MathNativeTest_test(
 
 #else
 
+// headless platform tests, see TestPlatform.cpp
+bool TestPlatform();
+
 int main() {
-    TestMath();
-    return 0;
+    const bool math = TestMath();
+    const bool platform = TestPlatform();
+    return math && platform ? 0 : 1;
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,245 @@
+#include <sf_platform.hpp>
+
+#include <vector>
+
+using namespace sf;
+
+#define SF_TEST_PUBLISH_COUNT 20000
+
+// writer changes cursor and raw motion together, so a torn snapshot would break the relation between them
+static void TestPlatformPublish(void*) {
+    for (int i = 1 ; i <= SF_TEST_PUBLISH_COUNT ; i++) {
+        input_set_cursor(i, -i);
+        input_add_raw_motion(1, 2);
+        input_publish();
+    }
+}
+
+// snapshots taken during publishes must always be whole and never go back in time
+static bool TestPlatformInputState() {
+    input_set_key(SF_KEYCODE_W, true);
+    input_set_mouse(SF_MOUSE_CODE_BTN_RIGHT, true);
+    input_publish();
+    input_state_t base = input_get_state();
+    if (!input_key_is_pressed(base, SF_KEYCODE_W) || input_key_is_pressed(base, SF_KEYCODE_S)
+        || !input_mouse_is_pressed(base, SF_MOUSE_CODE_BTN_RIGHT) || input_mouse_is_pressed(base, SF_MOUSE_CODE_BTN_LEFT)) {
+        return false;
+    }
+
+    thread_t writer = thread_init("TestPlatform", SF_THREAD_PRIORITY_NORMAL);
+    writer.run_function = TestPlatformPublish;
+    thread_run(writer);
+
+    bool passed = true;
+    u64 version = base.version;
+    while (passed && version < base.version + SF_TEST_PUBLISH_COUNT) {
+        const input_state_t state = input_get_state();
+        const int published = static_cast<int>(state.version - base.version);
+        passed = state.version >= version && input_key_is_pressed(state, SF_KEYCODE_W)
+            && (published == 0 || (state.cursor.x == published && state.cursor.y == -published))
+            && state.raw_motion_x - base.raw_motion_x == published && state.raw_motion_y - base.raw_motion_y == 2 * published;
+        version = state.version;
+    }
+
+    thread_join(writer);
+    input_set_key(SF_KEYCODE_W, false);
+    input_set_mouse(SF_MOUSE_CODE_BTN_RIGHT, false);
+    input_publish();
+    return passed;
+}
+
+static void TestPlatformDrainEvents() {
+    input_event_t event;
+    while (input_pop_event(event, ~0ull)) {
+    }
+}
+
+// full queue must reject and count new events, kept events must come out in order and only when they are due
+static bool TestPlatformEventQueue() {
+    TestPlatformDrainEvents();
+    const u32 dropped = input_get_dropped_event_count();
+
+    input_event_t event;
+    event.type = SF_INPUT_EVENT_KEY_PRESS;
+    for (u32 i = 0 ; i < SF_INPUT_EVENT_QUEUE_SIZE ; i++) {
+        event.time_ns = i + 1;
+        event.code = static_cast<u16>(i);
+        if (!input_push_event(event)) {
+            return false;
+        }
+    }
+    for (u32 i = 0 ; i < 3 ; i++) {
+        if (input_push_event(event)) {
+            return false;
+        }
+    }
+    if (input_get_dropped_event_count() != dropped + 3) {
+        return false;
+    }
+
+    u32 count = 0;
+    while (input_pop_event(event, 10)) {
+        if (event.code != count || event.time_ns != count + 1) {
+            return false;
+        }
+        count++;
+    }
+    // popped events make room for new ones
+    if (count != 10 || !input_push_event(event)) {
+        return false;
+    }
+    while (input_pop_event(event, ~0ull)) {
+        count++;
+    }
+    return count == SF_INPUT_EVENT_QUEUE_SIZE + 1 && input_get_dropped_event_count() == dropped + 3;
+}
+
+// latency is counted from the oldest event consumed in a frame, frames without events don't change it
+static bool TestPlatformLatency() {
+    TestPlatformDrainEvents();
+    // clears the frame of earlier tests
+    input_present(~0ull);
+    const input_latency_t base = input_get_latency();
+
+    input_event_t event;
+    event.type = SF_INPUT_EVENT_CURSOR_MOVE;
+    event.time_ns = 1500;
+    input_push_event(event);
+    event.time_ns = 1000;
+    input_push_event(event);
+    while (input_pop_event(event, ~0ull)) {
+    }
+    input_present(3000);
+    const input_latency_t first = input_get_latency();
+    if (first.last_ns != 2000 || first.frame_count != base.frame_count + 1 || first.max_ns < 2000) {
+        return false;
+    }
+
+    input_present(4000);
+    if (input_get_latency().frame_count != first.frame_count) {
+        return false;
+    }
+
+    event.time_ns = 5000;
+    input_push_event(event);
+    input_pop_event(event, ~0ull);
+    input_present(5500);
+    const input_latency_t second = input_get_latency();
+    return second.last_ns == 500 && second.max_ns == first.max_ns && second.frame_count == first.frame_count + 1
+        && second.average_ns == (first.average_ns * 15 + 500) / 16;
+}
+
+#define SF_TEST_RECORD_PATH "TestPlatform.sfir"
+
+static std::vector<SF_KEYCODE> s_test_replayed_keys;
+
+static void TestPlatformOnKeyPress(SF_KEYCODE keycode) {
+    s_test_replayed_keys.push_back(keycode);
+}
+
+static bool TestPlatformWriteFile(const char* filepath, const std::vector<u8>& bytes) {
+    FILE* file = fopen(filepath, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    const bool written = fwrite(bytes.data(), bytes.size(), 1, file) == 1;
+    return fclose(file) == 0 && written;
+}
+
+static bool TestPlatformReplayRejects(const std::vector<u8>& bytes) {
+    input_replay_t replay;
+    const bool loaded = TestPlatformWriteFile(SF_TEST_RECORD_PATH, bytes) && input_replay_load(replay, SF_TEST_RECORD_PATH);
+    if (loaded) {
+        input_replay_free(replay);
+    }
+    return !loaded && replay.events == nullptr;
+}
+
+// recorded events must load back with the same fields, replay only dispatches events, which are due, and corrupted files are rejected
+static bool TestPlatformRecordReplay() {
+    const u64 start_ns = 1000000;
+    input_event_t events[4];
+    events[0] = { start_ns + 100, start_ns + 150, 70, SF_INPUT_EVENT_KEY_PRESS, SF_KEYCODE_A, 0, 0 };
+    events[1] = { start_ns + 5000, start_ns + 5000, 75, SF_INPUT_EVENT_CURSOR_MOVE, 0, -20, 300000 };
+    events[2] = { start_ns + 7000, start_ns + 9000, 71, SF_INPUT_EVENT_KEY_PRESS, SF_KEYCODE_B, 0, 0 };
+    events[3] = { start_ns + 2000000, start_ns + 2000000, 0, SF_INPUT_EVENT_KEY_RELEASE, SF_KEYCODE_A, 0, 0 };
+
+    window_t window = {};
+    input_record_begin(start_ns);
+    for (const input_event_t& event : events) {
+        input_dispatch(window, event);
+    }
+    input_set_key(SF_KEYCODE_A, false);
+    input_set_key(SF_KEYCODE_B, false);
+    if (!input_record_end(SF_TEST_RECORD_PATH)) {
+        return false;
+    }
+
+    input_replay_t replay;
+    if (!input_replay_load(replay, SF_TEST_RECORD_PATH) || replay.count != 4) {
+        return false;
+    }
+    bool passed = true;
+    for (u32 i = 0 ; i < 4 ; i++) {
+        const input_event_t& expected = events[i];
+        const input_event_t& event = replay.events[i];
+        passed &= event.type == expected.type && event.code == expected.code && event.x == expected.x && event.y == expected.y
+            && event.time_ns == expected.time_ns - start_ns && event.receive_ns == expected.receive_ns - start_ns
+            && event.server_time_ms == expected.server_time_ms;
+    }
+
+    window.desktop_events.event_key_press = TestPlatformOnKeyPress;
+    s_test_replayed_keys.clear();
+    input_replay_update(replay, window, 50000000);
+    input_replay_update(replay, window, 50000000 + 10000);
+    passed &= replay.index == 3 && s_test_replayed_keys.size() == 2 && s_test_replayed_keys[0] == SF_KEYCODE_A && s_test_replayed_keys[1] == SF_KEYCODE_B;
+    input_replay_update(replay, window, 50000000 + 2000000);
+    passed &= replay.index == 4;
+    input_replay_free(replay);
+    TestPlatformDrainEvents();
+
+    FILE* file = fopen(SF_TEST_RECORD_PATH, "rb");
+    std::vector<u8> bytes(4096);
+    bytes.resize(file != nullptr ? fread(bytes.data(), 1, bytes.size(), file) : 0);
+    if (file != nullptr) {
+        fclose(file);
+    }
+    passed &= bytes.size() > 16;
+
+    if (passed) {
+        // header is magic, version, event count and payload size
+        std::vector<u8> corrupted = bytes;
+        corrupted[8] = 0xFF;
+        corrupted[9] = 0xFF;
+        passed &= TestPlatformReplayRejects(corrupted);
+
+        corrupted = bytes;
+        corrupted.push_back(0);
+        passed &= TestPlatformReplayRejects(corrupted);
+
+        corrupted = bytes;
+        corrupted[12]++;
+        corrupted.push_back(0);
+        passed &= TestPlatformReplayRejects(corrupted);
+
+        corrupted = bytes;
+        corrupted.back() |= 0x80;
+        passed &= TestPlatformReplayRejects(corrupted);
+
+        corrupted = bytes;
+        corrupted[8]--;
+        passed &= TestPlatformReplayRejects(corrupted);
+    }
+
+    std::remove(SF_TEST_RECORD_PATH);
+    return passed;
+}
+
+bool TestPlatform() {
+    bool passed = true;
+    passed &= TestPlatformInputState();
+    passed &= TestPlatformEventQueue();
+    passed &= TestPlatformLatency();
+    passed &= TestPlatformRecordReplay();
+    return passed;
+}